@@ -0,0 +1,37 @@
+#-------------------------------------------------
+#
+# Ingest throughput of the receive path, results as JSON
+# to compare between releases
+#
+#-------------------------------------------------
+
+QT       += core \
+            network
+QT       -= gui
+
+TARGET = ingestbenchmark
+TEMPLATE = app
+CONFIG += console c++11 release
+CONFIG -= app_bundle debug
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    ingestbenchmark.cpp \
+    ../payload.cpp \
+    ../connection.cpp \
+    ../clocksync.cpp \
+    ../linkstatistics.cpp \
+    ../logger.cpp \
+    ../topicdispatcher.cpp \
+    ../telemetrydictionary.cpp
+
+HEADERS  += ingestbenchmark.h \
+    ../payload.h \
+    ../payloadschema.h \
+    ../connection.h \
+    ../clocksync.h \
+    ../linkstatistics.h \
+    ../logger.h \
+    ../topicdispatcher.h \
+    ../telemetrydictionary.h
@@ -0,0 +1,403 @@
+#include "ingestbenchmark.h"
+
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QSysInfo>
+#include <algorithm>
+#include <string.h>
+
+const IngestBenchmark::StageInfo IngestBenchmark::stageTable[] = {
+    {"parse",               &IngestBenchmark::stageParse,               "mixed"},
+    {"checksum",            &IngestBenchmark::stageChecksum,            "mixed"},
+    {"filter",              &IngestBenchmark::stageFilter,              "mixed"},
+    {"queue",               &IngestBenchmark::stageQueue,               "mixed"},
+    {"decode.counter",      &IngestBenchmark::stageDecodeCounter,       "counter"},
+    {"decode.imu",          &IngestBenchmark::stageDecodeSensorIMU,     "imu"},
+    {"decode.electrical",   &IngestBenchmark::stageDecodeElectrical,    "electrical"},
+    {"decode.light",        &IngestBenchmark::stageDecodeLight,         "light"},
+    {"decode.mission",      &IngestBenchmark::stageDecodeMission,       "mission"},
+    {"decode.dictionary",   &IngestBenchmark::stageDecodeDictionary,    "mixed"},
+    {"combined",            &IngestBenchmark::stageCombined,            "mixed"}
+};
+
+/*Bits of a float, so digests do not depend on rounding of the sum*/
+static quint64 digest(float value){
+    quint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+
+IngestBenchmark::IngestBenchmark(quint32 seed, int minTime, int rounds)
+    : seed(seed), minTime(qMax(1, minTime)), rounds(qMax(1, rounds)), random(seed), topicMask(0), sink(0){
+    static const PayloadType subscribed[] = {PayloadCounterType, PayloadSensorIMUType, PayloadElectricalType, PayloadMissionType, PayloadLightType};
+    for(unsigned i = 0; i < sizeof(subscribed) / sizeof(subscribed[0]); i++){
+        topicMask |= (quint64) 1 << (subscribed[i] - TOPIC_TABLE_BASE);
+    }
+    dispatcher.registerHandler(PayloadCounterType, this, &IngestBenchmark::onCounter);
+    dispatcher.registerHandler(PayloadSensorIMUType, this, &IngestBenchmark::onSensorIMU);
+    dispatcher.registerHandler(PayloadElectricalType, this, &IngestBenchmark::onElectrical);
+    dispatcher.registerHandler(PayloadLightType, this, &IngestBenchmark::onLight);
+    dispatcher.registerHandler(PayloadMissionType, this, &IngestBenchmark::onMission);
+    values.resize(dictionary.channelCount());
+    createCorpora();
+}
+
+
+/*------*/
+/*CORPUS*/
+/*------*/
+
+/*One corpus per topic for the decoders and a mix like a busy pass over the ground station:
+ * mostly IMU, some of every other topic and a few frames nobody subscribed to*/
+void IngestBenchmark::createCorpora(){
+    static const struct { const char *name; PayloadType type; } single[] = {
+        {"counter", PayloadCounterType},
+        {"imu", PayloadSensorIMUType},
+        {"electrical", PayloadElectricalType},
+        {"light", PayloadLightType},
+        {"mission", PayloadMissionType}
+    };
+    uchar data[RODOS_FRAME_SIZE - RODOS_HEADER_SIZE];
+    QByteArray frame(RODOS_FRAME_SIZE, 0x00);
+    for(unsigned c = 0; c <= sizeof(single) / sizeof(single[0]); c++){
+        BenchmarkCorpus corpus;
+        bool mixed = c == sizeof(single) / sizeof(single[0]);
+        corpus.name = mixed ? "mixed" : single[c].name;
+        for(int i = 0; i < BENCHMARK_CORPUS_FRAMES; i++){
+            quint32 topic = mixed ? 0 : single[c].type;
+            if(mixed){
+                int share = random % 100;
+                random = random * 1664525 + 1013904223;
+                topic = share < 70 ? PayloadSensorIMUType : share < 80 ? PayloadLightType : share < 85 ? PayloadElectricalType
+                      : share < 90 ? PayloadMissionType : share < 95 ? PayloadCounterType : BENCHMARK_FOREIGN_TOPIC;
+            }
+            int length = topic == BENCHMARK_FOREIGN_TOPIC ? 16 : encodeSample((PayloadType) topic, data);
+            if(topic == BENCHMARK_FOREIGN_TOPIC){
+                for(int b = 0; b < length; b++){
+                    data[b] = (uchar) nextValue(128);
+                }
+            }
+            writeRodosFrame((uchar*) frame.data(), topic, 1000000000ULL + i * 1000000ULL, data, length);
+            corpus.frames.append(QByteArray(frame.constData(), frame.size()));
+            if(rodosTopicFilter((const uchar*) frame.constData(), frame.size(), topicMask) >= 0)
+                corpus.payloads.append(PayloadSatellite(frame));
+        }
+        corpora.append(corpus);
+    }
+}
+
+
+int IngestBenchmark::encodeSample(PayloadType type, uchar *data){
+    switch(type){
+    case PayloadCounterType:{
+        PayloadCounter counter;
+        counter.counter = (qint32) nextValue(100000);
+        return counter.encode(data);
+    }
+    case PayloadSensorIMUType:{
+        PayloadSensorIMU imu;
+        imu.ax = nextValue(2000);
+        imu.ay = nextValue(2000);
+        imu.az = nextValue(2000);
+        imu.wx = nextValue(5);
+        imu.wy = nextValue(5);
+        imu.wz = nextValue(5);
+        imu.roll = nextValue(3.2f);
+        imu.pitch = nextValue(3.2f);
+        imu.headingFusion = nextValue(3.2f);
+        imu.headingXm = nextValue(3.2f);
+        imu.headingGyro = nextValue(3.2f);
+        imu.calibrationActive = nextValue(1) > 0.9f;
+        return imu.encode(data);
+    }
+    case PayloadElectricalType:{
+        PayloadElectrical electrical;
+        electrical.lightsensorOn = nextValue(1) > 0;
+        electrical.electromagnetOn = nextValue(1) > 0;
+        electrical.thermalKnifeOn = nextValue(1) > 0;
+        electrical.racksOut = nextValue(1) > 0;
+        electrical.solarPanelsOut = nextValue(1) > 0;
+        electrical.batteryCurrent = nextValue(500);
+        electrical.batteryVoltage = 7.4f + nextValue(1);
+        electrical.solarPanelCurrent = nextValue(200);
+        electrical.solarPanelVoltage = 5 + nextValue(1);
+        return electrical.encode(data);
+    }
+    case PayloadLightType:{
+        PayloadLight light;
+        light.lightValue = (quint16)(2048 + nextValue(2047));
+        return light.encode(data);
+    }
+    case PayloadMissionType:{
+        PayloadMission mission;
+        mission.partNumber = (qint32)(8 + nextValue(8));
+        mission.angle = 180 + nextValue(180);
+        mission.isCleaned = nextValue(1) > 0;
+        return mission.encode(data);
+    }
+    }
+    return 0;
+}
+
+
+/*Uniform in [-range, range), from a generator that is the same on every platform*/
+float IngestBenchmark::nextValue(float range){
+    random = random * 1664525 + 1013904223;
+    return (float)((random / 4294967296.0 * 2 - 1) * range);
+}
+
+
+const BenchmarkCorpus *IngestBenchmark::corpus(const QString &name) const{
+    for(int i = 0; i < corpora.size(); i++){
+        if(corpora.at(i).name == name)
+            return &corpora.at(i);
+    }
+    return 0;
+}
+
+
+/*-----------*/
+/*MEASUREMENT*/
+/*-----------*/
+
+/*A name selects every stage it is a prefix of, "decode" runs all decoders*/
+QList<BenchmarkResult> IngestBenchmark::run(const QStringList &stages){
+    QList<BenchmarkResult> results;
+    for(unsigned i = 0; i < sizeof(stageTable) / sizeof(stageTable[0]); i++){
+        bool selected = stages.isEmpty();
+        foreach(const QString &stage, stages){
+            selected |= QString(stageTable[i].name).startsWith(stage);
+        }
+        if(selected)
+            results.append(measure(stageTable[i], *corpus(stageTable[i].corpus)));
+    }
+    return results;
+}
+
+
+/*Stages on parsed payloads count the subscribed frames only*/
+BenchmarkResult IngestBenchmark::measure(const StageInfo &info, const BenchmarkCorpus &corpus){
+    BenchmarkResult result;
+    result.stage = info.name;
+    result.corpus = corpus.name;
+    bool parsed = info.stage == &IngestBenchmark::stageQueue || result.stage.startsWith("decode.");
+    result.packets = parsed ? corpus.payloads.size() : corpus.frames.size();
+
+    /*Warm up caches and the allocator once*/
+    result.check = (this->*info.stage)(corpus);
+
+    QVector<double> perPacket;
+    for(int r = 0; r < rounds; r++){
+        QElapsedTimer timer;
+        qint64 packets = 0;
+        timer.start();
+        do{
+            (this->*info.stage)(corpus);
+            packets += result.packets;
+        } while(timer.nsecsElapsed() < (qint64) minTime * 1000000);
+        perPacket.append((double) timer.nsecsElapsed() / packets);
+    }
+    std::sort(perPacket.begin(), perPacket.end());
+    result.nsPerPacket = perPacket.at(perPacket.size() / 2);
+    result.nsPerPacketMin = perPacket.first();
+    return result;
+}
+
+
+QJsonObject IngestBenchmark::toJson(const QList<BenchmarkResult> &results) const{
+    QJsonArray stages;
+    foreach(const BenchmarkResult &result, results){
+        QJsonObject stage;
+        stage.insert("stage", result.stage);
+        stage.insert("corpus", result.corpus);
+        stage.insert("packets", (double) result.packets);
+        stage.insert("nsPerPacket", result.nsPerPacket);
+        stage.insert("nsPerPacketMin", result.nsPerPacketMin);
+        stage.insert("packetsPerSecond", 1e9 / result.nsPerPacket);
+        stage.insert("check", QString::number(result.check, 16));
+        stages.append(stage);
+    }
+
+    QJsonObject root;
+    root.insert("benchmark", QString("ingest"));
+    root.insert("format", 1);
+    root.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert("qt", QString(qVersion()));
+    root.insert("abi", QSysInfo::buildAbi());
+    root.insert("os", QSysInfo::prettyProductName());
+#ifdef __VERSION__
+    root.insert("compiler", QString(__VERSION__));
+#endif
+#ifdef QT_NO_DEBUG
+    root.insert("build", QString("release"));
+#else
+    root.insert("build", QString("debug"));
+#endif
+    root.insert("seed", (double) seed);
+    root.insert("corpusFrames", BENCHMARK_CORPUS_FRAMES);
+    root.insert("minTime", minTime);
+    root.insert("rounds", rounds);
+    root.insert("results", stages);
+    return root;
+}
+
+
+/*------*/
+/*STAGES*/
+/*------*/
+
+quint64 IngestBenchmark::stageParse(const BenchmarkCorpus &corpus){
+    quint64 check = 0;
+    foreach(const QByteArray &frame, corpus.frames){
+        PayloadSatellite payload(frame);
+        check += payload.topic + payload.userDataLen + payload.userData[0];
+    }
+    return check;
+}
+
+quint64 IngestBenchmark::stageChecksum(const BenchmarkCorpus &corpus){
+    quint64 check = 0;
+    foreach(const QByteArray &frame, corpus.frames){
+        const uchar *header = (const uchar*) frame.constData();
+        check += rodosChecksum(header, RODOS_HEADER_SIZE + qFromBigEndian<quint16>(header + 24));
+    }
+    return check;
+}
+
+quint64 IngestBenchmark::stageFilter(const BenchmarkCorpus &corpus){
+    quint64 check = 0;
+    foreach(const QByteArray &frame, corpus.frames){
+        check += rodosTopicFilter((const uchar*) frame.constData(), frame.size(), topicMask) + 1;
+    }
+    return check;
+}
+
+/*Filled in bursts and drained completely, as between readReady and readoutConnection*/
+quint64 IngestBenchmark::stageQueue(const BenchmarkCorpus &corpus){
+    quint64 check = 0;
+    for(int i = 0; i < corpus.payloads.size(); i += BENCHMARK_QUEUE_BATCH){
+        int end = qMin(i + BENCHMARK_QUEUE_BATCH, corpus.payloads.size());
+        for(int p = i; p < end; p++){
+            queue.enqueue(corpus.payloads.at(p));
+        }
+        while(!queue.isEmpty()){
+            check += queue.dequeue().topic;
+        }
+    }
+    return check;
+}
+
+quint64 IngestBenchmark::stageDecodeCounter(const BenchmarkCorpus &corpus){
+    quint64 before = sink;
+    foreach(const PayloadSatellite &payload, corpus.payloads){
+        onCounter(payload);
+    }
+    return sink - before;
+}
+
+quint64 IngestBenchmark::stageDecodeSensorIMU(const BenchmarkCorpus &corpus){
+    quint64 before = sink;
+    foreach(const PayloadSatellite &payload, corpus.payloads){
+        onSensorIMU(payload);
+    }
+    return sink - before;
+}
+
+quint64 IngestBenchmark::stageDecodeElectrical(const BenchmarkCorpus &corpus){
+    quint64 before = sink;
+    foreach(const PayloadSatellite &payload, corpus.payloads){
+        onElectrical(payload);
+    }
+    return sink - before;
+}
+
+quint64 IngestBenchmark::stageDecodeLight(const BenchmarkCorpus &corpus){
+    quint64 before = sink;
+    foreach(const PayloadSatellite &payload, corpus.payloads){
+        onLight(payload);
+    }
+    return sink - before;
+}
+
+quint64 IngestBenchmark::stageDecodeMission(const BenchmarkCorpus &corpus){
+    quint64 before = sink;
+    foreach(const PayloadSatellite &payload, corpus.payloads){
+        onMission(payload);
+    }
+    return sink - before;
+}
+
+/*The generic decoder program of the telemetry dictionary, all topics*/
+quint64 IngestBenchmark::stageDecodeDictionary(const BenchmarkCorpus &corpus){
+    quint64 check = 0;
+    float *channels = values.data();
+    foreach(const PayloadSatellite &payload, corpus.payloads){
+        int count = dictionary.decode(payload, channels);
+        check += count + digest(channels[dictionary.topic(payload.topic)->firstOp]);
+    }
+    return check;
+}
+
+/*The whole receive path after the socket, Connection::processDatagram as in the application:
+ * filter, subscription counters, checksum, copy, clock sync, link statistics and the jitter buffers
+ * of the plotted topics, then queue and dispatch to the decoders in bursts.
+ * A new Connection per pass starts clock sync, statistics and buffers from the same state.
+ * The receive times lie BENCHMARK_RECEIVE_AGE in the past, so buffered packets are due at once
+ * and come out with the burst they arrived in.*/
+quint64 IngestBenchmark::stageCombined(const BenchmarkCorpus &corpus){
+    quint64 before = sink;
+    Connection connection(0, true);
+    static const PayloadType subscribed[] = {PayloadCounterType, PayloadSensorIMUType, PayloadElectricalType, PayloadMissionType, PayloadLightType};
+    for(unsigned i = 0; i < sizeof(subscribed) / sizeof(subscribed[0]); i++){
+        connection.addTopic(subscribed[i]);
+    }
+    connection.setJitterBuffer(PayloadSensorIMUType, BENCHMARK_JITTER_LATENCY);
+    connection.setJitterBuffer(PayloadLightType, BENCHMARK_JITTER_LATENCY);
+
+    QByteArray buffer(RODOS_FRAME_SIZE, 0x00);
+    qint64 start = groundTime() - BENCHMARK_RECEIVE_AGE;
+    for(int i = 0; i < corpus.frames.size(); i++){
+        const QByteArray &frame = corpus.frames.at(i);
+        memcpy(buffer.data(), frame.constData(), frame.size());
+        connection.processDatagram(buffer, frame.size(), start + i * 1000000LL);
+        if((i + 1) % BENCHMARK_QUEUE_BATCH && i + 1 < corpus.frames.size())
+            continue;
+        connection.releasePayloads();
+        while(connection.isReadReady()){
+            dispatcher.dispatch(connection.read());
+        }
+    }
+    return sink - before;
+}
+
+
+/*--------*/
+/*HANDLERS*/
+/*--------*/
+
+void IngestBenchmark::onCounter(const PayloadSatellite &payload){
+    PayloadCounter counter(payload);
+    sink += counter.counter;
+}
+
+void IngestBenchmark::onSensorIMU(const PayloadSatellite &payload){
+    PayloadSensorIMU imu(payload);
+    sink += digest(imu.ax) + digest(imu.wz) + digest(imu.headingGyro) + imu.calibrationActive;
+}
+
+void IngestBenchmark::onElectrical(const PayloadSatellite &payload){
+    PayloadElectrical electrical(payload);
+    sink += digest(electrical.batteryVoltage) + digest(electrical.solarPanelVoltage) + electrical.racksOut;
+}
+
+void IngestBenchmark::onLight(const PayloadSatellite &payload){
+    PayloadLight light(payload);
+    sink += light.lightValue;
+}
+
+void IngestBenchmark::onMission(const PayloadSatellite &payload){
+    PayloadMission mission(payload);
+    sink += mission.partNumber + digest(mission.angle) + mission.isCleaned;
+}
@@ -0,0 +1,96 @@
+#ifndef INGESTBENCHMARK_H
+#define INGESTBENCHMARK_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QQueue>
+#include <QByteArray>
+#include <QJsonObject>
+
+#include "payload.h"
+#include "connection.h"
+#include "topicdispatcher.h"
+#include "telemetrydictionary.h"
+
+#define BENCHMARK_CORPUS_FRAMES 4096
+#define BENCHMARK_QUEUE_BATCH 64        /*frames read per readReady, like a burst on the socket*/
+#define BENCHMARK_FOREIGN_TOPIC 5100    /*outside the subscription table, dropped by the filter*/
+#define BENCHMARK_JITTER_LATENCY 50     /*ms, JITTER_BUFFER_LATENCY of the application*/
+#define BENCHMARK_RECEIVE_AGE 10000000000LL     /*ns the combined stage's receive times lie in the past*/
+
+/*Fixed frames for every run, generated from a seed so results compare between releases*/
+struct BenchmarkCorpus{
+    QString name;
+    QList<QByteArray> frames;               /*whole RODOS frames as read from the socket*/
+    QVector<PayloadSatellite> payloads;     /*the subscribed frames parsed*/
+};
+
+struct BenchmarkResult{
+    QString stage;
+    QString corpus;
+    qint64 packets;                         /*per round*/
+    double nsPerPacket;                     /*median of the rounds*/
+    double nsPerPacketMin;
+    quint64 check;                          /*digest of the stage's output, equal between builds*/
+};
+
+/*Measures the receive path stage by stage and all stages together on the same corpora.
+ * Every stage runs over its corpus until minTime has passed, rounds times, and reports
+ * ns per packet and packets per second.*/
+class IngestBenchmark
+{
+public:
+    IngestBenchmark(quint32 seed, int minTime, int rounds);
+    QList<BenchmarkResult> run(const QStringList &stages);    /*all stages if empty*/
+    QJsonObject toJson(const QList<BenchmarkResult> &results) const;
+
+private:
+    typedef quint64 (IngestBenchmark::*Stage)(const BenchmarkCorpus &corpus);
+    struct StageInfo{
+        const char *name;
+        Stage stage;
+        const char *corpus;
+    };
+    static const StageInfo stageTable[];
+
+    quint32 seed;
+    int minTime;                            /*ms*/
+    int rounds;
+    quint32 random;
+    QList<BenchmarkCorpus> corpora;
+    quint64 topicMask;
+    QQueue<PayloadSatellite> queue;
+    TopicDispatcher dispatcher;
+    TelemetryDictionary dictionary;
+    QVector<float> values;
+    quint64 sink;                           /*decoded values end up here, so nothing is optimized away*/
+
+    void createCorpora();
+    int encodeSample(PayloadType type, uchar *data);
+    float nextValue(float range);
+    const BenchmarkCorpus *corpus(const QString &name) const;
+    BenchmarkResult measure(const StageInfo &info, const BenchmarkCorpus &corpus);
+
+    /*Stages, each processes the corpus once and returns a digest*/
+    quint64 stageParse(const BenchmarkCorpus &corpus);
+    quint64 stageChecksum(const BenchmarkCorpus &corpus);
+    quint64 stageFilter(const BenchmarkCorpus &corpus);
+    quint64 stageQueue(const BenchmarkCorpus &corpus);
+    quint64 stageDecodeCounter(const BenchmarkCorpus &corpus);
+    quint64 stageDecodeSensorIMU(const BenchmarkCorpus &corpus);
+    quint64 stageDecodeElectrical(const BenchmarkCorpus &corpus);
+    quint64 stageDecodeLight(const BenchmarkCorpus &corpus);
+    quint64 stageDecodeMission(const BenchmarkCorpus &corpus);
+    quint64 stageDecodeDictionary(const BenchmarkCorpus &corpus);
+    quint64 stageCombined(const BenchmarkCorpus &corpus);
+
+    /*Handlers of the combined stage*/
+    void onCounter(const PayloadSatellite &payload);
+    void onSensorIMU(const PayloadSatellite &payload);
+    void onElectrical(const PayloadSatellite &payload);
+    void onLight(const PayloadSatellite &payload);
+    void onMission(const PayloadSatellite &payload);
+};
+
+#endif // INGESTBENCHMARK_H
@@ -0,0 +1,47 @@
+#include "ingestbenchmark.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QFile>
+#include <stdio.h>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Ingest throughput of the receive path on fixed synthetic frames.\n"
+                                     "Prints one JSON document, a readable table goes to stderr.");
+    parser.addHelpOption();
+    parser.addOptions(QList<QCommandLineOption>()
+        << QCommandLineOption("stage", "Stages to run, a prefix selects several (e.g. decode). All by default.", "name")
+        << QCommandLineOption("seed", "Seed of the frame corpora.", "number", "1")
+        << QCommandLineOption("min-time", "Milliseconds every round of a stage runs at least.", "ms", "200")
+        << QCommandLineOption("rounds", "Rounds per stage, the median is reported.", "count", "5")
+        << QCommandLineOption("output", "Write the JSON to <file> instead of stdout.", "file"));
+    parser.process(a);
+
+    IngestBenchmark benchmark(parser.value("seed").toUInt(), parser.value("min-time").toInt(), parser.value("rounds").toInt());
+    QList<BenchmarkResult> results = benchmark.run(parser.values("stage"));
+    if(results.isEmpty()){
+        fprintf(stderr, "No stage selected\n");
+        return 1;
+    }
+    fprintf(stderr, "%-20s %-12s %12s %12s %14s\n", "stage", "corpus", "ns/packet", "min", "packets/s");
+    foreach(const BenchmarkResult &result, results){
+        fprintf(stderr, "%-20s %-12s %12.1f %12.1f %14.0f\n", qPrintable(result.stage), qPrintable(result.corpus),
+                result.nsPerPacket, result.nsPerPacketMin, 1e9 / result.nsPerPacket);
+    }
+
+    QByteArray json = QJsonDocument(benchmark.toJson(results)).toJson(QJsonDocument::Indented);
+    if(!parser.isSet("output")){
+        fwrite(json.constData(), 1, json.size(), stdout);
+        return 0;
+    }
+    QFile file(parser.value("output"));
+    if(!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()){
+        fprintf(stderr, "\"%s\" could not be written: %s\n", qPrintable(parser.value("output")), qPrintable(file.errorString()));
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,284 @@
+#include "camerasimulator.h"
+#include "imagecodec.h"
+
+#include <QFile>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+CameraStatistics::CameraStatistics() : bytes(0), frames(0), messages(0), droppedBytes(0), garbage(0){
+}
+
+
+CameraSimulator::CameraSimulator(QObject *parent)
+    : QObject(parent), master(-1), slave(-1), writeNotifier(0), readNotifier(0), recording(CAMERA_WIDTH, CAMERA_HEIGHT),
+      bytesPerSecond(CAMERA_BAUDRATE / 10), frameInterval(2000), consoleInterval(1000), compressed(false), drops(0), garbage(0),
+      frameCount(0), nextFrame(0), nextConsole(0), written(0), lineStart(0){
+    tickTimer.setInterval(CAMERA_TICK);
+    tickTimer.setTimerType(Qt::PreciseTimer);
+    connect(&tickTimer, SIGNAL(timeout()), this, SLOT(tick()));
+    reportTimer.setInterval(1000);
+    connect(&reportTimer, SIGNAL(timeout()), this, SLOT(report()));
+}
+
+
+CameraSimulator::~CameraSimulator(){
+    if(slave >= 0)
+        ::close(slave);
+    if(master >= 0)
+        ::close(master);
+}
+
+
+/*The slave end stays open here as well, so the master never sees a hangup while the
+ * ground station closes and reopens the port*/
+bool CameraSimulator::open(QString *error){
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if(master < 0 || grantpt(master) != 0 || unlockpt(master) != 0){
+        *error = QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+    slaveName = QString::fromLocal8Bit(ptsname(master));
+    slave = ::open(ptsname(master), O_RDWR | O_NOCTTY);
+    if(slave < 0){
+        *error = QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+
+    /*No echo and no line editing, bytes pass unchanged like on a serial line*/
+    struct termios attributes;
+    tcgetattr(slave, &attributes);
+    cfmakeraw(&attributes);
+    tcsetattr(slave, TCSANOW, &attributes);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    writeNotifier = new QSocketNotifier(master, QSocketNotifier::Write, this);
+    writeNotifier->setEnabled(false);
+    connect(writeNotifier, SIGNAL(activated(int)), this, SLOT(writePending()));
+    readNotifier = new QSocketNotifier(master, QSocketNotifier::Read, this);
+    connect(readNotifier, SIGNAL(activated(int)), this, SLOT(readCommands()));
+    return true;
+}
+
+
+QString CameraSimulator::portName() const{
+    return slaveName;
+}
+
+
+bool CameraSimulator::setRecording(const QString &fileName, QString *error){
+    if(!QFile::exists(fileName) || !recording.open(fileName) || recording.count() == 0){
+        *error = QString("\"%1\" is no image archive with %2x%3 frames").arg(fileName).arg(CAMERA_WIDTH).arg(CAMERA_HEIGHT);
+        return false;
+    }
+    return true;
+}
+
+
+void CameraSimulator::setBaudRate(int baudRate){
+    bytesPerSecond = qMax(0, baudRate) / 10;        /*start and stop bit*/
+}
+
+void CameraSimulator::setFrameInterval(int interval){
+    frameInterval = qMax(0, interval);
+}
+
+void CameraSimulator::setConsoleInterval(int interval){
+    consoleInterval = qMax(0, interval);
+}
+
+void CameraSimulator::setCompressed(bool compressed){
+    this->compressed = compressed;
+}
+
+void CameraSimulator::setDrops(double probability){
+    drops = probability;
+}
+
+void CameraSimulator::setGarbage(double probability){
+    garbage = probability;
+}
+
+
+void CameraSimulator::start(int frameCount){
+    this->frameCount = frameCount;
+    clock.start();
+    nextFrame = 0;
+    nextConsole = consoleInterval;
+    tickTimer.start();
+    reportTimer.start();
+}
+
+
+/*Starts the next message once the line is free, paced lines are written from here as well*/
+void CameraSimulator::tick(){
+    if(written >= pending.size() && !queueMessage())
+        return;
+    if(bytesPerSecond > 0)
+        writePending();
+    else
+        writeNotifier->setEnabled(true);
+}
+
+
+/*Writes what the line allows: the bytes a paced line carried since the message started,
+ * or everything the pseudo-terminal takes when unthrottled*/
+void CameraSimulator::writePending(){
+    while(written < pending.size()){
+        qint64 count = pending.size() - written;
+        if(bytesPerSecond > 0)
+            count = qMin(count, (clock.nsecsElapsed() - lineStart) * bytesPerSecond / 1000000000 - written);
+        if(count <= 0)
+            return;
+        ssize_t result = ::write(master, pending.constData() + written, count);
+        if(result <= 0)
+            return;
+        written += result;
+        statistics.bytes += result;
+
+        /*Unthrottled messages follow each other without waiting for the next tick*/
+        if(written >= pending.size() && bytesPerSecond == 0 && !queueMessage())
+            break;
+    }
+    writeNotifier->setEnabled(false);
+}
+
+
+/*Console texts take turns with the frames, both on their own schedule*/
+bool CameraSimulator::queueMessage(){
+    if(frameCount > 0 && statistics.frames >= (quint64) frameCount){
+        if(tickTimer.isActive()){
+            tickTimer.stop();
+            reportTimer.stop();
+            report();
+            emit finished();
+        }
+        return false;
+    }
+    qint64 now = clock.elapsed();
+    if(consoleInterval > 0 && now >= nextConsole){
+        nextConsole = now + consoleInterval;
+        queue("&CONSOLE START" + QString("Camera simulator, %1 frames sent").arg(statistics.frames).toLatin1() + "CONSOLE STOP&");
+        return true;
+    }
+    if(now >= nextFrame){
+        nextFrame = qMax(nextFrame + frameInterval, now);
+        queue(frame(statistics.frames));
+        statistics.frames++;
+        return true;
+    }
+    return false;
+}
+
+
+/*Faults of the line are applied to the whole message before it goes out*/
+void CameraSimulator::queue(const QByteArray &message){
+    QByteArray line;
+    if(drops > 0){
+        line.reserve(message.size());
+        for(int i = 0; i < message.size(); i++){
+            if(chance(drops))
+                statistics.droppedBytes++;
+            else
+                line.append(message.at(i));
+        }
+    }
+    else
+        line = message;
+
+    /*Garbage may contain & and break the framing at any position*/
+    if(chance(garbage)){
+        QByteArray noise(1 + qrand() % 32, 0x00);
+        for(int i = 0; i < noise.size(); i++){
+            noise[i] = (char) qrand();
+        }
+        line.insert(qrand() % (line.size() + 1), noise);
+        statistics.garbage++;
+    }
+
+    pending = line;
+    written = 0;
+    lineStart = clock.nsecsElapsed();
+    statistics.messages++;
+}
+
+
+QByteArray CameraSimulator::frame(quint64 index){
+    QByteArray raw;
+    if(recording.isOpen())
+        raw = QByteArray((const char*) recording.frame(index % recording.count()), CAMERA_WIDTH * CAMERA_HEIGHT * 2);
+    else
+        raw = syntheticFrame(index);
+
+    if(compressed)
+        return "&CFRAME START" + encodeImage(raw, CAMERA_WIDTH, CAMERA_HEIGHT) + "CFRAME STOP&";
+
+    /*Every byte as three decimal digits*/
+    static char digits[256][3];
+    if(!digits[1][2]){
+        for(int i = 0; i < 256; i++){
+            digits[i][0] = '0' + i / 100;
+            digits[i][1] = '0' + i / 10 % 10;
+            digits[i][2] = '0' + i % 10;
+        }
+    }
+    QByteArray message("&FRAME START");
+    message.reserve(12 + raw.size() * 3 + 11);
+    const uchar *bytes = (const uchar*) raw.constData();
+    for(int i = 0; i < raw.size(); i++){
+        message.append(digits[bytes[i]], 3);
+    }
+    message.append("FRAME STOP&");
+    return message;
+}
+
+
+/*YCbCr 4:2:2 (Y0 Cb Y1 Cr): a luma gradient moving with the frame index over chroma bars*/
+QByteArray CameraSimulator::syntheticFrame(quint64 index){
+    QByteArray raw(CAMERA_WIDTH * CAMERA_HEIGHT * 2, 0x00);
+    uchar *bytes = (uchar*) raw.data();
+    for(int y = 0; y < CAMERA_HEIGHT; y++){
+        for(int x = 0; x < CAMERA_WIDTH; x += 2){
+            uchar *pair = bytes + (y * CAMERA_WIDTH + x) * 2;
+            pair[0] = 16 + (x + y + index * 4) % 220;
+            pair[1] = 128 + (x / 20 % 2 ? 60 : -60);
+            pair[2] = 16 + (x + 1 + y + index * 4) % 220;
+            pair[3] = 128 + (y / 20 % 2 ? 60 : -60);
+        }
+    }
+    return raw;
+}
+
+
+/*Telecommands over the camera link are not used by the satellite, they are only counted*/
+void CameraSimulator::readCommands(){
+    char buffer[256];
+    ssize_t count = ::read(master, buffer, sizeof(buffer));
+    if(count > 0){
+        printf("%d command bytes received\n", (int) count);
+        fflush(stdout);
+    }
+}
+
+
+/*Line throughput since the last report*/
+void CameraSimulator::report(){
+    printf("%.1f s: %llu bytes/s, %llu frames, %llu messages, %llu bytes dropped, %llu garbage inserts\n",
+           clock.nsecsElapsed() / 1e9,
+           statistics.bytes - lastStatistics.bytes,
+           statistics.frames,
+           statistics.messages,
+           statistics.droppedBytes,
+           statistics.garbage);
+    fflush(stdout);
+    lastStatistics = statistics;
+}
+
+
+bool CameraSimulator::chance(double probability){
+    return probability > 0 && qrand() < probability * ((double) RAND_MAX + 1);
+}
@@ -0,0 +1,90 @@
+#ifndef CAMERASIMULATOR_H
+#define CAMERASIMULATOR_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+
+#include "framestore.h"
+
+#define CAMERA_WIDTH 160                /*IMAGE_WIDTH of imagelink.h*/
+#define CAMERA_HEIGHT 121               /*IMAGE_HEIGHT of imagelink.h*/
+#define CAMERA_BAUDRATE 921600          /*BAUDRATE of imagelink.h*/
+#define CAMERA_TICK 1                   /*ms between pacing steps*/
+
+/*Counters since the start, printed once per second*/
+struct CameraStatistics{
+    quint64 bytes;
+    quint64 frames;
+    quint64 messages;
+    quint64 droppedBytes;
+    quint64 garbage;
+    CameraStatistics();
+};
+
+/*Plays the camera side of the Bluetooth link on a pseudo-terminal. The ground station opens
+ * the slave end like a serial port and gets frames and console texts in the same framing as
+ * from the satellite: "&FRAME START<3 digits per byte>FRAME STOP&", "&CFRAME START<base64>CFRAME STOP&"
+ * and "&CONSOLE START<text>CONSOLE STOP&". Bytes are paced like an 8N1 line of the given baud rate.*/
+class CameraSimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CameraSimulator(QObject *parent = 0);
+    ~CameraSimulator();
+    bool open(QString *error);
+    QString portName() const;
+    bool setRecording(const QString &fileName, QString *error);    /*frames of an image archive instead of synthetic ones*/
+    void setBaudRate(int baudRate);             /*0 writes as fast as the reader takes it*/
+    void setFrameInterval(int interval);        /*ms from the start of one frame to the next*/
+    void setConsoleInterval(int interval);      /*ms, 0 sends no console texts*/
+    void setCompressed(bool compressed);
+    void setDrops(double probability);          /*per byte*/
+    void setGarbage(double probability);        /*per message*/
+    void start(int frameCount);                 /*0 runs until interrupted*/
+
+signals:
+    void finished();
+
+private slots:
+    void tick();
+    void writePending();
+    void readCommands();
+    void report();
+
+private:
+    int master;
+    int slave;
+    QString slaveName;
+    QSocketNotifier *writeNotifier;
+    QSocketNotifier *readNotifier;
+    FrameStore recording;
+    QTimer tickTimer;
+    QTimer reportTimer;
+    QElapsedTimer clock;
+    int bytesPerSecond;
+    int frameInterval;
+    int consoleInterval;
+    bool compressed;
+    double drops;
+    double garbage;
+    int frameCount;
+    qint64 nextFrame;                           /*ms*/
+    qint64 nextConsole;                         /*ms*/
+    QByteArray pending;                         /*message on the line*/
+    int written;
+    qint64 lineStart;                           /*ns, when the line got busy*/
+    CameraStatistics statistics;
+    CameraStatistics lastStatistics;
+
+    bool queueMessage();
+    void queue(const QByteArray &message);
+    QByteArray frame(quint64 index);
+    QByteArray syntheticFrame(quint64 index);
+    static bool chance(double probability);
+};
+
+#endif // CAMERASIMULATOR_H
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# Stand-in for the camera: frames and console texts
+# over a pseudo-terminal, Linux only
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = camerasimulator
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    camerasimulator.cpp \
+    ../framestore.cpp \
+    ../imagecodec.cpp
+
+HEADERS  += camerasimulator.h \
+    ../framestore.h \
+    ../imagecodec.h
@@ -0,0 +1,56 @@
+#include "camerasimulator.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <stdio.h>
+
+static double percent(const QCommandLineParser &parser, const char *name){
+    return qBound(0.0, parser.value(name).toDouble(), 100.0) / 100;
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Plays the camera side of the Bluetooth link on a pseudo-terminal.\n"
+                                     "Start the ground station with --camera <port> and open the printed port.");
+    parser.addHelpOption();
+    parser.addOptions(QList<QCommandLineOption>()
+        << QCommandLineOption("baud", "Baud rate the bytes are paced to, 0 writes unthrottled.", "rate", QString::number(CAMERA_BAUDRATE))
+        << QCommandLineOption("interval", "Milliseconds from one frame to the next.", "ms", "2000")
+        << QCommandLineOption("console", "Milliseconds between console texts, 0 for none.", "ms", "1000")
+        << QCommandLineOption("compressed", "Send frames in the compressed downlink mode.")
+        << QCommandLineOption("recording", "Image archive to replay instead of synthetic frames.", "file")
+        << QCommandLineOption("drop", "Percentage of bytes lost on the line.", "percent", "0")
+        << QCommandLineOption("garbage", "Percentage of messages with random bytes inserted.", "percent", "0")
+        << QCommandLineOption("count", "Frames to send, until interrupted by default.", "frames", "0")
+        << QCommandLineOption("seed", "Seed of the fault injection.", "number"));
+    parser.process(a);
+
+    CameraSimulator simulator;
+    QString error;
+    if(!simulator.open(&error)){
+        fprintf(stderr, "No pseudo-terminal: %s\n", qPrintable(error));
+        return 1;
+    }
+    if(parser.isSet("recording") && !simulator.setRecording(parser.value("recording"), &error)){
+        fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+    simulator.setBaudRate(parser.value("baud").toInt());
+    simulator.setFrameInterval(parser.value("interval").toInt());
+    simulator.setConsoleInterval(parser.value("console").toInt());
+    simulator.setCompressed(parser.isSet("compressed"));
+    simulator.setDrops(percent(parser, "drop"));
+    simulator.setGarbage(percent(parser, "garbage"));
+    qsrand(parser.isSet("seed") ? parser.value("seed").toUInt() : (uint) QDateTime::currentMSecsSinceEpoch());
+
+    printf("Camera link on %s\n", qPrintable(simulator.portName()));
+    fflush(stdout);
+    QObject::connect(&simulator, SIGNAL(finished()), &a, SLOT(quit()));
+    simulator.start(parser.value("count").toInt());
+
+    return a.exec();
+}
@@ -0,0 +1,13 @@
+#-------------------------------------------------
+#
+# Checks of the code paths that must stay bit exact,
+# "make check" runs them all
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += colorcheck \
+    codeccheck \
+    imagecodeccheck \
+    exportcheck
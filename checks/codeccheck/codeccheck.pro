@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Round trips of the telemetry column codec: bit
+# streams across word boundaries, 64 bit deltas,
+# special floats and truncated streams
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = codeccheck
+TEMPLATE = app
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+    ../../telemetrycodec.cpp
+
+HEADERS  += ../../telemetrycodec.h
@@ -0,0 +1,218 @@
+#include "telemetrycodec.h"
+
+#include <QVector>
+#include <QString>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define SERIES_LENGTH 4096
+
+static int failures = 0;
+
+static void fail(const char *section, const QString &what){
+    fprintf(stderr, "FAIL %s: %s\n", section, qPrintable(what));
+    failures++;
+}
+
+
+static quint32 seed = 12345;
+
+static quint32 nextRandom(){
+    seed = seed * 1664525 + 1013904223;
+    return seed;
+}
+
+static quint64 nextRandom64(){
+    quint64 high = nextRandom();
+    return (high << 32) | nextRandom();
+}
+
+static quint64 lowBits(quint64 value, int bits){
+    return bits < 64 ? value & (((quint64) 1 << bits) - 1) : value;
+}
+
+
+/*Every pair of widths, so each write and read starts at every offset inside a word and
+ * ends exactly on, just before and just behind a word boundary*/
+static void checkBitStream(){
+    for(int first = 1; first <= 64; first++){
+        for(int second = 1; second <= 64; second++){
+            quint64 values[3] = {nextRandom64(), nextRandom64(), nextRandom64()};
+            int widths[3] = {first, second, 64};
+            BitWriter writer;
+            for(int i = 0; i < 3; i++){
+                writer.write(values[i], widths[i]);
+            }
+            QByteArray stream = writer.finish();
+            int bits = first + second + 64;
+            if(stream.size() != (bits + 63) / 64 * 8)
+                fail("bit stream", QString("%1 + %2 + 64 bits take %3 bytes").arg(first).arg(second).arg(stream.size()));
+
+            BitReader reader((const uchar*) stream.constData(), stream.size());
+            for(int i = 0; i < 3; i++){
+                quint64 value = reader.read(widths[i]);
+                if(value != lowBits(values[i], widths[i]))
+                    fail("bit stream", QString("value %1 of %2 + %3 + 64 bits read back wrong").arg(i).arg(first).arg(second));
+            }
+            if(reader.overrun())
+                fail("bit stream", QString("%1 + %2 + 64 bits flagged as overrun").arg(first).arg(second));
+
+            /*The padding of the last word can be read, the word behind it not*/
+            int padding = stream.size() * 8 - bits;
+            if(padding)
+                reader.read(padding);
+            if(reader.overrun())
+                fail("bit stream", QString("padding of %1 + %2 + 64 bits flagged as overrun").arg(first).arg(second));
+            reader.read(1);
+            if(!reader.overrun())
+                fail("bit stream", QString("read behind %1 + %2 + 64 bits not flagged").arg(first).arg(second));
+        }
+    }
+}
+
+
+static void roundTripTimestamps(const char *name, const QVector<qint64> &times){
+    QByteArray stream = encodeTimestamps(times.constData(), times.size());
+    QVector<qint64> decoded(times.size());
+    if(!decodeTimestamps((const uchar*) stream.constData(), stream.size(), decoded.data(), decoded.size()))
+        fail("timestamps", QString("%1 flagged as overrun").arg(name));
+    for(int i = 0; i < times.size(); i++){
+        if(decoded.at(i) != times.at(i)){
+            fail("timestamps", QString("%1 differs at %2: %3 instead of %4").arg(name).arg(i).arg(decoded.at(i)).arg(times.at(i)));
+            break;
+        }
+    }
+
+    /*Every stream ends in a word holding encoded bits, losing it must be noticed*/
+    if(times.size() > 0 && stream.size() >= 8
+            && decodeTimestamps((const uchar*) stream.constData(), stream.size() - 8, decoded.data(), decoded.size()))
+        fail("timestamps", QString("%1 without its last word decoded").arg(name));
+    if(times.size() > 0 && stream.size() >= 1
+            && decodeTimestamps((const uchar*) stream.constData(), stream.size() - 1, decoded.data(), decoded.size()))
+        fail("timestamps", QString("%1 without its last byte decoded").arg(name));
+}
+
+static void checkTimestamps(){
+    /*Telemetry at 100 ms with a few us of jitter, some repeated stamps*/
+    QVector<qint64> regular(SERIES_LENGTH);
+    qint64 time = Q_INT64_C(1700000000000000000);
+    for(int i = 0; i < regular.size(); i++){
+        time += 100000000 + (qint64)(nextRandom() % 2001) * 1000 - 1000000;
+        regular[i] = time;
+    }
+    regular[5] = regular[4];
+    regular[6] = regular[4];
+    roundTripTimestamps("regular", regular);
+
+    /*Delta of delta on both sides of every bucket limit, each followed by an unchanged delta*/
+    QVector<qint64> limits;
+    qint64 previous = 0;
+    qint64 delta = 0;
+    limits.append(previous);
+    const int bucketBits[] = {16, 28, 40};
+    for(unsigned b = 0; b < sizeof(bucketBits) / sizeof(bucketBits[0]); b++){
+        qint64 limit = (qint64) 1 << (bucketBits[b] - 1);
+        const qint64 deltaOfDeltas[] = {limit - 1, limit, -limit, -limit - 1};
+        for(unsigned d = 0; d < sizeof(deltaOfDeltas) / sizeof(deltaOfDeltas[0]); d++){
+            delta += deltaOfDeltas[d];
+            previous += delta;
+            limits.append(previous);
+            previous += delta;
+            limits.append(previous);
+        }
+    }
+    roundTripTimestamps("bucket limits", limits);
+
+    /*Deltas and delta of deltas that only fit 64 bits or wrap around*/
+    QVector<qint64> wide;
+    wide << 0 << ((qint64) 1 << 62) << -((qint64) 1 << 62) << 5
+         << Q_INT64_C(9223372036854775807) << (-Q_INT64_C(9223372036854775807) - 1) << Q_INT64_C(9223372036854775807)
+         << 0 << -1 << (-Q_INT64_C(9223372036854775807) - 1) << 0;
+    roundTripTimestamps("64 bit deltas", wide);
+
+    QVector<qint64> randomTimes(SERIES_LENGTH);
+    for(int i = 0; i < randomTimes.size(); i++){
+        randomTimes[i] = (qint64) nextRandom64();
+    }
+    roundTripTimestamps("random", randomTimes);
+
+    QVector<qint64> single;
+    single << -1;
+    roundTripTimestamps("single", single);
+    roundTripTimestamps("empty", QVector<qint64>());
+}
+
+
+static float bitsFloat(quint32 bits){
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/*Compared by bit pattern, NaN payloads and the sign of zero have to survive*/
+static void roundTripFloats(const char *name, const QVector<float> &values, int stride = 1){
+    int count = values.size() / stride;
+    QByteArray stream = encodeFloats(values.constData(), count, stride);
+    QVector<float> decoded(count);
+    if(!decodeFloats((const uchar*) stream.constData(), stream.size(), decoded.data(), count))
+        fail("floats", QString("%1 flagged as overrun").arg(name));
+    for(int i = 0; i < count; i++){
+        if(memcmp(&decoded.at(i), &values.at(i * stride), sizeof(float))){
+            fail("floats", QString("%1 differs at %2").arg(name).arg(i));
+            break;
+        }
+    }
+
+    if(count > 0 && stream.size() >= 8
+            && decodeFloats((const uchar*) stream.constData(), stream.size() - 8, decoded.data(), count))
+        fail("floats", QString("%1 without its last word decoded").arg(name));
+    if(count > 0 && stream.size() >= 1
+            && decodeFloats((const uchar*) stream.constData(), stream.size() - 1, decoded.data(), count))
+        fail("floats", QString("%1 without its last byte decoded").arg(name));
+}
+
+static void checkFloats(){
+    QVector<float> special;
+    special << 0.0f << -0.0f << 0.0f << -0.0f << -0.0f
+            << bitsFloat(0x7FC00000) << bitsFloat(0x7FC00001) << bitsFloat(0xFFC00000) << bitsFloat(0x7F800001)
+            << (float) INFINITY << (float) -INFINITY << bitsFloat(0x00000001) << bitsFloat(0x80000001)
+            << 3.4028235e38f << -3.4028235e38f << 1.17549435e-38f << 1.0f << bitsFloat(0x7FC00000) << 0.0f;
+    roundTripFloats("special values", special);
+
+    /*Sensor like columns: slow sine, steps, noise, interleaved as rows of three*/
+    QVector<float> rows(SERIES_LENGTH * 3);
+    for(int i = 0; i < SERIES_LENGTH; i++){
+        rows[i * 3] = roundf(sinf(i * 0.001f) * 100) / 100;
+        rows[i * 3 + 1] = 9.81f + (i / 200) * 0.01f;
+        rows[i * 3 + 2] = (float)(nextRandom() % 1000) / 7.0f;
+    }
+    QVector<float> column(SERIES_LENGTH);
+    for(int c = 0; c < 3; c++){
+        for(int i = 0; i < SERIES_LENGTH; i++){
+            column[i] = rows.at(i * 3 + c);
+        }
+        roundTripFloats(c == 0 ? "sine" : c == 1 ? "steps" : "noise", column);
+        roundTripFloats("row stride", rows.mid(c), 3);
+    }
+
+    QVector<float> patterns(SERIES_LENGTH);
+    for(int i = 0; i < patterns.size(); i++){
+        patterns[i] = bitsFloat(nextRandom());
+    }
+    roundTripFloats("random patterns", patterns);
+    roundTripFloats("empty", QVector<float>());
+}
+
+
+int main()
+{
+    checkBitStream();
+    checkTimestamps();
+    checkFloats();
+    if(failures)
+        fprintf(stderr, "%d failures\n", failures);
+    else
+        printf("All codec round trips match\n");
+    return failures ? 1 : 0;
+}
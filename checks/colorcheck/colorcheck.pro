@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Golden output and frame timing of the YCbCr 4:2:2
+# converters, every implementation the CPU supports
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+TARGET = colorcheck
+TEMPLATE = app
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+    ../../colorconversion.cpp
+
+HEADERS  += ../../colorconversion.h
@@ -0,0 +1,177 @@
+#include "colorconversion.h"
+
+#include <QElapsedTimer>
+#include <QVector>
+#include <QString>
+#include <stdio.h>
+
+#define FRAME_WIDTH 160
+#define FRAME_HEIGHT 121
+#define TIMING_MIN 200              /*ms per converter*/
+
+/*BT.601 studio range: black, white, gray, the 75% color bars and two clamped extremes*/
+struct GoldenPixel{
+    uint8_t y, cb, cr;
+    uint8_t r, g, b;
+};
+
+static const GoldenPixel goldenPixels[] = {
+    { 16, 128, 128,    0,   0,   0},
+    {235, 128, 128,  255, 255, 255},
+    {126, 128, 128,  128, 128, 128},
+    {162,  44, 142,  192, 191,   1},   /*yellow*/
+    {131, 156,  44,    0, 191, 190},   /*cyan*/
+    {112,  72,  58,    0, 191,   0},   /*green*/
+    { 84, 184, 198,  191,   0, 192},   /*magenta*/
+    { 65, 100, 212,  191,   0,   1},   /*red*/
+    { 35, 212, 114,    0,   1, 191},   /*blue*/
+    {255, 255, 255,  255, 125, 255},
+    {  0,   0,   0,    0, 135,   0}
+};
+
+/*FNV-1a of the converted fixed frames, RGB and grayscale*/
+struct GoldenFrame{
+    const char *name;
+    quint32 rgb;
+    quint32 gray;
+};
+
+static const GoldenFrame goldenFrames[] = {
+    {"gradient", 0xc84a5eb2, 0x2e1712c5},
+    {"noise",    0xbf1b5d86, 0x546c26c6}
+};
+
+static const char *const backends[] = {"generic", "SSE2", "AVX2"};
+
+static int failures = 0;
+
+static void fail(const char *backend, const QString &what){
+    fprintf(stderr, "FAIL %s: %s\n", backend, qPrintable(what));
+    failures++;
+}
+
+
+static QVector<uint8_t> fixedFrame(int index){
+    QVector<uint8_t> frame(FRAME_WIDTH * FRAME_HEIGHT * 2);
+    if(index == 0){
+        for(int y = 0; y < FRAME_HEIGHT; y++){
+            for(int x = 0; x < FRAME_WIDTH; x += 2){
+                uint8_t *pair = frame.data() + (y * FRAME_WIDTH + x) * 2;
+                pair[0] = (x + 2 * y) & 255;
+                pair[1] = (x * 3 + y) & 255;
+                pair[2] = (x + 1 + 2 * y) & 255;
+                pair[3] = (255 - x + y * 5) & 255;
+            }
+        }
+    }
+    else{
+        quint32 random = 12345;
+        for(int i = 0; i < frame.size(); i++){
+            random = random * 1664525 + 1013904223;
+            frame[i] = random >> 24;
+        }
+    }
+    return frame;
+}
+
+static QVector<QRgb> convertFrame(ColorLineConverter convert, const QVector<uint8_t> &frame){
+    QVector<QRgb> image(FRAME_WIDTH * FRAME_HEIGHT);
+    for(int line = 0; line < FRAME_HEIGHT; line++){
+        convert(frame.constData() + line * FRAME_WIDTH * 2, image.data() + line * FRAME_WIDTH, FRAME_WIDTH);
+    }
+    return image;
+}
+
+static quint32 fnv(const QVector<QRgb> &image){
+    quint32 hash = 2166136261u;
+    for(int i = 0; i < image.size(); i++){
+        for(int byte = 0; byte < 4; byte++){
+            hash ^= (image.at(i) >> (8 * byte)) & 0xFF;
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+
+/*Every golden pixel pair over a whole line, so the SIMD body and the generic tail both see them*/
+static void checkPixels(const char *backend){
+    ColorLineConverter rgb = colorLineConverter(backend, ColorModeRgb);
+    ColorLineConverter gray = colorLineConverter(backend, ColorModeGrayscale);
+    const int count = sizeof(goldenPixels) / sizeof(goldenPixels[0]);
+    const int width = count * 2 * 4 + 2;
+    QVector<uint8_t> line(width * 2);
+    for(int pair = 0; pair < width / 2; pair++){
+        const GoldenPixel &pixel = goldenPixels[pair % count];
+        uint8_t *bytes = line.data() + pair * 4;
+        bytes[0] = pixel.y;
+        bytes[1] = pixel.cb;
+        bytes[2] = pixel.y;
+        bytes[3] = pixel.cr;
+    }
+
+    QVector<QRgb> rgbLine(width);
+    QVector<QRgb> grayLine(width);
+    rgb(line.constData(), rgbLine.data(), width);
+    gray(line.constData(), grayLine.data(), width);
+    for(int i = 0; i < width; i++){
+        const GoldenPixel &pixel = goldenPixels[(i / 2) % count];
+        QRgb expected = qRgb(pixel.r, pixel.g, pixel.b);
+        if(rgbLine.at(i) != expected)
+            fail(backend, QString("pixel %1 (Y %2 Cb %3 Cr %4) is %5, expected %6").arg(i).arg(pixel.y).arg(pixel.cb).arg(pixel.cr)
+                 .arg(rgbLine.at(i), 8, 16, QChar('0')).arg(expected, 8, 16, QChar('0')));
+        if(grayLine.at(i) != qRgb(pixel.y, pixel.y, pixel.y))
+            fail(backend, QString("grayscale pixel %1 is %2").arg(i).arg(grayLine.at(i), 8, 16, QChar('0')));
+    }
+}
+
+static void checkFrames(const char *backend){
+    for(unsigned f = 0; f < sizeof(goldenFrames) / sizeof(goldenFrames[0]); f++){
+        QVector<uint8_t> frame = fixedFrame(f);
+        quint32 rgb = fnv(convertFrame(colorLineConverter(backend, ColorModeRgb), frame));
+        quint32 gray = fnv(convertFrame(colorLineConverter(backend, ColorModeGrayscale), frame));
+        if(rgb != goldenFrames[f].rgb)
+            fail(backend, QString("%1 frame digest %2").arg(goldenFrames[f].name).arg(rgb, 8, 16, QChar('0')));
+        if(gray != goldenFrames[f].gray)
+            fail(backend, QString("%1 grayscale frame digest %2").arg(goldenFrames[f].name).arg(gray, 8, 16, QChar('0')));
+    }
+}
+
+/*Whole frames, as Imagelink converts them*/
+static double frameTime(ColorLineConverter convert){
+    QVector<uint8_t> frame = fixedFrame(1);
+    QVector<QRgb> image(FRAME_WIDTH * FRAME_HEIGHT);
+    QElapsedTimer timer;
+    qint64 frames = 0;
+    timer.start();
+    do{
+        for(int line = 0; line < FRAME_HEIGHT; line++){
+            convert(frame.constData() + line * FRAME_WIDTH * 2, image.data() + line * FRAME_WIDTH, FRAME_WIDTH);
+        }
+        frames++;
+    } while(timer.elapsed() < TIMING_MIN);
+    return (double) timer.nsecsElapsed() / frames;
+}
+
+
+int main()
+{
+    printf("Runtime backend: %s\n", colorConversionBackend());
+    printf("%-8s %14s %14s\n", "backend", "RGB ns/frame", "gray ns/frame");
+    for(unsigned b = 0; b < sizeof(backends) / sizeof(backends[0]); b++){
+        const char *backend = backends[b];
+        if(!colorLineConverter(backend, ColorModeRgb)){
+            printf("%-8s %14s %14s\n", backend, "unavailable", "unavailable");
+            continue;
+        }
+        checkPixels(backend);
+        checkFrames(backend);
+        printf("%-8s %14.0f %14.0f\n", backend, frameTime(colorLineConverter(backend, ColorModeRgb)),
+               frameTime(colorLineConverter(backend, ColorModeGrayscale)));
+    }
+    if(failures)
+        fprintf(stderr, "%d failures\n", failures);
+    else
+        printf("All converters match the golden output\n");
+    return failures ? 1 : 0;
+}
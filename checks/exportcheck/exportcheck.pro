@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# Round trips of the telemetry export: every row of
+# the store has to arrive in the CSV and binary files
+#
+#-------------------------------------------------
+
+QT       += core concurrent
+QT       -= gui
+
+TARGET = exportcheck
+TEMPLATE = app
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+    ../../telemetryexport.cpp \
+    ../../telemetrystore.cpp \
+    ../../telemetrydictionary.cpp \
+    ../../payload.cpp \
+    ../../clocksync.cpp
+
+HEADERS  += ../../telemetryexport.h \
+    ../../telemetrystore.h \
+    ../../telemetrydictionary.h \
+    ../../payload.h \
+    ../../payloadschema.h \
+    ../../clocksync.h
@@ -0,0 +1,176 @@
+#include "telemetryexport.h"
+#include "telemetrydictionary.h"
+#include "telemetrystore.h"
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QThread>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QVector>
+#include <QString>
+#include <stdio.h>
+#include <math.h>
+
+#define SAMPLE_PERIOD 1000000           /*ns, 1 kHz*/
+
+/*Row counts around the CSV batches and the window of batches formatted at once*/
+struct ExportCase{
+    const char *name;
+    qint64 counterRows;
+    qint64 imuRows;
+    bool counterOnly;                   /*only the counter column, keeps the large cases small*/
+};
+
+static int failures = 0;
+
+static void fail(const char *name, const QString &what){
+    fprintf(stderr, "FAIL %s: %s\n", name, qPrintable(what));
+    failures++;
+}
+
+
+/*Topics interleave by time, every 97th IMU row has no values*/
+static void fillStore(TelemetryStore &store, const TelemetryDictionary &dictionary, const ExportCase &exportCase){
+    const TelemetryTopic *counter = dictionary.topic(PayloadCounterType);
+    const TelemetryTopic *imu = dictionary.topic(PayloadSensorIMUType);
+    QVector<float> values(qMax(counter->opCount, imu->opCount));
+    qint64 rows = qMax(exportCase.counterRows, exportCase.imuRows);
+    for(qint64 i = 0; i < rows; i++){
+        if(i < exportCase.counterRows){
+            values.fill((float) i);
+            store.writeSample(*counter, (i + 1) * SAMPLE_PERIOD, values.constData());
+        }
+        if(i < exportCase.imuRows){
+            values.fill(i % 97 ? i * 0.5f : NAN);
+            store.writeSample(*imu, (i + 1) * SAMPLE_PERIOD + SAMPLE_PERIOD / 2, values.constData());
+        }
+    }
+}
+
+static QVector<int> exportChannels(const TelemetryDictionary &dictionary, bool counterOnly){
+    QVector<int> channels;
+    const PayloadType types[] = {PayloadCounterType, PayloadSensorIMUType};
+    for(int t = 0; t < (counterOnly ? 1 : 2); t++){
+        const TelemetryTopic *topic = dictionary.topic(types[t]);
+        for(int c = 0; c < topic->opCount; c++){
+            channels.append(topic->firstOp + c);
+        }
+    }
+    return channels;
+}
+
+
+/*Every row has a cell per column and the times never go back*/
+static qint64 csvRows(const char *name, const QString &fileName, int columns){
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly)){
+        fail(name, "CSV file could not be read back");
+        return -1;
+    }
+    QByteArray header = file.readLine();
+    if(header.count(',') != columns)
+        fail(name, QString("CSV header has %1 columns instead of %2").arg(header.count(',')).arg(columns));
+    qint64 rows = 0;
+    double previous = 0;
+    while(!file.atEnd()){
+        QByteArray line = file.readLine();
+        double time = line.left(line.indexOf(',')).toDouble();
+        if(!line.endsWith('\n') || line.count(',') != columns || time < previous){
+            fail(name, QString("CSV row %1 is malformed: %2").arg(rows).arg(QString::fromLatin1(line.trimmed())));
+            return -1;
+        }
+        previous = time;
+        rows++;
+    }
+    return rows;
+}
+
+/*Rows of the descriptor, and the file has to end right behind the last column*/
+static qint64 binaryRows(const char *name, const QString &fileName){
+    QFile file(fileName);
+    TelemetryExportHeader header;
+    if(!file.open(QIODevice::ReadOnly) || file.read((char*)&header, sizeof(header)) != sizeof(header)
+            || header.magic != TELEMETRY_EXPORT_MAGIC || header.version != TELEMETRY_EXPORT_VERSION){
+        fail(name, "binary file has no valid header");
+        return -1;
+    }
+    QJsonObject root = QJsonDocument::fromJson(file.read(header.descriptorBytes)).object();
+    qint64 rows = 0;
+    qint64 columnBytes = 0;
+    foreach(const QJsonValue &value, root.value("topics").toArray()){
+        QJsonObject topic = value.toObject();
+        qint64 topicRows = (qint64) topic.value("rows").toDouble();
+        rows += topicRows;
+        columnBytes += topicRows * sizeof(qint64) + topic.value("channels").toArray().size() * ((topicRows * sizeof(float) + 7) / 8 * 8);
+    }
+    qint64 expectedSize = sizeof(header) + header.descriptorBytes + columnBytes;
+    if(file.size() != expectedSize)
+        fail(name, QString("binary file has %1 bytes instead of %2").arg(file.size()).arg(expectedSize));
+    return rows;
+}
+
+
+static void checkCase(const TelemetryDictionary &dictionary, const ExportCase &exportCase, const QString &directory){
+    TelemetryStore store(&dictionary);
+    fillStore(store, dictionary, exportCase);
+    QVector<int> channels = exportChannels(dictionary, exportCase.counterOnly);
+    qint64 expected = exportCase.counterRows + (exportCase.counterOnly ? 0 : exportCase.imuRows);
+    qint64 to = (qMax(exportCase.counterRows, exportCase.imuRows) + 1) * SAMPLE_PERIOD;
+    TelemetryExporter exporter(&store, &dictionary);
+    QString error;
+
+    QString csvName = directory + "/export.csv";
+    if(!exporter.write(csvName, channels, 0, to, TelemetryExportCsv, &error))
+        fail(exportCase.name, "CSV export failed: " + error);
+    if(exporter.rowCount() != expected)
+        fail(exportCase.name, QString("CSV export counts %1 rows instead of %2").arg(exporter.rowCount()).arg(expected));
+    qint64 rows = csvRows(exportCase.name, csvName, channels.size());
+    if(rows >= 0 && rows != expected)
+        fail(exportCase.name, QString("CSV file holds %1 rows instead of %2").arg(rows).arg(expected));
+
+    QString binaryName = directory + "/export.tlmx";
+    if(!exporter.write(binaryName, channels, 0, to, TelemetryExportBinary, &error))
+        fail(exportCase.name, "binary export failed: " + error);
+    if(exporter.rowCount() != expected)
+        fail(exportCase.name, QString("binary export counts %1 rows instead of %2").arg(exporter.rowCount()).arg(expected));
+    rows = binaryRows(exportCase.name, binaryName);
+    if(rows >= 0 && rows != expected)
+        fail(exportCase.name, QString("binary file holds %1 rows instead of %2").arg(rows).arg(expected));
+    printf("%-28s %9lld rows\n", exportCase.name, expected);
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    QTemporaryDir directory;
+    if(!directory.isValid()){
+        fprintf(stderr, "No temporary directory\n");
+        return 1;
+    }
+
+    const qint64 batch = TELEMETRY_EXPORT_BATCH_ROWS;
+    const qint64 window = qMax(1, QThread::idealThreadCount()) * 2;    /*as in TelemetryExporter::writeCsv*/
+    const ExportCase cases[] = {
+        {"empty",                       0,      0,      false},
+        {"single row",                  1,      0,      false},
+        {"less than a batch",           10,     3,      false},
+        {"one batch",                   batch / 2, batch / 2, false},
+        {"one batch and a row",         batch / 2 + 1, batch / 2, false},
+        {"one window",                  batch * window, 0, true},
+        {"more than a window",          batch * (window + 1) + 7, 0, true}
+    };
+
+    TelemetryDictionary dictionary;
+    for(unsigned c = 0; c < sizeof(cases) / sizeof(cases[0]); c++){
+        checkCase(dictionary, cases[c], directory.path());
+    }
+    if(failures)
+        fprintf(stderr, "%d failures\n", failures);
+    else
+        printf("Every exported row arrived in the files\n");
+    return failures ? 1 : 0;
+}
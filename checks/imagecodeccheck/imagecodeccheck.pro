@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Loopback of the compressed image downlink codec:
+# lossless round trips, link size and rejection of
+# truncated and corrupted messages
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = imagecodeccheck
+TEMPLATE = app
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+    ../../imagecodec.cpp \
+    ../../framestore.cpp
+
+HEADERS  += ../../imagecodec.h \
+    ../../framestore.h
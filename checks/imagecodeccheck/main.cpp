@@ -0,0 +1,204 @@
+#include "imagecodec.h"
+#include "framestore.h"
+
+#include <QByteArray>
+#include <QString>
+#include <stdio.h>
+
+#define FRAME_WIDTH 160                 /*IMAGE_WIDTH of imagelink.h*/
+#define FRAME_HEIGHT 121                /*IMAGE_HEIGHT of imagelink.h*/
+#define SMOOTH_MIN_RATIO 5.0            /*link bytes saved at least on the camera like frame*/
+#define GARBAGE_MESSAGES 64
+
+static int failures = 0;
+
+static void fail(const char *name, const QString &what){
+    fprintf(stderr, "FAIL %s: %s\n", name, qPrintable(what));
+    failures++;
+}
+
+
+static quint32 seed = 12345;
+
+static quint32 nextRandom(){
+    seed = seed * 1664525 + 1013904223;
+    return seed;
+}
+
+static uchar clampByte(int value){
+    return (uchar) qBound(0, value, 255);
+}
+
+
+/*YCbCr 4:2:2 (Y0 Cb Y1 Cr) test frames*/
+enum FrameKind{
+    FrameSimulator,                     /*the synthetic frames of the camera simulator*/
+    FrameSmooth,                        /*gradients with sensor noise, like the camera*/
+    FrameFlat,
+    FrameExtremes,                      /*0 and 255 alternating, largest residuals*/
+    FrameRandom                         /*incompressible, escape codes*/
+};
+
+static QByteArray testFrame(FrameKind kind, int width, int height, int index){
+    QByteArray raw(width * height * 2, 0x00);
+    uchar *bytes = (uchar*) raw.data();
+    for(int y = 0; y < height; y++){
+        for(int x = 0; x < width; x += 2){
+            uchar *pair = bytes + (y * width + x) * 2;
+            switch(kind){
+            case FrameSimulator:
+                pair[0] = 16 + (x + y + index * 4) % 220;
+                pair[1] = 128 + (x / 20 % 2 ? 60 : -60);
+                pair[2] = 16 + (x + 1 + y + index * 4) % 220;
+                pair[3] = 128 + (y / 20 % 2 ? 60 : -60);
+                break;
+            case FrameSmooth:
+                pair[0] = clampByte(40 + x + y / 2 + (int)(nextRandom() >> 30) - 2);
+                pair[1] = clampByte(110 + y / 8 + (int)(nextRandom() >> 31));
+                pair[2] = clampByte(41 + x + y / 2 + (int)(nextRandom() >> 30) - 2);
+                pair[3] = clampByte(140 - x / 8 + (int)(nextRandom() >> 31));
+                break;
+            case FrameFlat:
+                pair[0] = pair[2] = 16;
+                pair[1] = pair[3] = 128;
+                break;
+            case FrameExtremes:
+                pair[0] = pair[1] = ((x / 2 + y) % 2) ? 255 : 0;
+                pair[2] = pair[3] = ((x / 2 + y) % 2) ? 0 : 255;
+                break;
+            case FrameRandom:
+                for(int i = 0; i < 4; i++){
+                    pair[i] = nextRandom() >> 24;
+                }
+                break;
+            }
+        }
+    }
+    return raw;
+}
+
+
+/*Message bytes on the link, flags included*/
+static int rawLinkBytes(const QByteArray &raw){
+    return 12 + raw.size() * 3 + 11;
+}
+
+static int compressedLinkBytes(const QByteArray &encoded){
+    return 13 + encoded.size() + 12;
+}
+
+
+static bool decodes(const QByteArray &encoded, int width, int height){
+    QByteArray decoded;
+    return decodeImage(encoded, decoded, width, height);
+}
+
+/*Truncated messages, bits behind the last pixel and a wrong version must all be refused*/
+static void checkRejects(const char *name, const QByteArray &encoded, int width, int height){
+    /*Cut the bit stream, cutting Base64 characters may only remove the = padding*/
+    QByteArray packed = QByteArray::fromBase64(encoded);
+    for(int cut = 1; cut <= 8 && cut < packed.size(); cut++){
+        if(decodes(packed.left(packed.size() - cut).toBase64(), width, height))
+            fail(name, QString("decoded with %1 bytes cut off").arg(cut));
+    }
+    if(decodes((packed + '\x5A').toBase64(), width, height))
+        fail(name, "decoded with a byte of garbage appended");
+    if(decodes((packed + QByteArray(1, '\0')).toBase64(), width, height))
+        fail(name, "decoded with a zero byte appended");
+
+    /*The padding of the last byte has to stay zero*/
+    QByteArray flipped = packed;
+    flipped[flipped.size() - 1] = flipped.at(flipped.size() - 1) ^ 1;
+    QByteArray decoded;
+    if(decodeImage(flipped.toBase64(), decoded, width, height)){
+        QByteArray original;
+        decodeImage(encoded, original, width, height);
+        if(decoded == original)
+            fail(name, "decoded with a padding bit set");
+    }
+
+    QByteArray version = packed;
+    version[0] = version.at(0) + 1;
+    if(decodes(version.toBase64(), width, height))
+        fail(name, "decoded with an unknown version");
+}
+
+static void checkFrame(const char *name, const QByteArray &raw, int width, int height, double minRatio = 0){
+    QByteArray encoded = encodeImage(raw, width, height);
+    if(encoded.contains('&'))
+        fail(name, "encoded frame contains &");
+    QByteArray decoded;
+    if(!decodeImage(encoded, decoded, width, height))
+        fail(name, "encoded frame not accepted");
+    else if(decoded != raw)
+        fail(name, "decoded frame differs");
+    checkRejects(name, encoded, width, height);
+
+    double ratio = (double) rawLinkBytes(raw) / compressedLinkBytes(encoded);
+    if(ratio < minRatio)
+        fail(name, QString("only %1 times fewer link bytes, at least %2 expected").arg(ratio).arg(minRatio));
+    printf("%-24s %4dx%-4d %8d -> %7d link bytes, %5.2f times fewer\n", name, width, height,
+           rawLinkBytes(raw), compressedLinkBytes(encoded), ratio);
+}
+
+
+/*Random data as Base64 and as text, with and without a valid version byte*/
+static void checkGarbage(){
+    for(int i = 0; i < GARBAGE_MESSAGES; i++){
+        QByteArray garbage((int)(nextRandom() % 60000), 0x00);
+        for(int b = 0; b < garbage.size(); b++){
+            garbage[b] = (char)(nextRandom() >> 24);
+        }
+        if(i % 2 && !garbage.isEmpty())
+            garbage[0] = 1;
+        if(decodes(garbage.toBase64(), FRAME_WIDTH, FRAME_HEIGHT))
+            fail("garbage", QString("%1 random bytes decoded as a frame").arg(garbage.size()));
+        if(decodes(garbage, FRAME_WIDTH, FRAME_HEIGHT))
+            fail("garbage", QString("%1 random characters decoded as a frame").arg(garbage.size()));
+    }
+    if(decodes(QByteArray(), FRAME_WIDTH, FRAME_HEIGHT))
+        fail("garbage", "empty message decoded as a frame");
+}
+
+
+/*Frames of image archives given on the command line, "make check" runs without*/
+static void checkRecording(const char *fileName){
+    FrameStore store(FRAME_WIDTH, FRAME_HEIGHT);
+    if(!store.open(QString::fromLocal8Bit(fileName))){
+        fail(fileName, "no image archive of 160x121 frames");
+        return;
+    }
+    for(int i = 0; i < store.count(); i++){
+        QByteArray raw((const char*) store.frame(i), FRAME_WIDTH * FRAME_HEIGHT * 2);
+        checkFrame(qPrintable(QString("%1 #%2").arg(QString::fromLocal8Bit(fileName)).arg(i + 1)), raw, FRAME_WIDTH, FRAME_HEIGHT);
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    for(int index = 0; index < 3; index++){
+        checkFrame(qPrintable(QString("simulator frame %1").arg(index)), testFrame(FrameSimulator, FRAME_WIDTH, FRAME_HEIGHT, index),
+                   FRAME_WIDTH, FRAME_HEIGHT);
+    }
+    checkFrame("smooth", testFrame(FrameSmooth, FRAME_WIDTH, FRAME_HEIGHT, 0), FRAME_WIDTH, FRAME_HEIGHT, SMOOTH_MIN_RATIO);
+    checkFrame("flat", testFrame(FrameFlat, FRAME_WIDTH, FRAME_HEIGHT, 0), FRAME_WIDTH, FRAME_HEIGHT);
+    checkFrame("extremes", testFrame(FrameExtremes, FRAME_WIDTH, FRAME_HEIGHT, 0), FRAME_WIDTH, FRAME_HEIGHT);
+    checkFrame("random", testFrame(FrameRandom, FRAME_WIDTH, FRAME_HEIGHT, 0), FRAME_WIDTH, FRAME_HEIGHT);
+
+    /*Edges of the predictor: one pixel pair, a single line, a single column of pairs*/
+    checkFrame("2x1 random", testFrame(FrameRandom, 2, 1, 0), 2, 1);
+    checkFrame("160x1 smooth", testFrame(FrameSmooth, 160, 1, 0), 160, 1);
+    checkFrame("2x121 extremes", testFrame(FrameExtremes, 2, 121, 0), 2, 121);
+
+    checkGarbage();
+    for(int i = 1; i < argc; i++){
+        checkRecording(argv[i]);
+    }
+
+    if(failures)
+        fprintf(stderr, "%d failures\n", failures);
+    else
+        printf("All frames survive the loopback, broken messages are refused\n");
+    return failures ? 1 : 0;
+}
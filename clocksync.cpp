@@ -0,0 +1,138 @@
+#include "clocksync.h"
+
+#include <QElapsedTimer>
+#include <QDateTime>
+
+/*------------*/
+/*Ground clock*/
+/*------------*/
+
+struct GroundClock{
+    QElapsedTimer timer;
+    qint64 wallStart;
+    GroundClock(){
+        timer.start();
+        wallStart = QDateTime::currentMSecsSinceEpoch();
+    }
+};
+
+static GroundClock &groundClock(){
+    static GroundClock clock;
+    return clock;
+}
+
+qint64 groundTime(){
+    return groundClock().timer.nsecsElapsed();
+}
+
+qint64 groundWallClock(qint64 time){
+    return groundClock().wallStart + time / 1000000;
+}
+
+double groundSeconds(qint64 time){
+    return groundClock().wallStart / 1000.0 + time / 1e9;
+}
+
+
+/*----------*/
+/*Clock sync*/
+/*----------*/
+
+ClockSync::ClockSync(){
+    reset();
+}
+
+
+void ClockSync::reset(){
+    points.clear();
+    hull.clear();
+    origin = 0;
+    valid = false;
+    fitOffset = 0;
+    fitDrift = 0;
+}
+
+
+/*Only the minimum delay of every bucket is kept, that is all the envelope needs*/
+void ClockSync::addSample(quint64 satelliteTime, qint64 receiveTime){
+    if(!valid){
+        origin = satelliteTime;
+        valid = true;
+    }
+    qint64 x = (qint64)(satelliteTime - origin);
+
+    /*Satellite rebooted or its clock was set: start over*/
+    if(x < 0 && (points.isEmpty() || x < points.first().x - CLOCK_SYNC_BUCKET)){
+        reset();
+        addSample(satelliteTime, receiveTime);
+        return;
+    }
+
+    Point point;
+    point.x = x;
+    point.y = receiveTime - x;
+    if(!points.isEmpty() && x / CLOCK_SYNC_BUCKET <= points.last().x / CLOCK_SYNC_BUCKET){
+        /*Late packets of older buckets are slow ones anyway*/
+        if(x / CLOCK_SYNC_BUCKET < points.last().x / CLOCK_SYNC_BUCKET || point.y >= points.last().y)
+            return;
+        points.last() = point;
+    }
+    else{
+        points.append(point);
+        if(points.size() > CLOCK_SYNC_WINDOW)
+            points.remove(0);
+    }
+    fit();
+}
+
+
+/*Among all lines below every point, the one with the smallest summed distance
+ * is the lower hull edge spanning the mean x of the points.*/
+void ClockSync::fit(){
+    hull.resize(0);
+    double meanX = 0;
+    foreach(const Point &p, points){
+        meanX += p.x;
+        while(hull.size() >= 2){
+            const Point &a = hull.at(hull.size() - 2);
+            const Point &b = hull.at(hull.size() - 1);
+            double cross = (double)(b.x - a.x) * (p.y - a.y) - (double)(b.y - a.y) * (p.x - a.x);
+            if(cross > 0)
+                break;
+            hull.remove(hull.size() - 1);
+        }
+        hull.append(p);
+    }
+    meanX /= points.size();
+
+    if(hull.size() < 2){
+        fitDrift = 0;
+        fitOffset = hull.first().y;
+        return;
+    }
+    int i = 0;
+    while(i < hull.size() - 2 && hull.at(i + 1).x < meanX)
+        i++;
+    const Point &a = hull.at(i);
+    const Point &b = hull.at(i + 1);
+    fitDrift = qBound(-CLOCK_SYNC_MAX_DRIFT, (double)(b.y - a.y) / (b.x - a.x), CLOCK_SYNC_MAX_DRIFT);
+    fitOffset = a.y - fitDrift * a.x;
+}
+
+
+qint64 ClockSync::toGround(quint64 satelliteTime) const{
+    if(!valid)
+        return 0;
+    qint64 x = (qint64)(satelliteTime - origin);
+    return x + (qint64)(fitOffset + fitDrift * x);
+}
+
+
+bool ClockSync::isValid() const{
+    return valid;
+}
+
+
+double ClockSync::drift() const{
+    return fitDrift;
+}
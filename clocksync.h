@@ -0,0 +1,45 @@
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+#include <QtGlobal>
+#include <QVector>
+
+#define CLOCK_SYNC_BUCKET 1000000000LL  /*ns of satellite time folded into one envelope point*/
+#define CLOCK_SYNC_WINDOW 300           /*envelope points the fit runs over*/
+#define CLOCK_SYNC_MAX_DRIFT 0.001      /*1000 ppm, far beyond any crystal*/
+
+/*Ground clock: monotonic ns, anchored to the wall clock once at startup*/
+qint64 groundTime();
+qint64 groundWallClock(qint64 time);    /*ms since epoch*/
+double groundSeconds(qint64 time);      /*s since epoch, used as plot key*/
+
+/*Online estimate of satellite clock -> ground clock.
+ * Every packet gives delay = receive time - satellite time = offset + drift*t + latency.
+ * The latency is never negative, so the fastest packets form a lower envelope and
+ * the line fitted under it is the clock relation plus the minimal link latency.*/
+class ClockSync
+{
+public:
+    ClockSync();
+    void reset();
+    void addSample(quint64 satelliteTime, qint64 receiveTime);
+    qint64 toGround(quint64 satelliteTime) const;   /*satellite ns -> ground ns*/
+    bool isValid() const;
+    double drift() const;                           /*ns per ns*/
+
+private:
+    struct Point{
+        qint64 x;       /*satellite time since origin*/
+        qint64 y;       /*receive time - x*/
+    };
+    QVector<Point> points;
+    QVector<Point> hull;
+    quint64 origin;
+    bool valid;
+    double fitOffset;
+    double fitDrift;
+
+    void fit();
+};
+
+#endif // CLOCKSYNC_H
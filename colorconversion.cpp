@@ -0,0 +1,274 @@
+#include "colorconversion.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COLORCONVERSION_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(COLORCONVERSION_SSE2) && (defined(__GNUC__) || defined(__AVX2__))
+#define COLORCONVERSION_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define COLORCONVERSION_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define COLORCONVERSION_TARGET_AVX2
+#endif
+
+/*ITU-R BT.601, studio range (Y 16..235, CbCr 16..240), 8 bit fixed point:
+ * R = (298*(Y-16)               + 409*(Cr-128) + 128) >> 8
+ * G = (298*(Y-16) - 100*(Cb-128) - 208*(Cr-128) + 128) >> 8
+ * B = (298*(Y-16) + 516*(Cb-128)                + 128) >> 8 */
+#define COEFF_Y 298
+#define COEFF_RCR 409
+#define COEFF_GCB -100
+#define COEFF_GCR -208
+#define COEFF_BCB 516
+
+static inline uint8_t clamp8(int value){
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+
+/*-------------------*/
+/*Generic conversions*/
+/*-------------------*/
+
+static void convertLineGeneric(const uint8_t *src, QRgb *dst, int width){
+    for(int column = 0; column < width; column += 2, src += 4, dst += 2){
+        int y1 = COEFF_Y * (src[0] - 16);
+        int y2 = COEFF_Y * (src[2] - 16);
+        int d = src[1] - 128;
+        int e = src[3] - 128;
+        int r = COEFF_RCR * e + 128;
+        int g = COEFF_GCB * d + COEFF_GCR * e + 128;
+        int b = COEFF_BCB * d + 128;
+        dst[0] = qRgb(clamp8((y1 + r) >> 8), clamp8((y1 + g) >> 8), clamp8((y1 + b) >> 8));
+        dst[1] = qRgb(clamp8((y2 + r) >> 8), clamp8((y2 + g) >> 8), clamp8((y2 + b) >> 8));
+    }
+}
+
+static void convertGrayGeneric(const uint8_t *src, QRgb *dst, int width){
+    for(int column = 0; column < width; column += 2, src += 4, dst += 2){
+        dst[0] = qRgb(src[0], src[0], src[0]);
+        dst[1] = qRgb(src[2], src[2], src[2]);
+    }
+}
+
+
+/*----------------*/
+/*SSE2, 8 pixels per iteration*/
+/*----------------*/
+
+#ifdef COLORCONVERSION_SSE2
+
+/*Interleave 8 B, G, R bytes (lower halves) into 8 RGB32 pixels*/
+static inline void storePixelsSse2(__m128i b, __m128i g, __m128i r, QRgb *dst){
+    __m128i bg = _mm_unpacklo_epi8(b, g);
+    __m128i ra = _mm_unpacklo_epi8(r, _mm_set1_epi8((char)0xFF));
+    _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i*)(dst + 4), _mm_unpackhi_epi16(bg, ra));
+}
+
+static void convertLineSse2(const uint8_t *src, QRgb *dst, int width){
+    const __m128i lowByte = _mm_set1_epi16(0x00FF);
+    const __m128i offsetY = _mm_set1_epi16(16);
+    const __m128i offsetC = _mm_set1_epi16(128);
+    const __m128i rounding = _mm_set1_epi32(128);
+    const __m128i zero = _mm_setzero_si128();
+    /*Word pairs for madd: (luma, 0) and (Cb, Cr)*/
+    const __m128i coeffY = _mm_set1_epi32(COEFF_Y);
+    const __m128i coeffR = _mm_set1_epi32((COEFF_RCR << 16));
+    const __m128i coeffG = _mm_set1_epi32((int)((unsigned)COEFF_GCR << 16) | (COEFF_GCB & 0xFFFF));
+    const __m128i coeffB = _mm_set1_epi32(COEFF_BCB);
+
+    int column = 0;
+    for(; column + 8 <= width; column += 8, src += 16, dst += 8){
+        __m128i raw = _mm_loadu_si128((const __m128i*)src);
+
+        /*Y0..Y7 and Cb0 Cr0 .. Cb3 Cr3 as signed words*/
+        __m128i y = _mm_sub_epi16(_mm_and_si128(raw, lowByte), offsetY);
+        __m128i c = _mm_sub_epi16(_mm_srli_epi16(raw, 8), offsetC);
+
+        __m128i yLow = _mm_madd_epi16(_mm_unpacklo_epi16(y, zero), coeffY);
+        __m128i yHigh = _mm_madd_epi16(_mm_unpackhi_epi16(y, zero), coeffY);
+
+        /*One chroma term per pixel pair, spread to both pixels*/
+        __m128i r = _mm_add_epi32(_mm_madd_epi16(c, coeffR), rounding);
+        __m128i g = _mm_add_epi32(_mm_madd_epi16(c, coeffG), rounding);
+        __m128i b = _mm_add_epi32(_mm_madd_epi16(c, coeffB), rounding);
+
+        __m128i r16 = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLow, _mm_shuffle_epi32(r, _MM_SHUFFLE(1, 1, 0, 0))), 8),
+                                      _mm_srai_epi32(_mm_add_epi32(yHigh, _mm_shuffle_epi32(r, _MM_SHUFFLE(3, 3, 2, 2))), 8));
+        __m128i g16 = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLow, _mm_shuffle_epi32(g, _MM_SHUFFLE(1, 1, 0, 0))), 8),
+                                      _mm_srai_epi32(_mm_add_epi32(yHigh, _mm_shuffle_epi32(g, _MM_SHUFFLE(3, 3, 2, 2))), 8));
+        __m128i b16 = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLow, _mm_shuffle_epi32(b, _MM_SHUFFLE(1, 1, 0, 0))), 8),
+                                      _mm_srai_epi32(_mm_add_epi32(yHigh, _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 3, 2, 2))), 8));
+
+        /*Saturating pack does the clamping to [0,255]*/
+        storePixelsSse2(_mm_packus_epi16(b16, b16), _mm_packus_epi16(g16, g16), _mm_packus_epi16(r16, r16), dst);
+    }
+    convertLineGeneric(src, dst, width - column);
+}
+
+static void convertGraySse2(const uint8_t *src, QRgb *dst, int width){
+    const __m128i lowByte = _mm_set1_epi16(0x00FF);
+    int column = 0;
+    for(; column + 8 <= width; column += 8, src += 16, dst += 8){
+        __m128i y16 = _mm_and_si128(_mm_loadu_si128((const __m128i*)src), lowByte);
+        __m128i y = _mm_packus_epi16(y16, y16);
+        storePixelsSse2(y, y, y, dst);
+    }
+    convertGrayGeneric(src, dst, width - column);
+}
+
+#endif
+
+
+/*-----------------*/
+/*AVX2, 16 pixels per iteration*/
+/*-----------------*/
+
+#ifdef COLORCONVERSION_AVX2
+
+/*Same as the SSE2 path per 128 bit lane; lanes hold pixels 0..7 and 8..15*/
+COLORCONVERSION_TARGET_AVX2
+static inline void storePixelsAvx2(__m256i b, __m256i g, __m256i r, QRgb *dst){
+    __m256i bg = _mm256_unpacklo_epi8(b, g);
+    __m256i ra = _mm256_unpacklo_epi8(r, _mm256_set1_epi8((char)0xFF));
+    __m256i low = _mm256_unpacklo_epi16(bg, ra);
+    __m256i high = _mm256_unpackhi_epi16(bg, ra);
+    _mm256_storeu_si256((__m256i*)dst, _mm256_permute2x128_si256(low, high, 0x20));
+    _mm256_storeu_si256((__m256i*)(dst + 8), _mm256_permute2x128_si256(low, high, 0x31));
+}
+
+COLORCONVERSION_TARGET_AVX2
+static void convertLineAvx2(const uint8_t *src, QRgb *dst, int width){
+    const __m256i lowByte = _mm256_set1_epi16(0x00FF);
+    const __m256i offsetY = _mm256_set1_epi16(16);
+    const __m256i offsetC = _mm256_set1_epi16(128);
+    const __m256i rounding = _mm256_set1_epi32(128);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i coeffY = _mm256_set1_epi32(COEFF_Y);
+    const __m256i coeffR = _mm256_set1_epi32((COEFF_RCR << 16));
+    const __m256i coeffG = _mm256_set1_epi32((int)((unsigned)COEFF_GCR << 16) | (COEFF_GCB & 0xFFFF));
+    const __m256i coeffB = _mm256_set1_epi32(COEFF_BCB);
+
+    int column = 0;
+    for(; column + 16 <= width; column += 16, src += 32, dst += 16){
+        __m256i raw = _mm256_loadu_si256((const __m256i*)src);
+
+        __m256i y = _mm256_sub_epi16(_mm256_and_si256(raw, lowByte), offsetY);
+        __m256i c = _mm256_sub_epi16(_mm256_srli_epi16(raw, 8), offsetC);
+
+        __m256i yLow = _mm256_madd_epi16(_mm256_unpacklo_epi16(y, zero), coeffY);
+        __m256i yHigh = _mm256_madd_epi16(_mm256_unpackhi_epi16(y, zero), coeffY);
+
+        __m256i r = _mm256_add_epi32(_mm256_madd_epi16(c, coeffR), rounding);
+        __m256i g = _mm256_add_epi32(_mm256_madd_epi16(c, coeffG), rounding);
+        __m256i b = _mm256_add_epi32(_mm256_madd_epi16(c, coeffB), rounding);
+
+        __m256i r16 = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLow, _mm256_shuffle_epi32(r, _MM_SHUFFLE(1, 1, 0, 0))), 8),
+                                         _mm256_srai_epi32(_mm256_add_epi32(yHigh, _mm256_shuffle_epi32(r, _MM_SHUFFLE(3, 3, 2, 2))), 8));
+        __m256i g16 = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLow, _mm256_shuffle_epi32(g, _MM_SHUFFLE(1, 1, 0, 0))), 8),
+                                         _mm256_srai_epi32(_mm256_add_epi32(yHigh, _mm256_shuffle_epi32(g, _MM_SHUFFLE(3, 3, 2, 2))), 8));
+        __m256i b16 = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLow, _mm256_shuffle_epi32(b, _MM_SHUFFLE(1, 1, 0, 0))), 8),
+                                         _mm256_srai_epi32(_mm256_add_epi32(yHigh, _mm256_shuffle_epi32(b, _MM_SHUFFLE(3, 3, 2, 2))), 8));
+
+        storePixelsAvx2(_mm256_packus_epi16(b16, b16), _mm256_packus_epi16(g16, g16), _mm256_packus_epi16(r16, r16), dst);
+    }
+    convertLineSse2(src, dst, width - column);
+}
+
+COLORCONVERSION_TARGET_AVX2
+static void convertGrayAvx2(const uint8_t *src, QRgb *dst, int width){
+    const __m256i lowByte = _mm256_set1_epi16(0x00FF);
+    int column = 0;
+    for(; column + 16 <= width; column += 16, src += 32, dst += 16){
+        __m256i y16 = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)src), lowByte);
+        __m256i y = _mm256_packus_epi16(y16, y16);
+        storePixelsAvx2(y, y, y, dst);
+    }
+    convertGraySse2(src, dst, width - column);
+}
+
+static bool cpuHasAvx2(){
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return true;    /*MSVC only gets here when built with /arch:AVX2*/
+#endif
+}
+
+#endif
+
+
+/*------------------*/
+/*Runtime dispatching*/
+/*------------------*/
+
+struct ColorConverters{
+    ColorLineConverter rgb;
+    ColorLineConverter gray;
+    const char *name;
+    ColorConverters();
+};
+
+ColorConverters::ColorConverters() : rgb(convertLineGeneric), gray(convertGrayGeneric), name("generic"){
+#ifdef COLORCONVERSION_SSE2
+    rgb = convertLineSse2;
+    gray = convertGraySse2;
+    name = "SSE2";
+#endif
+#ifdef COLORCONVERSION_AVX2
+    if(cpuHasAvx2()){
+        rgb = convertLineAvx2;
+        gray = convertGrayAvx2;
+        name = "AVX2";
+    }
+#endif
+}
+
+static const ColorConverters &converters(){
+    static const ColorConverters instance;
+    return instance;
+}
+
+
+void convertLineYCbCr422(const uint8_t *src, QRgb *dst, int width){
+    converters().rgb(src, dst, width);
+}
+
+void convertLineGrayscale(const uint8_t *src, QRgb *dst, int width){
+    converters().gray(src, dst, width);
+}
+
+void convertImageYCbCr422(const uint8_t *src, QImage &dst, ColorMode mode){
+    Q_ASSERT(dst.format() == QImage::Format_RGB32 || dst.format() == QImage::Format_ARGB32);
+    ColorLineConverter convert = (mode == ColorModeGrayscale) ? converters().gray : converters().rgb;
+    int width = dst.width();
+    for(int line = 0; line < dst.height(); line++){
+        convert(src + 2 * width * line, (QRgb*)dst.scanLine(line), width);
+    }
+}
+
+const char *colorConversionBackend(){
+    return converters().name;
+}
+
+ColorLineConverter colorLineConverter(const char *backend, ColorMode mode){
+    bool gray = mode == ColorModeGrayscale;
+    if(!qstrcmp(backend, "generic"))
+        return gray ? convertGrayGeneric : convertLineGeneric;
+#ifdef COLORCONVERSION_SSE2
+    if(!qstrcmp(backend, "SSE2"))
+        return gray ? convertGraySse2 : convertLineSse2;
+#endif
+#ifdef COLORCONVERSION_AVX2
+    if(!qstrcmp(backend, "AVX2") && cpuHasAvx2())
+        return gray ? convertGrayAvx2 : convertLineAvx2;
+#endif
+    return 0;
+}
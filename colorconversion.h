@@ -0,0 +1,30 @@
+#ifndef COLORCONVERSION_H
+#define COLORCONVERSION_H
+
+#include <QImage>
+#include <QRgb>
+
+#include "stdint.h"
+
+/*Camera delivers YCbCr 4:2:2 as Y0 Cb Y1 Cr, two pixels per four bytes*/
+enum ColorMode{
+    ColorModeRgb,           /*BT.601 studio range to RGB*/
+    ColorModeGrayscale      /*Luma only, chroma bytes are skipped*/
+};
+
+/*Converting a single line, width has to be even*/
+void convertLineYCbCr422(const uint8_t *src, QRgb *dst, int width);
+void convertLineGrayscale(const uint8_t *src, QRgb *dst, int width);
+
+/*Converting a whole frame of dst.width() x dst.height() pixels straight into the scanlines of a Format_RGB32 image*/
+void convertImageYCbCr422(const uint8_t *src, QImage &dst, ColorMode mode);
+
+/*Name of the implementation picked at runtime ("AVX2", "SSE2" or "generic")*/
+const char *colorConversionBackend();
+
+/*A line converter of one implementation, for checks and benchmarks.
+ * 0 if the implementation is not compiled in or the CPU lacks it.*/
+typedef void (*ColorLineConverter)(const uint8_t *src, QRgb *dst, int width);
+ColorLineConverter colorLineConverter(const char *backend, ColorMode mode);
+
+#endif // COLORCONVERSION_H
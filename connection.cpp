@@ -1,77 +1,189 @@
 #include "connection.h"
 
+#include <string.h>
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#include <time.h>
+#endif
+
 Connection::Connection(QObject *parent, bool checkChecksum)
-    : QObject(parent), localAddress(LOCAL_IP), remoteAddress(SATELLITE_IP), port(PORT), udpSocket(this), bound(false), checkChecksum(checkChecksum), consoleText(""){
+    : QObject(parent), localAddress(LOCAL_IP), remoteAddress(SATELLITE_IP), port(PORT), udpSocket(this), bound(false), checkChecksum(checkChecksum), kernelTimestamps(false), topicMask(0), filteredPackets(0){
+    releaseTimer.setSingleShot(true);
+    releaseTimer.setTimerType(Qt::PreciseTimer);
+    connect(&releaseTimer, SIGNAL(timeout()), this, SLOT(releasePayloads()));
+}
+
+
+Connection::Subscription::Subscription() : packets(0), bytes(0), checksumErrors(0){
+}
+
+
+JitterBuffer::JitterBuffer() : latency(0), lastTimestamp(0), started(false){
+}
+
+
+/*The predefined addresses unless a simulator on this machine stands in for the satellite*/
+void Connection::setAddresses(const QHostAddress &local, const QHostAddress &remote){
+    localAddress = local;
+    remoteAddress = remote;
+}
+
+
+void Connection::setChecksumCheck(bool enabled){
+    checkChecksum = enabled;
 }
 
 
 /*Binding to predefined IP and port*/
 void Connection::bind(){
-    console(QString("Binding ground station to IP %1 at port %2.").arg(LOCAL_IP).arg(PORT));
+    console(LogInfo, MsgBinding, localAddress.toString(), port);
     if(udpSocket.bind(localAddress, port)){
-        console("Binding successful.");
+        console(LogInfo, MsgBindingSuccessful);
         bound = true;
+#ifdef Q_OS_LINUX
+        /*Let the kernel stamp datagrams on arrival, SIOCGSTAMPNS reads the stamp of the last one*/
+        int enable = 1;
+        kernelTimestamps = setsockopt(udpSocket.socketDescriptor(), SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0;
+#endif
     }
     else{
-        console("ERROR: Binding not possible.");
+        console(LogError, MsgBindingFailed);
         return;
     }
     connect(&udpSocket, SIGNAL(readyRead()), this, SLOT(connectionReceive()));
 }
 
 
-/*Receiving published RODOS topics = payloads*/
+/*Receiving published RODOS topics = payloads, every pending datagram at once*/
 void Connection::connectionReceive(){
+    QByteArray buffer(RODOS_FRAME_SIZE, 0x00);
+    qint64 receiveTime;
+    qint64 size;
+    while((size = receiveDatagram(buffer, receiveTime)) >= 0){
+        processDatagram(buffer, size, receiveTime);
+    }
+    releasePayloads();
+}
+
+
+/*Everything after the socket for one datagram of size bytes at the start of buffer, which holds RODOS_FRAME_SIZE bytes.
+ * Unsubscribed topics are dropped right after reading the header, before checksum and copy.
+ * Delivered or jitter buffered payloads are queued, buffered ones come out with releasePayloads().*/
+void Connection::processDatagram(QByteArray &buffer, qint64 size, qint64 receiveTime){
+    const uchar *header = (const uchar*) buffer.constData();
+    int index = rodosTopicFilter(header, size, topicMask);
+    if(index < 0){
+        filteredPackets.fetchAndAddRelaxed(1);
+        return;
+    }
+    quint16 userDataLen = qFromBigEndian<quint16>(header + 24);
+    Subscription &subscription = subscriptions[index];
+    subscription.packets.fetchAndAddRelaxed(1);
+    subscription.bytes.fetchAndAddRelaxed((quint32) size);
+
+    /*Short datagrams must not show bytes of the previous one*/
+    if(size < buffer.size())
+        memset(buffer.data() + size, 0, buffer.size() - size);
 
-    QByteArray buffer(1023, 0x00);
-    udpSocket.readDatagram(buffer.data(), buffer.size());
+    /*Calculate and check checksum*/
+    if(checkChecksum && rodosChecksum(header, RODOS_HEADER_SIZE + userDataLen) != qFromBigEndian<quint16>(header)){
+        subscription.checksumErrors.fetchAndAddRelaxed(1);
+        return;
+    }
 
     PayloadSatellite payload(buffer);
+    clockSync.addSample(payload.timestamp, receiveTime);
+    payload.receiveTime = receiveTime;
+    payload.sampleTime = clockSync.toGround(payload.timestamp);
+    linkStatistics.packetReceived(payload);
+    if(jitterBuffers.contains(payload.topic))
+        bufferPayload(jitterBuffers[payload.topic], payload);
+    else
+        deliverPayload(payload);
+}
 
-    /*Calculate checksum*/
-    quint16 checksum = 0;
-    for(int i = 2; i < 26 + payload.userDataLen; ++i){
-        bool lowestBit = checksum & 1;
-        checksum >>= 1;
-        if(lowestBit)
-            checksum |= 0x8000;
 
-        checksum += buffer[i];
+void Connection::deliverPayload(const PayloadSatellite &payload){
+    payloads.enqueue(payload);
+    emit readReady();
+}
+
+
+/*Packets older than the last released one of their topic come too late to keep the order*/
+void Connection::bufferPayload(JitterBuffer &buffer, const PayloadSatellite &payload){
+    if(buffer.started && payload.timestamp <= buffer.lastTimestamp){
+        if(buffer.lastTimestamp - payload.timestamp < (quint64) LINK_RESYNC_TIME){
+            linkStatistics.lateDrop(payload.topic);
+            return;
+        }
+        buffer.started = false;     /*satellite restarted*/
     }
 
-    /*Check checksum*/
-    if((!checkChecksum || checksum == payload.checksum) && topics.contains(payload.topic)){
-        payloads.enqueue(payload);
-        emit readReady();
+    /*Mostly in order, so the place is searched from the back*/
+    int i = buffer.packets.size();
+    while(i > 0 && buffer.packets.at(i - 1).timestamp > payload.timestamp)
+        i--;
+    if(i > 0 && buffer.packets.at(i - 1).timestamp == payload.timestamp)
+        return;
+    buffer.packets.insert(i, payload);
+}
+
+
+/*Release every packet whose corrected on-board time is older than the latency bound.
+ * The deadlines grow with the timestamps, so each topic comes out in order.*/
+void Connection::releasePayloads(){
+    qint64 now = groundTime();
+    qint64 nextDeadline = 0;
+    bool waiting = false;
+    QHash<quint32, JitterBuffer>::iterator it;
+    for(it = jitterBuffers.begin(); it != jitterBuffers.end(); ++it){
+        JitterBuffer &buffer = it.value();
+        while(!buffer.packets.isEmpty() && buffer.packets.first().sampleTime + buffer.latency <= now){
+            buffer.lastTimestamp = buffer.packets.first().timestamp;
+            buffer.started = true;
+            deliverPayload(buffer.packets.takeFirst());
+        }
+        if(!buffer.packets.isEmpty()){
+            qint64 deadline = buffer.packets.first().sampleTime + buffer.latency;
+            if(!waiting || deadline < nextDeadline)
+                nextDeadline = deadline;
+            waiting = true;
+        }
+    }
+    if(waiting)
+        releaseTimer.start((int)((nextDeadline - now + 999999) / 1000000));
+}
+
+
+/*Read one datagram and the ground clock time it arrived at, -1 if none is pending.
+ * Datagrams are always read through QUdpSocket, its read notifier is only enabled again by readDatagram().
+ * With kernel timestamps the arrival time of the datagram just read is asked for and
+ * the time spent in the socket queue is taken off.*/
+qint64 Connection::receiveDatagram(QByteArray &buffer, qint64 &receiveTime){
+    if(!udpSocket.hasPendingDatagrams())
+        return -1;
+    receiveTime = groundTime();
+    qint64 size = udpSocket.readDatagram(buffer.data(), buffer.size());
+#ifdef Q_OS_LINUX
+    struct timespec stamp, now;
+    if(size >= 0 && kernelTimestamps && ioctl(udpSocket.socketDescriptor(), SIOCGSTAMPNS, &stamp) == 0){
+        clock_gettime(CLOCK_REALTIME, &now);
+        qint64 queued = (qint64)(now.tv_sec - stamp.tv_sec) * 1000000000 + (now.tv_nsec - stamp.tv_nsec);
+        if(queued > 0)
+            receiveTime -= queued;
     }
+#endif
+    return size;
 }
 
 
 /*Send QByteArray with RODOS header*/
 void Connection::connectionSendData(quint32 topicId, const QByteArray &data){
-    QByteArray buffer(1023, 0x00);
-
-    *((quint32*)(buffer.data() + 2)) = qToBigEndian((quint32)1);
-    *((quint64*)(buffer.data() + 6)) = qToBigEndian((quint64)QDateTime::currentDateTime().toMSecsSinceEpoch() * 1000000);
-    *((quint32*)(buffer.data() + 14)) = qToBigEndian((quint32)1);
-    *((quint32*)(buffer.data() + 18)) = qToBigEndian((quint32)topicId);
-    *((quint16*)(buffer.data() + 22)) = qToBigEndian((quint16)10);
-    *((quint16*)(buffer.data() + 24)) = qToBigEndian((quint16)data.length());    
-    memcpy(buffer.data() + 26, data.constData(), data.length());
-    *(buffer.data() + 26 + data.length()) = 0x00;
-
-    /*Calculate checksum*/
-    quint32 checksum = 0;
-    for(int i = 2; i < 26 + data.length(); ++i){
-        if (checksum & 01)
-            checksum = checksum >> 1 | 0x8000;
-        else
-            checksum >>= 1;
-        checksum += (quint8)buffer[i];
-        checksum &= 0xFFFF;
-    }
-    /*Put checksum in the right place*/
-    *((quint16*)(buffer.data() + 0)) = qToBigEndian((quint16)checksum);
+    QByteArray buffer(RODOS_FRAME_SIZE, 0x00);
+    writeRodosFrame((uchar*) buffer.data(), topicId, (quint64)QDateTime::currentDateTime().toMSecsSinceEpoch() * 1000000, (const uchar*) data.constData(), data.length());
 
     udpSocket.writeDatagram(buffer.constData(), buffer.size(), remoteAddress, port);
 
@@ -101,8 +213,56 @@ void Connection::connectionSendCommand(quint32 topicID, const Command &telecomma
 }
 
 
-void Connection::addTopic(PayloadType topicId){
-    topics.insert(topicId);
+void Connection::addTopic(quint32 topicId){
+    int index = topicIndex(topicId);
+    if(index < 0)
+        return;
+    topicMask |= (quint64) 1 << index;
+    linkStatistics.addTopic(topicId);
+}
+
+
+/*Position in the subscription table, -1 outside of it*/
+int Connection::topicIndex(quint32 topicId) const{
+    quint32 index = topicId - TOPIC_TABLE_BASE;
+    return index < TOPIC_TABLE_SIZE ? (int) index : -1;
+}
+
+
+SubscriptionCounters Connection::subscriptionCounters(PayloadType topicId) const{
+    SubscriptionCounters counters = {0, 0, 0};
+    int index = topicIndex(topicId);
+    if(index >= 0){
+        counters.packets = subscriptions[index].packets.load();
+        counters.bytes = subscriptions[index].bytes.load();
+        counters.checksumErrors = subscriptions[index].checksumErrors.load();
+    }
+    return counters;
+}
+
+
+quint32 Connection::filteredCount() const{
+    return filteredPackets.load();
+}
+
+
+void Connection::setJitterBuffer(PayloadType topicId, int latency){
+    if(latency <= 0){
+        if(jitterBuffers.contains(topicId)){
+            foreach(const PayloadSatellite &payload, jitterBuffers.value(topicId).packets){
+                deliverPayload(payload);
+            }
+            jitterBuffers.remove(topicId);
+        }
+        return;
+    }
+    jitterBuffers[topicId].latency = (qint64) latency * 1000000;
+}
+
+
+/*Loss, reordering and jitter per topic, snapshots may be taken from any thread*/
+LinkStatistics *Connection::statistics(){
+    return &linkStatistics;
 }
 
 
@@ -119,11 +279,12 @@ bool Connection::isReadReady(){
 PayloadSatellite Connection::read(){
     if(!payloads.size())
         return PayloadSatellite();
-    return payloads.dequeue();
+    PayloadSatellite payload = payloads.dequeue();
+    payload.dequeueTime = groundTime();
+    return payload;
 }
 
 
-void Connection::console(QString msg){
-    consoleText = msg;
-    emit updateConsole();
+void Connection::console(LogLevel level, LogMessageId id, const LogArg &arg1, const LogArg &arg2){
+    Logger::post(level, LogConnection, id, arg1, arg2);
 }
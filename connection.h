@@ -3,18 +3,37 @@
 
 #include <QUdpSocket>
 #include <QQueue>
-#include <QSet>
+#include <QHash>
+#include <QTimer>
 #include <QNetworkInterface>
 #include <QDateTime>
 #include <QtEndian>
 
 #include "payload.h"
+#include "logger.h"
+#include "clocksync.h"
+#include "linkstatistics.h"
 
 #define PORT 37647
 #define LOCAL_IP "192.168.1.116"
 #define SATELLITE_IP "192.168.1.255"
 
-#define TELECOMMAND_TOPIC_ID 5555
+
+/*Traffic of one subscribed topic, counted before any decoding*/
+struct SubscriptionCounters{
+    quint32 packets;
+    quint32 bytes;
+    quint32 checksumErrors;
+};
+
+/*Holds the packets of one topic back for a bounded time and releases them by on-board timestamp*/
+struct JitterBuffer{
+    qint64 latency;                     /*ns after the corrected on-board time*/
+    QList<PayloadSatellite> packets;    /*sorted by timestamp*/
+    quint64 lastTimestamp;              /*of the last released packet*/
+    bool started;
+    JitterBuffer();
+};
 
 
 class Connection : public QObject
@@ -27,30 +46,53 @@ class Connection : public QObject
     QUdpSocket udpSocket;
     bool bound;
     bool checkChecksum;
-    QSet<quint32> topics;
+    bool kernelTimestamps;
+    ClockSync clockSync;
+    LinkStatistics linkStatistics;
+    quint64 topicMask;
+    struct Subscription{
+        QAtomicInteger<quint32> packets;
+        QAtomicInteger<quint32> bytes;
+        QAtomicInteger<quint32> checksumErrors;
+        Subscription();
+    } subscriptions[TOPIC_TABLE_SIZE];
+    QAtomicInteger<quint32> filteredPackets;
     QQueue<PayloadSatellite> payloads;
+    QHash<quint32, JitterBuffer> jitterBuffers;
+    QTimer releaseTimer;
 
 signals:
     void readReady();
-    void updateConsole();
 
 private slots:
     void connectionReceive();
 
-public:
-    QString consoleText;
+public slots:
+    void releasePayloads();
 
+public:
     explicit Connection(QObject *parent = 0, bool checkChecksum = false);
-    void addTopic(PayloadType);
+    void setAddresses(const QHostAddress &local, const QHostAddress &remote);
+    void setChecksumCheck(bool enabled);
+    void addTopic(quint32 topicId);
+    void setJitterBuffer(PayloadType topicId, int latency);    /*ms, 0 delivers packets as they arrive*/
+    void processDatagram(QByteArray &buffer, qint64 size, qint64 receiveTime);     /*the receive path without the socket*/
     void connectionSendData(quint32 topicId, const QByteArray &data);
     void connectionSendCommand(quint32 topicID, const Command &telecommand);
     PayloadSatellite read();
+    LinkStatistics *statistics();
+    SubscriptionCounters subscriptionCounters(PayloadType topicId) const;
+    quint32 filteredCount() const;          /*unsubscribed or malformed datagrams*/
     bool isBound();
     bool isReadReady();    
     void bind();
 
 private:
-    void console(QString msg);
+    qint64 receiveDatagram(QByteArray &buffer, qint64 &receiveTime);
+    int topicIndex(quint32 topicId) const;
+    void bufferPayload(JitterBuffer &buffer, const PayloadSatellite &payload);
+    void deliverPayload(const PayloadSatellite &payload);
+    void console(LogLevel level, LogMessageId id, const LogArg &arg1 = LogArg(), const LogArg &arg2 = LogArg());
 };
 
 #endif // CONNECTION_H
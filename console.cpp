@@ -3,8 +3,9 @@
 Console::Console(QWidget *parent)
     : QPlainTextEdit(parent)
 {
-    /*Set maximum number of displayed lines*/
-    document()->setMaximumBlockCount(100000);
+    /*Set maximum number of displayed lines, QPlainTextEdit only lays out the visible ones*/
+    document()->setMaximumBlockCount(CONSOLE_MAX_LINES);
+    shownLast.repeat = 0;
 
     /*Set matrix-like colors :) */
     QPalette p = palette();
@@ -14,9 +15,40 @@ Console::Console(QWidget *parent)
 }
 
 
-/*Give out string on console*/
-void Console::writeString(QString input){
-    insertPlainText(QString("%1\n").arg(input));
+/*Give out a batch of records on console in one go*/
+void Console::writeRecords(const QVector<LogRecord> &records){
+    QList<Line> lines;
+    bool shownLastChanged = false;
+
+    foreach(const LogRecord &record, records){
+        QString text = displayText(record);
+        Line &last = lines.isEmpty() ? shownLast : lines.last();
+        if(last.repeat && last.text == text){
+            last.repeat++;
+            shownLastChanged |= lines.isEmpty();
+            continue;
+        }
+        Line line;
+        line.text = text;
+        line.repeat = 1;
+        lines.append(line);
+    }
+
+    /*Update repeat count of the last shown line*/
+    if(shownLastChanged){
+        QTextCursor cursor(document()->lastBlock());
+        cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        cursor.insertText(format(shownLast));
+    }
+
+    if(!lines.isEmpty()){
+        QStringList texts;
+        foreach(const Line &line, lines){
+            texts.append(format(line));
+        }
+        appendPlainText(texts.join("\n"));
+        shownLast = lines.last();
+    }
 
     /*Ensure that scrollbar scrolls with published data*/
     QScrollBar *bar = verticalScrollBar();
@@ -24,6 +56,25 @@ void Console::writeString(QString input){
 }
 
 
+QString Console::displayText(const LogRecord &record){
+    switch(record.level){
+    case LogError:
+        return QString("ERROR: %1").arg(Logger::format(record));
+    case LogWarning:
+        return QString("WARNING: %1").arg(Logger::format(record));
+    default:
+        return Logger::format(record);
+    }
+}
+
+
+QString Console::format(const Line &line){
+    if(line.repeat > 1)
+        return QString("%1 (x%2)").arg(line.text).arg(line.repeat);
+    return line.text;
+}
+
+
 /*Disable typing*/
 void Console::keyPressEvent(QKeyEvent *e){
     switch (e->key()) {
@@ -3,14 +3,32 @@
 
 #include <QPlainTextEdit>
 #include <QScrollBar>
+#include <QVector>
 
-class Console : public QPlainTextEdit
+#include "logger.h"
+
+#define CONSOLE_MAX_LINES 10000     /*lines kept in the document*/
+
+/*Log sink showing records of all subsystems. Records arrive in batches from the Logger,
+ * every batch is appended at once and consecutive duplicates are coalesced into one line with a repeat count.*/
+class Console : public QPlainTextEdit, public LogSink
 {
     Q_OBJECT
 
 public:
     explicit Console(QWidget *parent = 0);
-    void writeString(QString input);
+    void writeRecords(const QVector<LogRecord> &records);
+
+private:
+    struct Line{
+        QString text;
+        int repeat;
+    };
+
+    Line shownLast;         /*last line of the document*/
+
+    static QString displayText(const LogRecord &record);
+    static QString format(const Line &line);
 
 protected:
     virtual void keyPressEvent(QKeyEvent *e);
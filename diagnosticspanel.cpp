@@ -0,0 +1,141 @@
+#include "diagnosticspanel.h"
+#include "logger.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QFileDialog>
+#include <QDateTime>
+
+static const double percentiles[] = {50, 90, 99, 99.9};
+#define PERCENTILE_COUNT 4
+
+DiagnosticsPanel::DiagnosticsPanel(LatencyMonitor *latency, LinkStatistics *link, QWidget *parent) :
+    QWidget(parent), latency(latency), link(link){
+    QStringList columns;
+    columns << "Count" << "Min" << "Mean";
+    for(int i = 0; i < PERCENTILE_COUNT; i++){
+        columns << QString("%1%").arg(percentiles[i]);
+    }
+    columns << "Max";
+    QStringList rows;
+    for(int i = 0; i < LatencyStageCount; i++){
+        rows << LatencyMonitor::stageName((LatencyStage) i);
+    }
+    latencyTable = createTable(rows, columns);
+
+    columns.clear();
+    columns << "Received" << "Lost" << "Loss rate" << "Reordered" << "Duplicates" << "Late drops" << "Jitter (ms)" << "Period (ms)";
+    rows.clear();
+    foreach(const TopicStatistics &topic, link->snapshot()){
+        rows << QString("%1 (%2)").arg(payloadTypeName(topic.topic)).arg(topic.topic);
+    }
+    linkTable = createTable(rows, columns);
+
+    resetButton = new QPushButton("Reset", this);
+    exportButton = new QPushButton("Export...", this);
+    QHBoxLayout *buttons = new QHBoxLayout();
+    buttons->addStretch();
+    buttons->addWidget(resetButton);
+    buttons->addWidget(exportButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(new QLabel("Telemetry latency (ms)", this));
+    layout->addWidget(latencyTable);
+    layout->addWidget(new QLabel("Link quality", this));
+    layout->addWidget(linkTable);
+    layout->addLayout(buttons);
+    layout->addStretch();
+
+    connect(resetButton, SIGNAL(clicked()), this, SLOT(onResetButtonClicked()));
+    connect(exportButton, SIGNAL(clicked()), this, SLOT(onExportButtonClicked()));
+    refreshTimer.setInterval(DIAGNOSTICS_REFRESH_INTERVAL);
+    connect(&refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+}
+
+
+QTableWidget *DiagnosticsPanel::createTable(const QStringList &rows, const QStringList &columns){
+    QTableWidget *table = new QTableWidget(rows.size(), columns.size(), this);
+    table->setHorizontalHeaderLabels(columns);
+    table->setVerticalHeaderLabels(rows);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    for(int row = 0; row < table->rowCount(); row++){
+        for(int column = 0; column < table->columnCount(); column++){
+            QTableWidgetItem *item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            table->setItem(row, column, item);
+        }
+    }
+    return table;
+}
+
+
+void DiagnosticsPanel::refresh(){
+    refreshLatency();
+    refreshLink();
+}
+
+
+void DiagnosticsPanel::refreshLatency(){
+    for(int row = 0; row < LatencyStageCount; row++){
+        const LatencyHistogram &histogram = latency->histogram((LatencyStage) row);
+        int column = 0;
+        latencyTable->item(row, column++)->setText(QString::number(histogram.count()));
+        latencyTable->item(row, column++)->setText(QString::number(histogram.min() / 1000.0, 'f', 3));
+        latencyTable->item(row, column++)->setText(QString::number(histogram.mean() / 1000.0, 'f', 3));
+        for(int i = 0; i < PERCENTILE_COUNT; i++){
+            latencyTable->item(row, column++)->setText(QString::number(histogram.percentile(percentiles[i]) / 1000.0, 'f', 3));
+        }
+        latencyTable->item(row, column++)->setText(QString::number(histogram.max() / 1000.0, 'f', 3));
+    }
+}
+
+
+void DiagnosticsPanel::refreshLink(){
+    QVector<TopicStatistics> topics = link->snapshot();
+    for(int row = 0; row < topics.size() && row < linkTable->rowCount(); row++){
+        const TopicStatistics &topic = topics.at(row);
+        int column = 0;
+        linkTable->item(row, column++)->setText(QString::number(topic.received));
+        linkTable->item(row, column++)->setText(QString::number(topic.lost));
+        linkTable->item(row, column++)->setText(QString("%1 %").arg(topic.lossRate * 100, 0, 'f', 2));
+        linkTable->item(row, column++)->setText(QString::number(topic.reordered));
+        linkTable->item(row, column++)->setText(QString::number(topic.duplicates));
+        linkTable->item(row, column++)->setText(QString::number(topic.lateDrops));
+        linkTable->item(row, column++)->setText(QString::number(topic.jitter, 'f', 3));
+        linkTable->item(row, column++)->setText(QString::number(topic.period, 'f', 1));
+    }
+}
+
+
+/*Nobody looks at a hidden table*/
+void DiagnosticsPanel::showEvent(QShowEvent *event){
+    QWidget::showEvent(event);
+    refresh();
+    refreshTimer.start();
+}
+
+void DiagnosticsPanel::hideEvent(QHideEvent *event){
+    QWidget::hideEvent(event);
+    refreshTimer.stop();
+}
+
+
+void DiagnosticsPanel::onResetButtonClicked(){
+    latency->reset();
+    link->reset();
+    refresh();
+}
+
+
+void DiagnosticsPanel::onExportButtonClicked(){
+    QString fileName = QFileDialog::getSaveFileName(this, "Export latency histograms",
+                                                    QDateTime::currentDateTime().toString("'latency-'yyyyMMdd-hhmmss'.hgrm'"),
+                                                    "Histograms (*.hgrm);;All files (*)");
+    if(fileName.isEmpty())
+        return;
+    if(!latency->exportTo(fileName))
+        Logger::post(LogError, LogGroundstation, MsgExportFailed, fileName);
+}
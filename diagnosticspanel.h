@@ -0,0 +1,47 @@
+#ifndef DIAGNOSTICSPANEL_H
+#define DIAGNOSTICSPANEL_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QTimer>
+
+#include "latencymonitor.h"
+#include "linkstatistics.h"
+
+#define DIAGNOSTICS_REFRESH_INTERVAL 1000   /*ms*/
+
+/*Diagnostics tab: latency percentiles of every stage and link quality of every topic, refreshed while visible*/
+class DiagnosticsPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsPanel(LatencyMonitor *latency, LinkStatistics *link, QWidget *parent = 0);
+
+public slots:
+    void refresh();
+
+protected:
+    void showEvent(QShowEvent *event) Q_DECL_OVERRIDE;
+    void hideEvent(QHideEvent *event) Q_DECL_OVERRIDE;
+
+private:
+    LatencyMonitor *latency;
+    LinkStatistics *link;
+    QTableWidget *latencyTable;
+    QTableWidget *linkTable;
+    QPushButton *resetButton;
+    QPushButton *exportButton;
+    QTimer refreshTimer;
+
+    QTableWidget *createTable(const QStringList &rows, const QStringList &columns);
+    void refreshLatency();
+    void refreshLink();
+
+private slots:
+    void onResetButtonClicked();
+    void onExportButtonClicked();
+};
+
+#endif // DIAGNOSTICSPANEL_H
@@ -0,0 +1,109 @@
+#include "exportdialog.h"
+#include "clocksync.h"
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QStandardPaths>
+
+static QDateTime groundDateTime(qint64 time){
+    return QDateTime::fromMSecsSinceEpoch(groundWallClock(time));
+}
+
+static qint64 groundTimeOf(const QDateTime &dateTime){
+    return (dateTime.toMSecsSinceEpoch() - groundWallClock(0)) * 1000000;
+}
+
+
+ExportDialog::ExportDialog(const TelemetryStore *store, const TelemetryDictionary *dictionary, QWidget *parent) : QDialog(parent){
+    setWindowTitle("Export telemetry");
+
+    /*Channels with data are offered, the range covers all of them*/
+    channelList = new QListWidget(this);
+    qint64 first = 0;
+    qint64 last = 0;
+    for(int id = 0; id < dictionary->channelCount(); id++){
+        if(!store->sampleCount(id))
+            continue;
+        QListWidgetItem *item = new QListWidgetItem(dictionary->channel(id).name, channelList);
+        item->setData(Qt::UserRole, id);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Checked);
+        first = channelList->count() == 1 ? store->firstTime(id) : qMin(first, store->firstTime(id));
+        last = qMax(last, store->lastTime(id));
+    }
+
+    fromEdit = new QDateTimeEdit(groundDateTime(first), this);
+    toEdit = new QDateTimeEdit(groundDateTime(last + 1000000), this);
+    fromEdit->setDisplayFormat("yyyy-MM-dd hh:mm:ss");
+    toEdit->setDisplayFormat("yyyy-MM-dd hh:mm:ss");
+
+    formatBox = new QComboBox(this);
+    formatBox->addItem("CSV", TelemetryExportCsv);
+    formatBox->addItem("Binary columns", TelemetryExportBinary);
+
+    fileEdit = new QLineEdit(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)
+                             + groundDateTime(first).toString("'/pass-'yyyyMMdd-hhmmss'.csv'"), this);
+    QPushButton *browseButton = new QPushButton("...", this);
+    QHBoxLayout *fileLayout = new QHBoxLayout;
+    fileLayout->addWidget(fileEdit);
+    fileLayout->addWidget(browseButton);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+
+    QFormLayout *layout = new QFormLayout(this);
+    layout->addRow("Channels", channelList);
+    layout->addRow("From", fromEdit);
+    layout->addRow("To", toEdit);
+    layout->addRow("Format", formatBox);
+    layout->addRow("File", fileLayout);
+    layout->addRow(buttons);
+
+    connect(browseButton, SIGNAL(clicked()), this, SLOT(onBrowseButtonClicked()));
+    connect(fileEdit, SIGNAL(textChanged(QString)), this, SLOT(onFileNameChanged(QString)));
+    connect(buttons, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+}
+
+
+QVector<int> ExportDialog::channels() const{
+    QVector<int> selected;
+    for(int i = 0; i < channelList->count(); i++){
+        if(channelList->item(i)->checkState() == Qt::Checked)
+            selected.append(channelList->item(i)->data(Qt::UserRole).toInt());
+    }
+    return selected;
+}
+
+qint64 ExportDialog::from() const{
+    return groundTimeOf(fromEdit->dateTime());
+}
+
+qint64 ExportDialog::to() const{
+    return groundTimeOf(toEdit->dateTime());
+}
+
+TelemetryExportFormat ExportDialog::format() const{
+    return (TelemetryExportFormat) formatBox->currentData().toInt();
+}
+
+QString ExportDialog::fileName() const{
+    return fileEdit->text();
+}
+
+
+void ExportDialog::onBrowseButtonClicked(){
+    QString name = QFileDialog::getSaveFileName(this, "Export telemetry", fileEdit->text(), "CSV (*.csv);;Binary columns (*.tlmx)");
+    if(!name.isEmpty())
+        fileEdit->setText(name);
+}
+
+
+/*The extension picks the format*/
+void ExportDialog::onFileNameChanged(const QString &text){
+    if(text.endsWith(".csv", Qt::CaseInsensitive))
+        formatBox->setCurrentIndex(formatBox->findData(TelemetryExportCsv));
+    else if(text.endsWith(".tlmx", Qt::CaseInsensitive))
+        formatBox->setCurrentIndex(formatBox->findData(TelemetryExportBinary));
+}
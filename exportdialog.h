@@ -0,0 +1,39 @@
+#ifndef EXPORTDIALOG_H
+#define EXPORTDIALOG_H
+
+#include <QDialog>
+#include <QListWidget>
+#include <QDateTimeEdit>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QPushButton>
+
+#include "telemetryexport.h"
+
+/*Selection of channels, time range, format and file for a telemetry export*/
+class ExportDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ExportDialog(const TelemetryStore *store, const TelemetryDictionary *dictionary, QWidget *parent = 0);
+
+    QVector<int> channels() const;
+    qint64 from() const;                    /*ns, ground clock*/
+    qint64 to() const;
+    TelemetryExportFormat format() const;
+    QString fileName() const;
+
+private:
+    QListWidget *channelList;
+    QDateTimeEdit *fromEdit;
+    QDateTimeEdit *toEdit;
+    QComboBox *formatBox;
+    QLineEdit *fileEdit;
+
+private slots:
+    void onBrowseButtonClicked();
+    void onFileNameChanged(const QString &text);
+};
+
+#endif // EXPORTDIALOG_H
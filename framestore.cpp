@@ -0,0 +1,157 @@
+#include "framestore.h"
+
+#include <string.h>
+
+FrameRecordInfo::FrameRecordInfo() : receiveTime(0), transferTime(0), linkBytes(0), compressed(0){
+    reserved[0] = reserved[1] = reserved[2] = 0;
+}
+
+
+FrameStore::FrameStore(int width, int height)
+    : map(0), frames(0), capacity(0), frameLimit(FRAMESTORE_MAX_FRAMES), frameBytes(width * height * 2), recordSize(sizeof(FrameRecordInfo) + width * height * 2), width(width), height(height){
+}
+
+FrameStore::~FrameStore(){
+    close();
+}
+
+
+/*Open an existing store or create a new one, a partly written last record is ignored*/
+bool FrameStore::open(const QString &fileName){
+    close();
+    file.setFileName(fileName);
+    if(!file.open(QIODevice::ReadWrite))
+        return false;
+
+    FrameStoreHeader header;
+    memset(&header, 0, sizeof(header));
+    if(file.size() == 0){
+        header.magic = FRAMESTORE_MAGIC;
+        header.version = FRAMESTORE_VERSION;
+        header.width = width;
+        header.height = height;
+        header.recordSize = recordSize;
+        header.frames = 0;
+        if(file.write((const char*)&header, sizeof(header)) != sizeof(header)){
+            file.close();
+            return false;
+        }
+        file.flush();
+    }
+    else{
+        if(file.read((char*)&header, sizeof(header)) != sizeof(header)
+                || header.magic != FRAMESTORE_MAGIC || header.version != FRAMESTORE_VERSION
+                || (int)header.width != width || (int)header.height != height || (int)header.recordSize != recordSize){
+            file.close();
+            return false;
+        }
+    }
+
+    capacity = (file.size() - sizeof(FrameStoreHeader)) / recordSize;
+    frames = qMin((int)header.frames, capacity);
+    if(!remap()){
+        close();
+        return false;
+    }
+    ((FrameStoreHeader*)map)->frames = frames;
+    return true;
+}
+
+
+/*Room reserved for further records is given back*/
+void FrameStore::close(){
+    if(map)
+        file.unmap(map);
+    map = 0;
+    if(file.isOpen()){
+        file.resize(recordOffset(frames));
+        file.close();
+    }
+    frames = 0;
+    capacity = 0;
+}
+
+
+bool FrameStore::isOpen() const{
+    return file.isOpen();
+}
+
+
+QString FrameStore::fileName() const{
+    return file.fileName();
+}
+
+
+bool FrameStore::append(const QByteArray &rawImage, const FrameRecordInfo &info){
+    if(!map || rawImage.size() != frameBytes || isFull())
+        return false;
+
+    if(frames == capacity){
+        int grown = qMin(capacity + FRAMESTORE_GROW_FRAMES, frameLimit);
+        file.unmap(map);
+        map = 0;
+        if(!file.resize(recordOffset(grown))){
+            remap();
+            return false;
+        }
+        capacity = grown;
+        if(!remap())
+            return false;
+    }
+
+    /*A record only counts once it is complete, a crash in between leaves the last one out*/
+    uchar *record = map + recordOffset(frames);
+    memcpy(record, &info, sizeof(FrameRecordInfo));
+    memcpy(record + sizeof(FrameRecordInfo), rawImage.constData(), frameBytes);
+    frames++;
+    ((FrameStoreHeader*)map)->frames = frames;
+    return true;
+}
+
+
+void FrameStore::setMaxFrames(int maxFrames){
+    frameLimit = maxFrames;
+}
+
+
+int FrameStore::maxFrames() const{
+    return frameLimit;
+}
+
+
+bool FrameStore::isFull() const{
+    return frames >= frameLimit;
+}
+
+
+int FrameStore::count() const{
+    return frames;
+}
+
+
+const FrameRecordInfo *FrameStore::info(int index) const{
+    if(!map || index < 0 || index >= frames)
+        return 0;
+    return (const FrameRecordInfo*)(map + recordOffset(index));
+}
+
+
+const uchar *FrameStore::frame(int index) const{
+    if(!map || index < 0 || index >= frames)
+        return 0;
+    return map + recordOffset(index) + sizeof(FrameRecordInfo);
+}
+
+
+/*Map the header and every record the file has room for*/
+bool FrameStore::remap(){
+    if(map)
+        file.unmap(map);
+    map = file.map(0, recordOffset(capacity));
+    return map != 0;
+}
+
+
+qint64 FrameStore::recordOffset(int index) const{
+    return sizeof(FrameStoreHeader) + (qint64)index * recordSize;
+}
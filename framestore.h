@@ -0,0 +1,76 @@
+#ifndef FRAMESTORE_H
+#define FRAMESTORE_H
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QMetaType>
+
+#define FRAMESTORE_MAGIC 0x534D5246      /*"FRMS"*/
+#define FRAMESTORE_VERSION 2
+#define FRAMESTORE_GROW_FRAMES 64       /*records the file and its mapping grow by*/
+#define FRAMESTORE_MAX_FRAMES 16384     /*about 630 MB of 160x121 frames*/
+
+/*File layout: FrameStoreHeader followed by records of recordSize bytes, every record is a
+ * FrameRecordInfo followed by the raw YCbCr 4:2:2 frame (width*height*2 bytes).
+ * Records are only ever appended, so the file can be mapped and browsed without any decoding.
+ * The file grows in steps of FRAMESTORE_GROW_FRAMES records, frames counts the complete ones.*/
+struct FrameStoreHeader{
+    quint32 magic;
+    quint32 version;
+    quint32 width;
+    quint32 height;
+    quint32 recordSize;
+    quint32 frames;
+    quint32 reserved[10];
+};
+
+struct FrameRecordInfo{
+    qint64 receiveTime;         /*ms since epoch*/
+    quint32 transferTime;       /*ms between first and last byte of the message*/
+    quint32 linkBytes;          /*bytes received over the link, flags included*/
+    quint32 compressed;         /*1 for the compressed downlink mode*/
+    quint32 reserved[3];
+    FrameRecordInfo();
+};
+
+Q_DECLARE_METATYPE(FrameRecordInfo)
+
+class FrameStore
+{
+public:
+    FrameStore(int width, int height);
+    ~FrameStore();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+    QString fileName() const;
+
+    /*Records are copied into the mapping, the file is only resized every FRAMESTORE_GROW_FRAMES records*/
+    bool append(const QByteArray &rawImage, const FrameRecordInfo &info);
+    void setMaxFrames(int maxFrames);
+    int maxFrames() const;
+    bool isFull() const;
+
+    /*Pointers into the mapped file, valid until the next append() or close()*/
+    int count() const;
+    const FrameRecordInfo *info(int index) const;
+    const uchar *frame(int index) const;
+
+private:
+    QFile file;
+    uchar *map;
+    int frames;
+    int capacity;               /*records the file has room for*/
+    int frameLimit;
+    int frameBytes;
+    int recordSize;
+    int width;
+    int height;
+
+    bool remap();
+    qint64 recordOffset(int index) const;
+};
+
+#endif // FRAMESTORE_H
@@ -4,35 +4,16 @@
 #
 #-------------------------------------------------
 
-QT       += core \
-            gui \
-            widgets \
-            printsupport \
-            network \
-            serialport
+# The ground station, the tools that stand in for the satellite while testing it
+# and the benchmarks and checks
 
-TARGET = Groundstation_prel
-TEMPLATE = app
+TEMPLATE = subdirs
 
-SOURCES += main.cpp \
-    groundstation.cpp \
-    compass.cpp \
-    debrismap.cpp \
-    qcustomplot.cpp \
-    console.cpp \
-    connection.cpp \
-    payload.cpp \
-    qledindicator.cpp \
-    imagelink.cpp
+SUBDIRS += groundstation \
+    satellitesimulator \
+    benchmark \
+    checks
 
-HEADERS  += groundstation.h \
-    compass.h \
-    debrismap.h \
-    qcustomplot.h \
-    console.h \
-    connection.h \
-    payload.h \
-    qledindicator.h \
-    imagelink.h
+unix: SUBDIRS += camerasimulator
 
-FORMS    += groundstation.ui
+groundstation.file = groundstation.pro
@@ -2,35 +2,51 @@
 #include "ui_groundstation.h"
 
 
-Groundstation::Groundstation(QWidget *parent) :
-    QMainWindow(parent), link(this), imager(this),
-    ui(new Ui::Groundstation)
+Groundstation::Groundstation(const QCommandLineParser &options, QWidget *parent) :
+    QMainWindow(parent), logger(this), link(this), telemetryRouter(&dictionary), imager(0),
+    ui(new Ui::Groundstation), lastReceiveTime(0)
 {
     ui->setupUi(this);
 
     /*Maximize window*/
     setWindowState(windowState() | Qt::WindowMaximized);
 
-    /*Set up console updates from lower classes*/
-    connect(&link, SIGNAL(updateConsole()), this, SLOT(connectionUpdateConsole()));
-    connect(&imager, SIGNAL(updateConsole()), this, SLOT(imagelinkUpdateConsole()));
+    /*Log records of all subsystems are shown on the console and written to the session log*/
+    logger.addSink(ui->consoleWidget);
+    setupLogFile();
 
-    /*Set up Wifi*/
+    /*Set up Wifi, every topic of the telemetry dictionary is subscribed*/
+    setupDictionary();
+    link.setAddresses(QHostAddress(options.value("local")), QHostAddress(options.value("satellite")));
+    link.setChecksumCheck(options.isSet("checksum"));
     link.bind();
-    link.addTopic(PayloadSensorIMUType);
-    link.addTopic(PayloadCounterType);
-    link.addTopic(PayloadElectricalType);
-    link.addTopic(PayloadMissionType);
-    link.addTopic(PayloadLightType);
+    for(int i = 0; i < dictionary.topicCount(); i++){
+        link.addTopic(dictionary.topicAt(i).id);
+    }
+    link.addTopic(TELECOMMAND_ACK_TOPIC_ID);
+    link.setJitterBuffer(PayloadSensorIMUType, JITTER_BUFFER_LATENCY);
+    link.setJitterBuffer(PayloadLightType, JITTER_BUFFER_LATENCY);
     connect(&link, SIGNAL(readReady()), this, SLOT(readoutConnection()));
+    setupDispatcher();
 
     /*Set up bluetooth menu and LED*/
+    if(options.isSet("camera"))
+        imager.addPort(options.value("camera"));
     imager.initializePort();
     foreach (const QSerialPortInfo &info, QSerialPortInfo::availablePorts()){
         ui->bluetoothComboBox->addItem(info.portName());
     }
+    if(options.isSet("camera")){
+        ui->bluetoothComboBox->addItem(options.value("camera"));
+        ui->bluetoothComboBox->setCurrentText(options.value("camera"));
+    }
     connect(&imager, SIGNAL(updateStatus()), this, SLOT(updateBluetoothLED()));     /*Updating bluetooth LED*/
-    connect(&imager, SIGNAL(updateImage()), this, SLOT(updateImage()));             /*Updating image in groundstation*/
+    connect(&imager, SIGNAL(updateImage(QImage)), ui->missionInputLabel, SLOT(setImage(QImage)));                         /*Updating image in groundstation*/
+    connect(&imager, SIGNAL(updateImageLines(QImage,int,int)), ui->missionInputLabel, SLOT(updateImageLines(QImage,int,int))); /*Revealing the image line by line while it is downlinked*/
+
+    /*Serial reading and image decoding run in their own thread, telemetry plotting keeps the GUI thread*/
+    imager.moveToThread(&imagelinkThread);
+    imagelinkThread.start();
 
     /*Set up timer for telemetry activity check*/
     QTimer *timer = new QTimer(this);
@@ -81,10 +97,37 @@ Groundstation::Groundstation(QWidget *parent) :
 
     /*Set up graph widgets*/
     setupGraphs();
+    setupHistory();
+
+    /*Set up archive of all received images*/
+    setupImageArchive(options.value("image-frames").toInt());
+
+    /*Set up latency and link diagnostics*/
+    setupDiagnostics();
+
+    /*Menu*/
+    QMenu *fileMenu = ui->menuBar->addMenu("File");
+    fileMenu->addAction("Export telemetry...", this, SLOT(onExportTelemetryTriggered()));
+    QMenu *viewMenu = ui->menuBar->addMenu("View");
+    QAction *grayscaleAction = viewMenu->addAction("Grayscale camera images");
+    grayscaleAction->setCheckable(true);
+    connect(grayscaleAction, SIGNAL(toggled(bool)), this, SLOT(onGrayscaleToggled(bool)));
 }
 
 Groundstation::~Groundstation()
 {
+    QMetaObject::invokeMethod(&imager, "shutdown", Qt::BlockingQueuedConnection);
+    imagelinkThread.quit();
+    imagelinkThread.wait();
+
+    /*Last records reach the session log before it is closed*/
+    logger.drain();
+    logger.removeSink(ui->consoleWidget);
+    logger.removeSink(logFile);
+    logFile->stop();
+    delete telemetryQuery;
+    delete telemetryStore;
+    delete telemetryArchive;            /*writes the pending rows*/
     delete ui;
 }
 
@@ -95,16 +138,67 @@ Groundstation::~Groundstation()
 
 void Groundstation::readoutConnection(){
     if(!ui->telemetryLED->isChecked()){
-        console("Telemetry online.");
+        console(LogInfo, MsgTelemetryOnline);
     }
     ui->telemetryLED->setChecked(true);
     PayloadSatellite payload = link.read();
-    switch(payload.topic){
-    case PayloadSensorIMUType:{
-        PayloadSensorIMU psimu(payload);
-        key = QDateTime::currentDateTime().toMSecsSinceEpoch()/1000.0;
+    lastReceiveTime = payload.receiveTime;
+
+    /*Samples are plotted at their on-board time, corrected to the ground clock*/
+    key = groundSeconds(payload.sampleTime);
+    dispatcher.dispatch(payload);
+    latency.finished();
+}
+
+
+/*Handlers of the single topics, registered in setupDispatcher*/
+void Groundstation::setupDispatcher(){
+    dispatcher.registerHandler(PayloadSensorIMUType, this, &Groundstation::onSensorIMU);
+    dispatcher.registerHandler(PayloadCounterType, this, &Groundstation::onCounter);
+    dispatcher.registerHandler(PayloadElectricalType, this, &Groundstation::onElectrical);
+    dispatcher.registerHandler(PayloadLightType, this, &Groundstation::onLight);
+    dispatcher.registerHandler(PayloadMissionType, this, &Groundstation::onMission);
+    dispatcher.registerHandler(TELECOMMAND_ACK_TOPIC_ID, this, &Groundstation::onTelecommandAck);
+    for(int i = 0; i < dictionary.topicCount(); i++){
+        dispatcher.registerHandler(dictionary.topicAt(i).id, &telemetryRouter);
+    }
+}
+
+
+/*Topics of the mission's dictionary file extend or replace the compiled in ones*/
+void Groundstation::setupDictionary(){
+    QString fileName = QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/telemetry.json";
+    if(QFile::exists(fileName)){
+        QString error;
+        if(dictionary.load(fileName, &error)){
+            console(LogInfo, MsgDictionaryLoaded, fileName, dictionary.topicCount());
+        }else{
+            console(LogWarning, MsgDictionaryInvalid, error);
+        }
+    }
+    telemetryStore = new TelemetryStore(&dictionary);
+    telemetryRouter.addSink(telemetryStore);
+
+    /*Every session is archived to its own file next to the session logs*/
+    QDir directory(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/telemetry");
+    directory.mkpath(".");
+    QString archiveName = directory.filePath(QDateTime::currentDateTime().toString("'session-'yyyyMMdd-hhmmss'.tlm'"));
+    telemetryArchive = new TelemetryArchive(&dictionary);
+    if(telemetryArchive->open(archiveName))
+        telemetryRouter.addSink(telemetryArchive);
+    else
+        console(LogError, MsgTelemetryArchiveOpenFailed, archiveName);
+    telemetryPlots = new TelemetryPlots(&dictionary, this);
+    telemetryRouter.addSink(telemetryPlots);
+}
+
 
-        /*accelerometerWidget update*/
+void Groundstation::onSensorIMU(const PayloadSatellite &payload){
+    PayloadSensorIMU psimu(payload);
+    latency.decoded(payload);
+
+    /*accelerometerWidget update, paused while its history is browsed*/
+    if(!accelerometerHistory->isBrowsing()){
         ui->accelerometerWidget->graph(0)->addData(key, psimu.ax/1000);
         ui->accelerometerWidget->graph(0)->removeDataBefore(key-XAXIS_VISIBLE_TIME);
         ui->accelerometerWidget->graph(0)->rescaleValueAxis();
@@ -116,8 +210,10 @@ void Groundstation::readoutConnection(){
         ui->accelerometerWidget->graph(2)->rescaleValueAxis(true);
         ui->accelerometerWidget->xAxis->setRange(key+0.25, XAXIS_VISIBLE_TIME, Qt::AlignRight);
         ui->accelerometerWidget->replot();
+    }
 
-        /*gyroscopeWidget update*/
+    /*gyroscopeWidget update, paused while its history is browsed*/
+    if(!gyroscopeHistory->isBrowsing()){
         ui->gyroscopeWidget->graph(0)->addData(key, radToDeg(psimu.wx));
         ui->gyroscopeWidget->graph(0)->removeDataBefore(key-XAXIS_VISIBLE_TIME);
         ui->gyroscopeWidget->graph(0)->rescaleValueAxis();
@@ -129,8 +225,10 @@ void Groundstation::readoutConnection(){
         ui->gyroscopeWidget->graph(2)->rescaleValueAxis(true);
         ui->gyroscopeWidget->xAxis->setRange(key+0.25, XAXIS_VISIBLE_TIME, Qt::AlignRight);
         ui->gyroscopeWidget->replot();
+    }
 
-        /*headingWidget update*/
+    /*headingWidget update, paused while its history is browsed*/
+    if(!headingHistory->isBrowsing()){
         ui->headingWidget->graph(0)->addData(key, radToDeg(psimu.headingXm));
         ui->headingWidget->graph(0)->removeDataBefore(key-XAXIS_VISIBLE_TIME);
         ui->headingWidget->graph(0)->rescaleValueAxis();
@@ -142,74 +240,115 @@ void Groundstation::readoutConnection(){
         ui->headingWidget->graph(2)->rescaleValueAxis(true);
         ui->headingWidget->xAxis->setRange(key+0.25, XAXIS_VISIBLE_TIME, Qt::AlignRight);
         ui->headingWidget->replot();
-
-        /*LCD updates*/
-        ui->compassWidget->angle = radToDeg(psimu.headingFusion);
-        ui->debrisMapWidget->angle = radToDeg(psimu.headingFusion);
-        ui->rotationLCD->display(radToDeg(psimu.wz));
-        ui->orientationLCD->display(radToDeg(psimu.headingFusion));
-        ui->pitchLCD->display(radToDeg(psimu.pitch));
-        ui->rollLCD->display(radToDeg(psimu.roll));
-
-        /*LED updates*/
-        if(psimu.calibrationActive){
-            console("Calibration running...");
-        }
-
-        break;
-    }
-    case PayloadCounterType:{
-        PayloadCounter pscount(payload);
-        key = QDateTime::currentDateTime().toMSecsSinceEpoch()/1000.0;
-        break;
-    }
-    case PayloadElectricalType:{
-        PayloadElectrical pelec(payload);
-        key = QDateTime::currentDateTime().toMSecsSinceEpoch()/1000.0;
-
-        /*LED updates*/
-        ui->lightsensorLED->setChecked(pelec.lightsensorOn);
-        ui->electromagnetLED->setChecked(pelec.electromagnetOn);
-        ui->thermalKnifeLED->setChecked(pelec.thermalKnifeOn);
-        ui->racksDeployedLED->setChecked(pelec.racksOut);
-        ui->solarDeployedLED->setChecked(pelec.solarPanelsOut);
-
-        /*LCD updates*/
-        ui->solarVoltageLCD->display(pelec.solarPanelVoltage);
-        ui->solarCurrentLCD->display(pelec.solarPanelCurrent);
-        ui->batteryCurrentLCD->display(pelec.batteryCurrent);
-        ui->batteryVoltageLCD->display(pelec.batteryVoltage);
-        ui->powerConsumptionLCD->display(pelec.batteryVoltage * pelec.batteryCurrent / 1000);
-        break;
-    }
-    case PayloadLightType:{
-        PayloadLight plight(payload);
-        key = QDateTime::currentDateTime().toMSecsSinceEpoch()/1000.0;
-        ui->lightsensorLCD->display(plight.lightValue);
-
-        /*sunFinderWidget / lightsensor graph update*/
-        if(ui->lightsensorLED->isChecked()){
-            ui->sunFinderWidget->graph(0)->addData(key, plight.lightValue);
-        }else{
-            ui->sunFinderWidget->graph(0)->addData(key, 0);
-        }
-        ui->sunFinderWidget->graph(0)->removeDataBefore(key-XAXIS_VISIBLE_TIME);
-        ui->sunFinderWidget->graph(0)->rescaleValueAxis();
-        ui->sunFinderWidget->xAxis->setRange(key+0.25, XAXIS_VISIBLE_TIME, Qt::AlignRight);
-        ui->sunFinderWidget->replot();
     }
-    case PayloadMissionType:{
-        PayloadMission pmission(payload);
-        key = QDateTime::currentDateTime().toMSecsSinceEpoch()/1000.0;
-        Debris tc_debris = Debris(pmission.partNumber, pmission.angle, pmission.isCleaned);
-        ui->debrisMapWidget->processDebris(&tc_debris);
-        ui->debrisFoundLCD->display(ui->debrisMapWidget->getFoundNumber());
-        ui->debrisCleanedLCD->display(ui->debrisMapWidget->getCleanedNumber());
+
+    /*LCD updates*/
+    ui->compassWidget->angle = radToDeg(psimu.headingFusion);
+    ui->debrisMapWidget->angle = radToDeg(psimu.headingFusion);
+    ui->rotationLCD->display(radToDeg(psimu.wz));
+    ui->orientationLCD->display(radToDeg(psimu.headingFusion));
+    ui->pitchLCD->display(radToDeg(psimu.pitch));
+    ui->rollLCD->display(radToDeg(psimu.roll));
+
+    /*LED updates*/
+    if(psimu.calibrationActive){
+        console(LogInfo, MsgCalibrationRunning);
     }
-    default:
-        break;
+}
+
+
+void Groundstation::onCounter(const PayloadSatellite &payload){
+    PayloadCounter pscount(payload);
+    latency.decoded(payload);
+}
+
+
+void Groundstation::onElectrical(const PayloadSatellite &payload){
+    PayloadElectrical pelec(payload);
+    latency.decoded(payload);
+
+    /*LED updates*/
+    ui->lightsensorLED->setChecked(pelec.lightsensorOn);
+    ui->electromagnetLED->setChecked(pelec.electromagnetOn);
+    ui->thermalKnifeLED->setChecked(pelec.thermalKnifeOn);
+    ui->racksDeployedLED->setChecked(pelec.racksOut);
+    ui->solarDeployedLED->setChecked(pelec.solarPanelsOut);
+
+    /*LCD updates*/
+    ui->solarVoltageLCD->display(pelec.solarPanelVoltage);
+    ui->solarCurrentLCD->display(pelec.solarPanelCurrent);
+    ui->batteryCurrentLCD->display(pelec.batteryCurrent);
+    ui->batteryVoltageLCD->display(pelec.batteryVoltage);
+    ui->powerConsumptionLCD->display(pelec.batteryVoltage * pelec.batteryCurrent / 1000);
+}
+
+
+void Groundstation::onLight(const PayloadSatellite &payload){
+    PayloadLight plight(payload);
+    latency.decoded(payload);
+    ui->lightsensorLCD->display(plight.lightValue);
+
+    /*sunFinderWidget / lightsensor graph update*/
+    if(ui->lightsensorLED->isChecked()){
+        ui->sunFinderWidget->graph(0)->addData(key, plight.lightValue);
+    }else{
+        ui->sunFinderWidget->graph(0)->addData(key, 0);
     }
-    return;
+    ui->sunFinderWidget->graph(0)->removeDataBefore(key-XAXIS_VISIBLE_TIME);
+    ui->sunFinderWidget->graph(0)->rescaleValueAxis();
+    ui->sunFinderWidget->xAxis->setRange(key+0.25, XAXIS_VISIBLE_TIME, Qt::AlignRight);
+    ui->sunFinderWidget->replot();
+}
+
+
+void Groundstation::onMission(const PayloadSatellite &payload){
+    PayloadMission pmission(payload);
+    latency.decoded(payload);
+    Debris tc_debris = Debris(pmission.partNumber, pmission.angle, pmission.isCleaned);
+    ui->debrisMapWidget->processDebris(&tc_debris);
+    ui->debrisFoundLCD->display(ui->debrisMapWidget->getFoundNumber());
+    ui->debrisCleanedLCD->display(ui->debrisMapWidget->getCleanedNumber());
+}
+
+void Groundstation::onTelecommandAck(const PayloadSatellite &payload){
+    if(payload.userDataLen < sizeof(Command))
+        return;
+    Command com(0, 0, 0);
+    memcpy(&com, payload.userData, sizeof(Command));
+    console(LogInfo, MsgTelecommandAcknowledged, com.id, com.identifier);
+}
+
+
+/*Replots happen synchronously in readoutConnection, the last one ends the packet's render stage*/
+void Groundstation::onAfterReplot(){
+    latency.replotted();
+}
+
+
+/*----*/
+/*MENU*/
+/*----*/
+
+/*Luma only skips the chroma conversion, takes effect with the next image lines*/
+void Groundstation::onGrayscaleToggled(bool grayscale){
+    imager.setColorMode(grayscale ? ColorModeGrayscale : ColorModeRgb);
+}
+
+
+/*Formatting runs on the thread pool, the window waits since the store must not change meanwhile*/
+void Groundstation::onExportTelemetryTriggered(){
+    ExportDialog dialog(telemetryStore, &dictionary, this);
+    if(dialog.exec() != QDialog::Accepted)
+        return;
+    TelemetryExporter exporter(telemetryStore, &dictionary);
+    QString error;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool ok = exporter.write(dialog.fileName(), dialog.channels(), dialog.from(), dialog.to(), dialog.format(), &error);
+    QApplication::restoreOverrideCursor();
+    if(ok)
+        console(LogInfo, MsgTelemetryExported, exporter.rowCount(), dialog.fileName());
+    else
+        console(LogError, MsgExportFailed, dialog.fileName());
 }
 
 
@@ -231,13 +370,11 @@ void Groundstation::telecommand(int ID, int identifier, int value){
 
 /*Top Row*/
 void Groundstation::onOpenPortButtonClicked(){
-    imager.activePortName = ui->bluetoothComboBox->currentText();
-    imager.openPort();
+    QMetaObject::invokeMethod(&imager, "openPort", Qt::QueuedConnection, Q_ARG(QString, ui->bluetoothComboBox->currentText()));
 }
 
 void Groundstation::onClosePortButtonClicked(){
-    imager.activePortName = ui->bluetoothComboBox->currentText();
-    imager.closePort();
+    QMetaObject::invokeMethod(&imager, "closePort", Qt::QueuedConnection, Q_ARG(QString, ui->bluetoothComboBox->currentText()));
 }
 
 void Groundstation::onRestartWifiButtonClicked(){
@@ -325,11 +462,11 @@ void Groundstation::onOrientationSetButtonClicked(){
     bool ok;
     angle = ui->orientationLineEdit->text().toInt(&ok);
     if(ok && (360 >= angle) && (angle >= 0)){
-        console(QString("TC: Set orientation to %1 degrees").arg(angle));
+        console(LogInfo, MsgSetOrientation, angle);
         telecommand(ID_ATTITUDE, 2002, angle);
     }
     else
-        console("ERROR: Orientation angle invalid");
+        console(LogError, MsgAngleInvalid);
 }
 
 /*also works with rotationLineEdit->returnPressed()*/
@@ -338,11 +475,11 @@ void Groundstation::onSetRotationButtonClicked(){
     bool ok;
     angle = ui->rotationLineEdit->text().toInt(&ok);
     if(ok && (360 >= angle) && (angle >= -360)){
-        console(QString("TC: Set orientation to %1 degrees").arg(angle));
+        console(LogInfo, MsgSetRotation, angle);
         telecommand(ID_ATTITUDE, 2001, angle);
     }
     else
-        console("ERROR: Orientation angle invalid");
+        console(LogError, MsgAngleInvalid);
 }
 
 /*Mission Tab*/
@@ -366,272 +503,84 @@ void Groundstation::onMissionAbortButtonClicked(){
 /*------------*/
 
 void Groundstation::setupGraphs(){
+    setupStandardPlot(ui->accelerometerWidget, standardPlots[PlotAccelerometer], font());
+    setupStandardPlot(ui->gyroscopeWidget, standardPlots[PlotGyroscope], font());
+    setupStandardPlot(ui->headingWidget, standardPlots[PlotHeading], font());
+    setupStandardPlot(ui->sunFinderWidget, standardPlots[PlotSunFinder], font());
+}
+
+
+/*-------------*/
+/*IMAGE ARCHIVE*/
+/*-------------*/
 
-    /*Defining fonts*/
-    QFont legendFont = font();
-    legendFont.setPointSize(7);
-
-    QFont labelFont1 = font();
-    labelFont1.setPointSize(9);
-
-    /*Defining grey gradients*/
-    QLinearGradient plotGradient;
-    plotGradient.setStart(0, 0);
-    plotGradient.setFinalStop(0, 350);
-    plotGradient.setColorAt(0, QColor(120, 120, 120));
-    plotGradient.setColorAt(1, QColor(80, 80, 80));
-
-    QLinearGradient axisRectGradient;
-    axisRectGradient.setStart(0, 0);
-    axisRectGradient.setFinalStop(0, 350);
-    axisRectGradient.setColorAt(0, QColor(120, 120, 120));
-    axisRectGradient.setColorAt(1, QColor(80, 80, 80));
-
-    /*Set up accelerometerWidget*/
-    ui->accelerometerWidget->xAxis->setLabel("Current Time");
-    ui->accelerometerWidget->xAxis->setTickLabelType(QCPAxis::ltDateTime);
-    ui->accelerometerWidget->xAxis->setDateTimeFormat("hh:mm:ss");
-    ui->accelerometerWidget->xAxis->setAutoTickStep(false);
-    ui->accelerometerWidget->xAxis->setTickStep(XAXIS_TICKSTEP);
-    ui->accelerometerWidget->yAxis->setLabel("Acceleration (g)");
-    ui->accelerometerWidget->axisRect()->setupFullAxesBox();
-    ui->accelerometerWidget->xAxis->setLabelFont(labelFont1);
-    ui->accelerometerWidget->yAxis->setLabelFont(labelFont1);
-    ui->accelerometerWidget->legend->setVisible(true);
-    ui->accelerometerWidget->legend->setFont(legendFont);
-    ui->accelerometerWidget->legend->setBrush(QBrush(QColor(255,255,255,230)));
-    ui->accelerometerWidget->legend->setIconSize(10,5);
-    ui->accelerometerWidget->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignBottom|Qt::AlignLeft);
-    ui->accelerometerWidget->addGraph();
-    ui->accelerometerWidget->graph(0)->setPen(QPen(Qt::yellow));
-    ui->accelerometerWidget->graph(0)->setName("x");
-    ui->accelerometerWidget->addGraph();
-    ui->accelerometerWidget->graph(1)->setPen(QPen(Qt::red));
-    ui->accelerometerWidget->graph(1)->setName("y");
-    ui->accelerometerWidget->addGraph();
-    ui->accelerometerWidget->graph(2)->setPen(QPen(Qt::green));
-    ui->accelerometerWidget->graph(2)->setName("z");
-    ui->accelerometerWidget->xAxis->setBasePen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->xAxis2->setBasePen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->yAxis->setBasePen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->yAxis2->setBasePen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->xAxis->setTickPen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->xAxis2->setTickPen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->yAxis->setTickPen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->yAxis2->setTickPen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->xAxis->setSubTickPen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->xAxis2->setSubTickPen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->yAxis->setSubTickPen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->yAxis2->setSubTickPen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->xAxis->setTickLabelColor(Qt::white);
-    ui->accelerometerWidget->yAxis->setTickLabelColor(Qt::white);
-    ui->accelerometerWidget->xAxis->setLabelColor(Qt::white);
-    ui->accelerometerWidget->yAxis->setLabelColor(Qt::white);
-    ui->accelerometerWidget->legend->setBorderPen(QPen(Qt::white, 1));
-    ui->accelerometerWidget->legend->setTextColor(Qt::white);
-    ui->accelerometerWidget->legend->setBrush(plotGradient);
-    ui->accelerometerWidget->xAxis->grid()->setPen(QPen(QColor(140, 140, 140), 1, Qt::DotLine));
-    ui->accelerometerWidget->yAxis->grid()->setPen(QPen(QColor(140, 140, 140), 1, Qt::DotLine));
-    ui->accelerometerWidget->xAxis->grid()->setSubGridPen(QPen(QColor(80, 80, 80), 1, Qt::DotLine));
-    ui->accelerometerWidget->yAxis->grid()->setSubGridPen(QPen(QColor(80, 80, 80), 1, Qt::DotLine));
-    ui->accelerometerWidget->xAxis->grid()->setSubGridVisible(true);
-    ui->accelerometerWidget->yAxis->grid()->setSubGridVisible(true);
-    ui->accelerometerWidget->xAxis->grid()->setZeroLinePen(Qt::NoPen);
-    ui->accelerometerWidget->yAxis->grid()->setZeroLinePen(Qt::NoPen);
-    ui->accelerometerWidget->setBackground(plotGradient);
-    ui->accelerometerWidget->axisRect()->setBackground(axisRectGradient);
-    /*make left and bottom axes transfer their ranges to right and top axes*/
-    connect(ui->accelerometerWidget->xAxis, SIGNAL(rangeChanged(QCPRange)), ui->accelerometerWidget->xAxis2, SLOT(setRange(QCPRange)));
-    connect(ui->accelerometerWidget->yAxis, SIGNAL(rangeChanged(QCPRange)), ui->accelerometerWidget->yAxis2, SLOT(setRange(QCPRange)));
-
-    /*Set up gyroscopeWidget*/
-    ui->gyroscopeWidget->xAxis->setLabel("Current Time");
-    ui->gyroscopeWidget->xAxis->setTickLabelType(QCPAxis::ltDateTime);
-    ui->gyroscopeWidget->xAxis->setDateTimeFormat("hh:mm:ss");
-    ui->gyroscopeWidget->xAxis->setAutoTickStep(false);
-    ui->gyroscopeWidget->xAxis->setTickStep(XAXIS_TICKSTEP);
-    ui->gyroscopeWidget->yAxis->setLabel("Angular Speed (deg/sec)");
-    ui->gyroscopeWidget->xAxis->setLabelFont(labelFont1);
-    ui->gyroscopeWidget->yAxis->setLabelFont(labelFont1);
-    ui->gyroscopeWidget->axisRect()->setupFullAxesBox();
-    ui->gyroscopeWidget->legend->setVisible(true);
-    ui->gyroscopeWidget->legend->setFont(legendFont);
-    ui->gyroscopeWidget->legend->setBrush(QBrush(QColor(255,255,255,230)));
-    ui->gyroscopeWidget->legend->setIconSize(10,5);
-    ui->gyroscopeWidget->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignBottom|Qt::AlignLeft);
-    ui->gyroscopeWidget->addGraph();
-    ui->gyroscopeWidget->graph(0)->setPen(QPen(Qt::yellow));
-    ui->gyroscopeWidget->graph(0)->setName("x");
-    ui->gyroscopeWidget->addGraph();
-    ui->gyroscopeWidget->graph(1)->setPen(QPen(Qt::red));
-    ui->gyroscopeWidget->graph(1)->setName("y");
-    ui->gyroscopeWidget->addGraph();
-    ui->gyroscopeWidget->graph(2)->setPen(QPen(Qt::green));
-    ui->gyroscopeWidget->graph(2)->setName("z");
-    ui->gyroscopeWidget->xAxis->setBasePen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->xAxis2->setBasePen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->yAxis->setBasePen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->yAxis2->setBasePen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->xAxis->setTickPen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->xAxis2->setTickPen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->yAxis->setTickPen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->yAxis2->setTickPen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->xAxis->setSubTickPen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->xAxis2->setSubTickPen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->yAxis->setSubTickPen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->yAxis2->setSubTickPen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->xAxis->setTickLabelColor(Qt::white);
-    ui->gyroscopeWidget->yAxis->setTickLabelColor(Qt::white);
-    ui->gyroscopeWidget->xAxis->setLabelColor(Qt::white);
-    ui->gyroscopeWidget->yAxis->setLabelColor(Qt::white);
-    ui->gyroscopeWidget->legend->setBorderPen(QPen(Qt::white, 1));
-    ui->gyroscopeWidget->legend->setTextColor(Qt::white);
-    ui->gyroscopeWidget->legend->setBrush(plotGradient);
-    ui->gyroscopeWidget->xAxis->grid()->setPen(QPen(QColor(140, 140, 140), 1, Qt::DotLine));
-    ui->gyroscopeWidget->yAxis->grid()->setPen(QPen(QColor(140, 140, 140), 1, Qt::DotLine));
-    ui->gyroscopeWidget->xAxis->grid()->setSubGridPen(QPen(QColor(80, 80, 80), 1, Qt::DotLine));
-    ui->gyroscopeWidget->yAxis->grid()->setSubGridPen(QPen(QColor(80, 80, 80), 1, Qt::DotLine));
-    ui->gyroscopeWidget->xAxis->grid()->setSubGridVisible(true);
-    ui->gyroscopeWidget->yAxis->grid()->setSubGridVisible(true);
-    ui->gyroscopeWidget->xAxis->grid()->setZeroLinePen(Qt::NoPen);
-    ui->gyroscopeWidget->yAxis->grid()->setZeroLinePen(Qt::NoPen);
-    ui->gyroscopeWidget->setBackground(plotGradient);
-    ui->gyroscopeWidget->axisRect()->setBackground(axisRectGradient);
-    /*make left and bottom axes transfer their ranges to right and top axes*/
-    connect(ui->gyroscopeWidget->xAxis, SIGNAL(rangeChanged(QCPRange)), ui->gyroscopeWidget->xAxis2, SLOT(setRange(QCPRange)));
-    connect(ui->gyroscopeWidget->yAxis, SIGNAL(rangeChanged(QCPRange)), ui->gyroscopeWidget->yAxis2, SLOT(setRange(QCPRange)));
-
-    /*Set up headingWidget*/
-    ui->headingWidget->xAxis->setLabel("Current Time");
-    ui->headingWidget->xAxis->setTickLabelType(QCPAxis::ltDateTime);
-    ui->headingWidget->xAxis->setDateTimeFormat("hh:mm:ss");
-    ui->headingWidget->xAxis->setAutoTickStep(false);
-    ui->headingWidget->xAxis->setTickStep(XAXIS_TICKSTEP);
-    ui->headingWidget->yAxis->setLabel("Heading (deg)");
-    ui->headingWidget->xAxis->setLabelFont(labelFont1);
-    ui->headingWidget->yAxis->setLabelFont(labelFont1);
-    ui->headingWidget->axisRect()->setupFullAxesBox();
-    ui->headingWidget->legend->setVisible(true);
-    ui->headingWidget->legend->setFont(legendFont);
-    ui->headingWidget->legend->setBrush(QBrush(QColor(255,255,255,230)));
-    ui->headingWidget->legend->setIconSize(10,5);
-    ui->headingWidget->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignBottom|Qt::AlignLeft);
-    ui->headingWidget->addGraph();
-    ui->headingWidget->graph(0)->setPen(QPen(Qt::yellow));
-    ui->headingWidget->graph(0)->setName("Xm");
-    ui->headingWidget->addGraph();
-    ui->headingWidget->graph(1)->setPen(QPen(Qt::red));
-    ui->headingWidget->graph(1)->setName("Gyro");
-    ui->headingWidget->addGraph();
-    ui->headingWidget->graph(2)->setPen(QPen(Qt::green));
-    ui->headingWidget->graph(2)->setName("Combined");
-    ui->headingWidget->xAxis->setBasePen(QPen(Qt::white, 1));
-    ui->headingWidget->xAxis2->setBasePen(QPen(Qt::white, 1));
-    ui->headingWidget->yAxis->setBasePen(QPen(Qt::white, 1));
-    ui->headingWidget->yAxis2->setBasePen(QPen(Qt::white, 1));
-    ui->headingWidget->xAxis->setTickPen(QPen(Qt::white, 1));
-    ui->headingWidget->xAxis2->setTickPen(QPen(Qt::white, 1));
-    ui->headingWidget->yAxis->setTickPen(QPen(Qt::white, 1));
-    ui->headingWidget->yAxis2->setTickPen(QPen(Qt::white, 1));
-    ui->headingWidget->xAxis->setSubTickPen(QPen(Qt::white, 1));
-    ui->headingWidget->xAxis2->setSubTickPen(QPen(Qt::white, 1));
-    ui->headingWidget->yAxis->setSubTickPen(QPen(Qt::white, 1));
-    ui->headingWidget->yAxis2->setSubTickPen(QPen(Qt::white, 1));
-    ui->headingWidget->xAxis->setTickLabelColor(Qt::white);
-    ui->headingWidget->yAxis->setTickLabelColor(Qt::white);
-    ui->headingWidget->xAxis->setLabelColor(Qt::white);
-    ui->headingWidget->yAxis->setLabelColor(Qt::white);
-    ui->headingWidget->legend->setBorderPen(QPen(Qt::white, 1));
-    ui->headingWidget->legend->setTextColor(Qt::white);
-    ui->headingWidget->legend->setBrush(plotGradient);
-    ui->headingWidget->xAxis->grid()->setPen(QPen(QColor(140, 140, 140), 1, Qt::DotLine));
-    ui->headingWidget->yAxis->grid()->setPen(QPen(QColor(140, 140, 140), 1, Qt::DotLine));
-    ui->headingWidget->xAxis->grid()->setSubGridPen(QPen(QColor(80, 80, 80), 1, Qt::DotLine));
-    ui->headingWidget->yAxis->grid()->setSubGridPen(QPen(QColor(80, 80, 80), 1, Qt::DotLine));
-    ui->headingWidget->xAxis->grid()->setSubGridVisible(true);
-    ui->headingWidget->yAxis->grid()->setSubGridVisible(true);
-    ui->headingWidget->xAxis->grid()->setZeroLinePen(Qt::NoPen);
-    ui->headingWidget->yAxis->grid()->setZeroLinePen(Qt::NoPen);
-    ui->headingWidget->setBackground(plotGradient);
-    ui->headingWidget->axisRect()->setBackground(axisRectGradient);
-    /*make left and bottom axes transfer their ranges to right and top axes*/
-    connect(ui->headingWidget->xAxis, SIGNAL(rangeChanged(QCPRange)), ui->headingWidget->xAxis2, SLOT(setRange(QCPRange)));
-    connect(ui->headingWidget->yAxis, SIGNAL(rangeChanged(QCPRange)), ui->headingWidget->yAxis2, SLOT(setRange(QCPRange)));
-
-    /*Set up sunFinderWidget*/
-    ui->sunFinderWidget->xAxis->setLabel("Current Time");
-    ui->sunFinderWidget->xAxis->setTickLabelType(QCPAxis::ltDateTime);
-    ui->sunFinderWidget->xAxis->setDateTimeFormat("hh:mm:ss");
-    ui->sunFinderWidget->xAxis->setAutoTickStep(false);
-    ui->sunFinderWidget->xAxis->setTickStep(XAXIS_TICKSTEP);
-    ui->sunFinderWidget->yAxis->setLabel("Lightsensor Data");
-    ui->sunFinderWidget->xAxis->setLabelFont(labelFont1);
-    ui->sunFinderWidget->yAxis->setLabelFont(labelFont1);
-    ui->sunFinderWidget->axisRect()->setupFullAxesBox();
-    ui->sunFinderWidget->addGraph();
-    ui->sunFinderWidget->graph(0)->setPen(QPen(Qt::yellow));
-    ui->sunFinderWidget->xAxis->setBasePen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->xAxis2->setBasePen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->yAxis->setBasePen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->yAxis2->setBasePen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->xAxis->setTickPen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->xAxis2->setTickPen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->yAxis->setTickPen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->yAxis2->setTickPen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->xAxis->setSubTickPen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->xAxis2->setSubTickPen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->yAxis->setSubTickPen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->yAxis2->setSubTickPen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->xAxis->setTickLabelColor(Qt::white);
-    ui->sunFinderWidget->yAxis->setTickLabelColor(Qt::white);
-    ui->sunFinderWidget->xAxis->setLabelColor(Qt::white);
-    ui->sunFinderWidget->yAxis->setLabelColor(Qt::white);
-    ui->sunFinderWidget->legend->setBorderPen(QPen(Qt::white, 1));
-    ui->sunFinderWidget->legend->setTextColor(Qt::white);
-    ui->sunFinderWidget->legend->setBrush(plotGradient);
-    ui->sunFinderWidget->xAxis->grid()->setPen(QPen(QColor(140, 140, 140), 1, Qt::DotLine));
-    ui->sunFinderWidget->yAxis->grid()->setPen(QPen(QColor(140, 140, 140), 1, Qt::DotLine));
-    ui->sunFinderWidget->xAxis->grid()->setSubGridPen(QPen(QColor(80, 80, 80), 1, Qt::DotLine));
-    ui->sunFinderWidget->yAxis->grid()->setSubGridPen(QPen(QColor(80, 80, 80), 1, Qt::DotLine));
-    ui->sunFinderWidget->xAxis->grid()->setSubGridVisible(true);
-    ui->sunFinderWidget->yAxis->grid()->setSubGridVisible(true);
-    ui->sunFinderWidget->xAxis->grid()->setZeroLinePen(Qt::NoPen);
-    ui->sunFinderWidget->yAxis->grid()->setZeroLinePen(Qt::NoPen);
-    ui->sunFinderWidget->setBackground(plotGradient);
-    ui->sunFinderWidget->axisRect()->setBackground(axisRectGradient);
-    /*make left and bottom axes transfer their ranges to right and top axes*/
-    connect(ui->sunFinderWidget->xAxis, SIGNAL(rangeChanged(QCPRange)), ui->sunFinderWidget->xAxis2, SLOT(setRange(QCPRange)));
-    connect(ui->sunFinderWidget->yAxis, SIGNAL(rangeChanged(QCPRange)), ui->sunFinderWidget->yAxis2, SLOT(setRange(QCPRange)));
+/*Every received image is appended to a memory mapped frame store, browsable in its own tab*/
+void Groundstation::setupImageArchive(int maxFrames){
+    qRegisterMetaType<FrameRecordInfo>();
+    imageArchive = new ImageArchive(this);
+    imageArchive->setMaxFrames(maxFrames > 0 ? maxFrames : FRAMESTORE_MAX_FRAMES);
+    ui->operationTab->addTab(imageArchive, "Image Archive");
+    connect(&imager, SIGNAL(imageReceived(QByteArray,FrameRecordInfo)), imageArchive, SLOT(addFrame(QByteArray,FrameRecordInfo)));
+
+    QString path = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
+    QDir().mkpath(path);
+    imageArchive->open(path + "/images.frames");
 }
 
 
-/*--------------------*/
-/*CONSOLE TEXT UPDATES*/
-/*--------------------*/
+void Groundstation::setupDiagnostics(){
+    diagnosticsPanel = new DiagnosticsPanel(&latency, link.statistics(), this);
+    ui->operationTab->addTab(diagnosticsPanel, "Diagnostics");
+    if(!telemetryPlots->isEmpty())
+        ui->operationTab->addTab(telemetryPlots, "Telemetry");
+    else
+        telemetryPlots->hide();
+    connect(ui->accelerometerWidget, SIGNAL(afterReplot()), this, SLOT(onAfterReplot()));
+    connect(ui->gyroscopeWidget, SIGNAL(afterReplot()), this, SLOT(onAfterReplot()));
+    connect(ui->headingWidget, SIGNAL(afterReplot()), this, SLOT(onAfterReplot()));
+    connect(ui->sunFinderWidget, SIGNAL(afterReplot()), this, SLOT(onAfterReplot()));
+}
 
-/*Console updates from lower classes*/
 
-void Groundstation::console(QString msg){
-    ui->consoleWidget->writeString(msg);
+/*The IMU plots scroll and zoom back through the telemetry store, scaled like the live data*/
+void Groundstation::setupHistory(){
+    telemetryQuery = new TelemetryQuery(telemetryStore);
+    accelerometerHistory = createHistory(ui->accelerometerWidget, standardPlots[PlotAccelerometer]);
+    gyroscopeHistory = createHistory(ui->gyroscopeWidget, standardPlots[PlotGyroscope]);
+    headingHistory = createHistory(ui->headingWidget, standardPlots[PlotHeading]);
 }
 
-void Groundstation::connectionUpdateConsole(){
-    ui->consoleWidget->writeString(link.consoleText);
+PlotHistory *Groundstation::createHistory(QCustomPlot *plot, const StandardPlot &definition){
+    PlotHistory *history = new PlotHistory(plot, telemetryQuery, XAXIS_VISIBLE_TIME, this);
+    for(int i = 0; i < definition.graphCount; i++){
+        history->addGraph(i, dictionary.channelId(definition.channels[i]), definition.scale);
+    }
+    return history;
 }
 
-void Groundstation::imagelinkUpdateConsole(){
-    ui->consoleWidget->writeString(imager.consoleText);
+
+/*Rotated session logs of earlier runs stay next to the image archive*/
+void Groundstation::setupLogFile(){
+    QString path = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
+    logFile = new LogFile(path + "/logs", this);
+    logger.addSink(logFile);
+    logFile->start(QThread::LowPriority);
 }
 
 
-/*---------------------*/
-/*DISPLAY UPDATED IMAGE*/
-/*---------------------*/
+/*--------------------*/
+/*CONSOLE TEXT UPDATES*/
+/*--------------------*/
+
+/*Console messages of the ground station itself, lower classes post their own records*/
+
+/*msg has to be a string literal, it is formatted when displayed*/
+void Groundstation::console(const char *msg){
+    Logger::post(LogInfo, LogGroundstation, MsgText, msg);
+}
 
-/*Getting the updated image from imagelink and updating it in the UI*/
-void Groundstation::updateImage(){
-    QImage scaled = imager.currentImage.scaled(ui->missionInputLabel->width(),ui->missionInputLabel->height(),Qt::KeepAspectRatio);
-    ui->missionInputLabel->setPixmap(QPixmap::fromImage(scaled));
+void Groundstation::console(LogLevel level, LogMessageId id, const LogArg &arg1, const LogArg &arg2){
+    Logger::post(level, LogGroundstation, id, arg1, arg2);
 }
 
 
@@ -641,16 +590,15 @@ void Groundstation::updateImage(){
 
 /*disable telemetry LED when connection is lost after around 3 seconds*/
 void Groundstation::telemetryCheck(){
-    if((ui->telemetryLED->isChecked()) && (QDateTime::currentDateTime().toMSecsSinceEpoch()/1000.0 - key) >= 3){
+    if((ui->telemetryLED->isChecked()) && (groundTime() - lastReceiveTime) >= 3000000000LL){
         ui->telemetryLED->setChecked(false);
-        console("Telemetry lost.");
+        console(LogWarning, MsgTelemetryLost);
     }
 }
 
 /*update bluetooth activity LED when a different port is selected from list*/
 void Groundstation::updateBluetoothLED(){
-    imager.activePortName = ui->bluetoothComboBox->currentText();
-    ui->bluetoothLED->setChecked(imager.isOpen());
+    ui->bluetoothLED->setChecked(imager.isOpen(ui->bluetoothComboBox->currentText()));
 }
 
 /*Radiants to degrees conversion*/
@@ -7,15 +7,34 @@
 #include <QtNetwork>
 #include <QImage>
 #include <QtEndian>
+#include <QThread>
+#include <QStandardPaths>
+#include <QDir>
+#include <QCommandLineParser>
 
 #include <stdio.h>
 #include <math.h>
 
 #include "connection.h"
 #include "imagelink.h"
+#include "imagearchive.h"
+#include "logger.h"
+#include "logfile.h"
+#include "latencymonitor.h"
+#include "diagnosticspanel.h"
+#include "topicdispatcher.h"
+#include "telemetrydictionary.h"
+#include "telemetryrouter.h"
+#include "telemetryplots.h"
+#include "telemetrystore.h"
+#include "telemetryarchive.h"
+#include "telemetryquery.h"
+#include "plothistory.h"
+#include "exportdialog.h"
+#include "plotstyle.h"
 
 #define XAXIS_VISIBLE_TIME 15
-#define XAXIS_TICKSTEP 5
+#define JITTER_BUFFER_LATENCY 50    /*ms the plotted topics are held back to arrive in order*/
 
 #define ID_CALIBRATE 1
 #define ID_ATTITUDE 2
@@ -32,31 +51,66 @@ namespace Ui {
 class Groundstation : public QMainWindow
 {
     Q_OBJECT
+    Logger logger;
     Connection link;
-    Imagelink imager;
+    TopicDispatcher dispatcher;
+    TelemetryDictionary dictionary;
+    TelemetryRouter telemetryRouter;    /*decodes every dictionary topic for the generic sinks*/
+    Imagelink imager;               /*lives in imagelinkThread, only talk to it through queued calls*/
+    QThread imagelinkThread;
 
 public:
-    explicit Groundstation(QWidget *parent = 0);
+    explicit Groundstation(const QCommandLineParser &options, QWidget *parent = 0);
     ~Groundstation();
 
 private:
     Ui::Groundstation *ui;
 
+    ImageArchive *imageArchive;
+    LogFile *logFile;
+    LatencyMonitor latency;
+    DiagnosticsPanel *diagnosticsPanel;
+    TelemetryPlots *telemetryPlots;
+    TelemetryStore *telemetryStore;     /*history of all decoded channels*/
+    TelemetryArchive *telemetryArchive; /*the same history compressed on disk*/
+    TelemetryQuery *telemetryQuery;
+    PlotHistory *accelerometerHistory;
+    PlotHistory *gyroscopeHistory;
+    PlotHistory *headingHistory;
+
     double key;
+    qint64 lastReceiveTime;         /*ns, ground clock*/
     void telecommand(int ID, int identifier, int value);
     void setupGraphs();
-    void console(QString msg);
+    void setupHistory();
+    PlotHistory *createHistory(QCustomPlot *plot, const StandardPlot &definition);
+    void setupDictionary();
+    void setupDispatcher();
+    void setupImageArchive(int maxFrames);
+    void setupLogFile();
+    void setupDiagnostics();
+    void console(const char *msg);
+    void console(LogLevel level, LogMessageId id, const LogArg &arg1 = LogArg(), const LogArg &arg2 = LogArg());
 
     int displayImage(uint8_t orig[121*160*2], QLabel* label);
     float radToDeg(float rad);
 
+    /*Topic handlers*/
+    void onSensorIMU(const PayloadSatellite &payload);
+    void onCounter(const PayloadSatellite &payload);
+    void onElectrical(const PayloadSatellite &payload);
+    void onLight(const PayloadSatellite &payload);
+    void onMission(const PayloadSatellite &payload);
+    void onTelecommandAck(const PayloadSatellite &payload);
+
 private slots:
     /*Connection*/
     void readoutConnection();
-    void connectionUpdateConsole();
+    void onAfterReplot();
 
-    /*Bluetooth*/
-    void imagelinkUpdateConsole();
+    /*Menu*/
+    void onExportTelemetryTriggered();
+    void onGrayscaleToggled(bool grayscale);
 
     /*Buttons Top Row*/
     void onOpenPortButtonClicked();
@@ -93,7 +147,6 @@ private slots:
     void onMissionAbortButtonClicked();
 
     /*Updates*/
-    void updateImage();
     void telemetryCheck();
     void updateBluetoothLED();
 };
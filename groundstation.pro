@@ -0,0 +1,89 @@
+QT       += core \
+            gui \
+            widgets \
+            printsupport \
+            network \
+            serialport \
+            concurrent
+
+TARGET = Groundstation_prel
+TEMPLATE = app
+CONFIG += c++11
+
+SOURCES += main.cpp \
+    groundstation.cpp \
+    compass.cpp \
+    debrismap.cpp \
+    qcustomplot.cpp \
+    console.cpp \
+    connection.cpp \
+    payload.cpp \
+    qledindicator.cpp \
+    imagelink.cpp \
+    colorconversion.cpp \
+    imagecodec.cpp \
+    framestore.cpp \
+    imagearchive.cpp \
+    imageview.cpp \
+    logger.cpp \
+    logfile.cpp \
+    clocksync.cpp \
+    latencyhistogram.cpp \
+    latencymonitor.cpp \
+    diagnosticspanel.cpp \
+    linkstatistics.cpp \
+    topicdispatcher.cpp \
+    telemetrydictionary.cpp \
+    telemetryrouter.cpp \
+    telemetryplots.cpp \
+    telemetrystore.cpp \
+    telemetrycodec.cpp \
+    telemetryarchive.cpp \
+    telemetryquery.cpp \
+    plothistory.cpp \
+    telemetryexport.cpp \
+    exportdialog.cpp \
+    headless.cpp \
+    plotstyle.cpp \
+    telemetryreport.cpp
+
+HEADERS  += groundstation.h \
+    compass.h \
+    debrismap.h \
+    qcustomplot.h \
+    console.h \
+    connection.h \
+    payload.h \
+    payloadschema.h \
+    qledindicator.h \
+    imagelink.h \
+    colorconversion.h \
+    imagecodec.h \
+    framestore.h \
+    imagearchive.h \
+    imageview.h \
+    logger.h \
+    logfile.h \
+    clocksync.h \
+    latencyhistogram.h \
+    latencymonitor.h \
+    diagnosticspanel.h \
+    linkstatistics.h \
+    topicdispatcher.h \
+    telemetrydictionary.h \
+    telemetryrouter.h \
+    telemetryplots.h \
+    telemetrystore.h \
+    telemetrycodec.h \
+    telemetryarchive.h \
+    telemetryquery.h \
+    plothistory.h \
+    telemetryexport.h \
+    exportdialog.h \
+    headless.h \
+    plotstyle.h \
+    telemetryreport.h
+
+FORMS    += groundstation.ui
+
+LIBS += -lz
@@ -0,0 +1,175 @@
+#include "headless.h"
+#include "telemetrydictionary.h"
+#include "telemetrystore.h"
+#include "telemetryarchive.h"
+#include "telemetryexport.h"
+#include "telemetryreport.h"
+#include "clocksync.h"
+#include "connection.h"
+#include "framestore.h"
+
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <stdio.h>
+#include <limits.h>
+
+void addCommandLineOptions(QCommandLineParser &parser){
+    parser.addHelpOption();
+    parser.addOptions(QList<QCommandLineOption>()
+        << QCommandLineOption("export", "Export a recorded session to <file> (.csv or .tlmx) and quit.", "file")
+        << QCommandLineOption("report", "Render the plots of a recorded session to <file> (.pdf or numbered .png) and quit.", "file")
+        << QCommandLineOption("slice", "Seconds of telemetry per report page, 60 by default.", "seconds")
+        << QCommandLineOption("archive", "Telemetry archive to read, the newest session by default.", "file")
+        << QCommandLineOption("channels", "Comma separated channel names, all by default.", "names")
+        << QCommandLineOption("from", "Start of the range, ISO 8601 date and time.", "time")
+        << QCommandLineOption("to", "End of the range, ISO 8601 date and time.", "time")
+        << QCommandLineOption("format", "csv or binary, from the file extension by default.", "format")
+        << QCommandLineOption("local", "Address to bind to, 127.0.0.1 for the satellite simulator.", "address", LOCAL_IP)
+        << QCommandLineOption("satellite", "Address telecommands are sent to, 127.0.0.2 for the satellite simulator.", "address", SATELLITE_IP)
+        << QCommandLineOption("checksum", "Drop telemetry frames with a wrong RODOS checksum.")
+        << QCommandLineOption("camera", "Additional camera port, e.g. the pseudo-terminal of the camera simulator.", "port")
+        << QCommandLineOption("image-frames", "Images kept in the image archive, further ones are not stored.", "count",
+                              QString::number(FRAMESTORE_MAX_FRAMES)));
+}
+
+
+bool isHeadless(int argc, char *argv[]){
+    for(int i = 1; i < argc; i++){
+        if(!qstrcmp(argv[i], "--export") || !qstrcmp(argv[i], "--report"))
+            return true;
+    }
+    return false;
+}
+
+
+static QString dataPath(){
+    return QStandardPaths::writableLocation(QStandardPaths::DataLocation);
+}
+
+static QString newestArchive(){
+    QDir directory(dataPath() + "/telemetry");
+    QStringList files = directory.entryList(QStringList() << "session-*.tlm", QDir::Files, QDir::Name);
+    return files.isEmpty() ? QString() : directory.filePath(files.last());
+}
+
+static qint64 parseTime(const QString &text, qint64 fallback){
+    if(text.isEmpty())
+        return fallback;
+    QDateTime dateTime = QDateTime::fromString(text, Qt::ISODate);
+    if(!dateTime.isValid())
+        return fallback;
+    return (dateTime.toMSecsSinceEpoch() - groundWallClock(0)) * 1000000;
+}
+
+
+/*Same dictionary as the ground station window, so channel names match*/
+static bool loadSession(const QCommandLineParser &parser, TelemetryDictionary &dictionary, TelemetryStore *&store){
+    QString error;
+    QString dictionaryName = dataPath() + "/telemetry.json";
+    if(QFile::exists(dictionaryName) && !dictionary.load(dictionaryName, &error))
+        fprintf(stderr, "Telemetry dictionary ignored: %s\n", qPrintable(error));
+
+    QString archiveName = parser.isSet("archive") ? parser.value("archive") : newestArchive();
+    TelemetryArchiveReader reader;
+    if(archiveName.isEmpty() || !reader.open(archiveName, &error)){
+        fprintf(stderr, "Telemetry archive \"%s\" could not be opened: %s\n", qPrintable(archiveName), qPrintable(error));
+        return false;
+    }
+    store = new TelemetryStore(&dictionary);
+    store->setRetention(0);
+    if(!reader.loadInto(store, &dictionary, &error))
+        fprintf(stderr, "%s: %s\n", qPrintable(archiveName), qPrintable(error));
+    return true;
+}
+
+
+static int runExport(const QCommandLineParser &parser){
+    TelemetryDictionary dictionary;
+    TelemetryStore *store;
+    QElapsedTimer timer;
+    timer.start();
+    if(!loadSession(parser, dictionary, store))
+        return 1;
+    qint64 loadTime = timer.restart();
+
+    QVector<int> channels;
+    if(parser.isSet("channels")){
+        foreach(const QString &name, parser.value("channels").split(',', QString::SkipEmptyParts)){
+            int id = dictionary.channelId(name.trimmed());
+            if(id < 0){
+                fprintf(stderr, "Unknown channel \"%s\"\n", qPrintable(name));
+                delete store;
+                return 1;
+            }
+            channels.append(id);
+        }
+    }else{
+        for(int id = 0; id < dictionary.channelCount(); id++){
+            if(store->sampleCount(id))
+                channels.append(id);
+        }
+    }
+
+    QString fileName = parser.value("export");
+    TelemetryExportFormat format = TelemetryExportBinary;
+    if(parser.isSet("format") ? parser.value("format") == "csv" : fileName.endsWith(".csv", Qt::CaseInsensitive))
+        format = TelemetryExportCsv;
+
+    TelemetryExporter exporter(store, &dictionary);
+    QString error;
+    bool ok = exporter.write(fileName, channels, parseTime(parser.value("from"), LLONG_MIN), parseTime(parser.value("to"), LLONG_MAX), format, &error);
+    if(ok)
+        printf("%lld rows exported to \"%s\" (load %lld ms, export %lld ms)\n",
+               exporter.rowCount(), qPrintable(fileName), loadTime, timer.elapsed());
+    else
+        fprintf(stderr, "Export to \"%s\" failed: %s\n", qPrintable(fileName), qPrintable(error));
+    delete store;
+    return ok ? 0 : 1;
+}
+
+
+/*The range defaults to the whole session*/
+static int runReport(const QCommandLineParser &parser){
+    TelemetryDictionary dictionary;
+    TelemetryStore *store;
+    QElapsedTimer timer;
+    timer.start();
+    if(!loadSession(parser, dictionary, store))
+        return 1;
+    qint64 loadTime = timer.restart();
+
+    qint64 first = LLONG_MAX;
+    qint64 last = LLONG_MIN;
+    for(int id = 0; id < dictionary.channelCount(); id++){
+        if(store->sampleCount(id)){
+            first = qMin(first, store->firstTime(id));
+            last = qMax(last, store->lastTime(id));
+        }
+    }
+
+    QString fileName = parser.value("report");
+    TelemetryReport report(store, &dictionary);
+    if(parser.isSet("slice"))
+        report.setSliceLength((qint64)(parser.value("slice").toDouble() * 1e9));
+    QString error;
+    bool ok = report.render(fileName, parseTime(parser.value("from"), first), parseTime(parser.value("to"), last + 1), &error);
+    if(ok)
+        printf("%d pages rendered to \"%s\" (load %lld ms, render %lld ms)\n",
+               report.pageCount(), qPrintable(fileName), loadTime, timer.elapsed());
+    else
+        fprintf(stderr, "Report \"%s\" failed: %s\n", qPrintable(fileName), qPrintable(error));
+    delete store;
+    return ok ? 0 : 1;
+}
+
+
+int runHeadless(const QCommandLineParser &parser){
+    if(parser.isSet("export"))
+        return runExport(parser);
+    if(parser.isSet("report"))
+        return runReport(parser);
+    return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <QCommandLineParser>
+
+/*Batch jobs on recorded sessions, run without opening the ground station window.
+ * The report draws the plot widgets off screen, so batch jobs run on the offscreen platform.*/
+void addCommandLineOptions(QCommandLineParser &parser);
+bool isHeadless(int argc, char *argv[]);
+int runHeadless(const QCommandLineParser &parser);
+
+#endif // HEADLESS_H
@@ -0,0 +1,179 @@
+#include "imagearchive.h"
+#include "imagelink.h"
+#include "logger.h"
+
+#include <QVBoxLayout>
+#include <QDateTime>
+#include <QScrollBar>
+
+#define THUMBNAIL_WIDTH 80
+#define THUMBNAIL_HEIGHT 61
+#define THUMBNAIL_MARGIN 16         /*thumbnails kept on each side of the visible ones*/
+
+ImageArchive::ImageArchive(QWidget *parent)
+    : QWidget(parent), store(IMAGE_WIDTH, IMAGE_HEIGHT), iconFirst(0), iconLast(-1), fullReported(false){
+    imageView = new ImageView(this);
+    imageView->setFixedSize(2*IMAGE_WIDTH, 2*IMAGE_HEIGHT);
+
+    infoLabel = new QLabel(this);
+    infoLabel->setStyleSheet("color: white");
+
+    frameSlider = new QSlider(Qt::Horizontal, this);
+    frameSlider->setRange(0, 0);
+
+    /*Horizontal strip of thumbnails*/
+    thumbnailList = new QListWidget(this);
+    thumbnailList->setViewMode(QListView::IconMode);
+    thumbnailList->setFlow(QListView::LeftToRight);
+    thumbnailList->setWrapping(false);
+    thumbnailList->setMovement(QListView::Static);
+    thumbnailList->setUniformItemSizes(true);
+    thumbnailList->setIconSize(QSize(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT));
+    thumbnailList->setFixedHeight(THUMBNAIL_HEIGHT + 30);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(imageView, 0, Qt::AlignHCenter);
+    layout->addWidget(infoLabel, 0, Qt::AlignHCenter);
+    layout->addWidget(frameSlider);
+    layout->addWidget(thumbnailList);
+    layout->addStretch();
+
+    connect(frameSlider, SIGNAL(valueChanged(int)), this, SLOT(showFrame(int)));
+    connect(thumbnailList, SIGNAL(currentRowChanged(int)), this, SLOT(onThumbnailRowChanged(int)));
+    connect(thumbnailList->horizontalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(updateThumbnails()));
+    connect(thumbnailList->horizontalScrollBar(), SIGNAL(rangeChanged(int,int)), this, SLOT(updateThumbnails()));
+}
+
+
+/*Open the store and show everything received in earlier sessions*/
+bool ImageArchive::open(const QString &fileName){
+    if(!store.open(fileName)){
+        Logger::post(LogError, LogArchive, MsgArchiveOpenFailed, fileName);
+        return false;
+    }
+    thumbnailList->clear();
+    iconFirst = 0;
+    iconLast = -1;
+    fullReported = false;
+    for(int i = 0; i < store.count(); i++){
+        addThumbnail(i);
+    }
+    frameSlider->setRange(0, qMax(0, store.count() - 1));
+    frameSlider->setValue(frameSlider->maximum());
+    showFrame(frameSlider->value());
+    updateThumbnails();
+    return true;
+}
+
+
+QString ImageArchive::fileName() const{
+    return store.fileName();
+}
+
+
+void ImageArchive::setMaxFrames(int maxFrames){
+    store.setMaxFrames(maxFrames);
+}
+
+
+void ImageArchive::addFrame(const QByteArray &rawImage, const FrameRecordInfo &info){
+    if(store.isFull()){
+        if(!fullReported)
+            Logger::post(LogWarning, LogArchive, MsgArchiveFull, store.maxFrames());
+        fullReported = true;
+        return;
+    }
+    if(!store.append(rawImage, info)){
+        Logger::post(LogError, LogArchive, MsgArchiveAppendFailed);
+        return;
+    }
+    addThumbnail(store.count() - 1);
+
+    /*Follow new images only if the newest one was shown before*/
+    bool following = frameSlider->value() == frameSlider->maximum();
+    frameSlider->setRange(0, store.count() - 1);
+    if(following)
+        frameSlider->setValue(frameSlider->maximum());
+    if(store.count() == 1)
+        showFrame(0);
+    updateThumbnails();
+}
+
+
+/*Scrubbing only converts the mapped raw frame, nothing has to be decoded*/
+void ImageArchive::showFrame(int index){
+    const FrameRecordInfo *info = store.info(index);
+    if(!info){
+        imageView->clear();
+        infoLabel->setText("No images received yet");
+        return;
+    }
+    imageView->setImage(frameImage(index));
+    infoLabel->setText(QString("#%1  %2  %3 bytes in %4 ms%5")
+                       .arg(index + 1)
+                       .arg(QDateTime::fromMSecsSinceEpoch(info->receiveTime).toString("yyyy-MM-dd hh:mm:ss"))
+                       .arg(info->linkBytes)
+                       .arg(info->transferTime)
+                       .arg(info->compressed ? ", compressed" : ""));
+
+    thumbnailList->blockSignals(true);
+    thumbnailList->setCurrentRow(index);
+    thumbnailList->blockSignals(false);
+}
+
+
+QImage ImageArchive::frameImage(int index) const{
+    QImage image(IMAGE_WIDTH, IMAGE_HEIGHT, QImage::Format_RGB32);
+    convertImageYCbCr422(store.frame(index), image, ColorModeRgb);
+    return image;
+}
+
+
+/*The icon follows in updateThumbnails() once the item comes close to the visible part*/
+void ImageArchive::addThumbnail(int index){
+    QListWidgetItem *item = new QListWidgetItem(QString::number(index + 1));
+    item->setSizeHint(QSize(THUMBNAIL_WIDTH + 10, THUMBNAIL_HEIGHT + 25));
+    thumbnailList->addItem(item);
+}
+
+
+/*Items are laid out left to right with a fixed size, the visible ones follow from the scroll position.
+ * Icons scrolled far away are dropped again, so only a window of them is held in memory.*/
+void ImageArchive::updateThumbnails(){
+    int count = thumbnailList->count();
+    if(count == 0)
+        return;
+    QRect firstRect = thumbnailList->visualItemRect(thumbnailList->item(0));
+    int step = (count > 1) ? thumbnailList->visualItemRect(thumbnailList->item(1)).left() - firstRect.left() : firstRect.width();
+    if(step <= 0)
+        return;
+    QRect area = thumbnailList->viewport()->rect();
+    int first = qBound(0, (area.left() - firstRect.left()) / step - THUMBNAIL_MARGIN, count - 1);
+    int last = qBound(0, (area.right() - firstRect.left()) / step + THUMBNAIL_MARGIN, count - 1);
+
+    for(int i = iconFirst; i <= qMin(iconLast, count - 1); i++){
+        if(i < first || i > last)
+            thumbnailList->item(i)->setIcon(QIcon());
+    }
+    for(int i = first; i <= last; i++){
+        QListWidgetItem *item = thumbnailList->item(i);
+        if(item->icon().isNull()){
+            QImage thumbnail = frameImage(i).scaled(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT, Qt::KeepAspectRatio);
+            item->setIcon(QIcon(QPixmap::fromImage(thumbnail)));
+        }
+    }
+    iconFirst = first;
+    iconLast = last;
+}
+
+
+void ImageArchive::resizeEvent(QResizeEvent *event){
+    QWidget::resizeEvent(event);
+    updateThumbnails();
+}
+
+
+void ImageArchive::onThumbnailRowChanged(int row){
+    if(row >= 0)
+        frameSlider->setValue(row);
+}
@@ -0,0 +1,51 @@
+#ifndef IMAGEARCHIVE_H
+#define IMAGEARCHIVE_H
+
+#include <QWidget>
+#include <QLabel>
+#include <QSlider>
+#include <QListWidget>
+#include <QImage>
+
+#include "framestore.h"
+#include "colorconversion.h"
+#include "imageview.h"
+
+/*Browser for every received camera frame, backed by the memory mapped FrameStore.
+ * Thumbnails are only created for the items around the visible part of the strip.*/
+class ImageArchive : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ImageArchive(QWidget *parent = 0);
+    bool open(const QString &fileName);
+    QString fileName() const;
+    void setMaxFrames(int maxFrames);
+
+public slots:
+    void addFrame(const QByteArray &rawImage, const FrameRecordInfo &info);
+    void showFrame(int index);
+
+private:
+    FrameStore store;
+    ImageView *imageView;
+    QLabel *infoLabel;
+    QSlider *frameSlider;
+    QListWidget *thumbnailList;
+    int iconFirst;                  /*items holding a thumbnail*/
+    int iconLast;
+    bool fullReported;
+
+    QImage frameImage(int index) const;
+    void addThumbnail(int index);
+
+protected:
+    void resizeEvent(QResizeEvent *event);
+
+private slots:
+    void onThumbnailRowChanged(int row);
+    void updateThumbnails();
+};
+
+#endif // IMAGEARCHIVE_H
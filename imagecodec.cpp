@@ -0,0 +1,197 @@
+#include "imagecodec.h"
+
+#include "stdint.h"
+
+#define CODEC_VERSION 1
+#define RICE_ESCAPE 24          /*unary prefixes this long are followed by the plain 8 bit value*/
+#define CONTEXT_RESET 64        /*halving interval of the adaptive statistics*/
+
+/*Adaptive Rice parameter per component (luma, chroma) as in LOCO-I*/
+struct RiceContext{
+    int sum;
+    int count;
+    RiceContext() : sum(4), count(1){}
+    int k() const{
+        int k = 0;
+        while((count << k) < sum && k < 7)
+            k++;
+        return k;
+    }
+    void update(int value){
+        sum += value;
+        if(++count >= CONTEXT_RESET){
+            sum >>= 1;
+            count >>= 1;
+        }
+    }
+};
+
+
+/*Median edge detector on the same component, line points to the current line of the raw image.
+ * Y repeats every 2 bytes, Cb and Cr every 4 bytes*/
+static inline int predict(const uint8_t *line, int i, int lineBytes, bool firstLine){
+    int step = (i & 1) ? 4 : 2;
+    bool hasLeft = i >= step;
+    if(firstLine)
+        return hasLeft ? line[i - step] : 128;
+    int above = line[i - lineBytes];
+    if(!hasLeft)
+        return above;
+    int left = line[i - step];
+    int aboveLeft = line[i - lineBytes - step];
+    int low = qMin(left, above);
+    int high = qMax(left, above);
+    if(aboveLeft >= high)
+        return low;
+    if(aboveLeft <= low)
+        return high;
+    return left + above - aboveLeft;
+}
+
+/*Residuals modulo 256 mapped to 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...*/
+static inline int zigzag(uint8_t residual){
+    int value = (int8_t) residual;
+    return value >= 0 ? 2 * value : -2 * value - 1;
+}
+
+static inline uint8_t unzigzag(int value){
+    return (uint8_t)((value & 1) ? -((value + 1) >> 1) : (value >> 1));
+}
+
+
+/*-----------*/
+/*Bit streams*/
+/*-----------*/
+
+struct BitWriter{
+    QByteArray &out;
+    uint32_t bits;
+    int count;
+    BitWriter(QByteArray &buffer) : out(buffer), bits(0), count(0){}
+    void write(uint32_t value, int length){
+        for(int i = length - 1; i >= 0; i--){
+            bits = (bits << 1) | ((value >> i) & 1);
+            if(++count == 8){
+                out.append((char) bits);
+                bits = 0;
+                count = 0;
+            }
+        }
+    }
+    void flush(){
+        if(count)
+            out.append((char)(bits << (8 - count)));
+        bits = 0;
+        count = 0;
+    }
+};
+
+struct BitReader{
+    const uint8_t *data;
+    int length;
+    int position;
+    BitReader(const uint8_t *buffer, int size) : data(buffer), length(size * 8), position(0){}
+    bool atEnd() const{
+        return position >= length;
+    }
+    bool overrun() const{
+        return position > length;
+    }
+    /*Less than a byte left and all of it zero, as the encoder pads*/
+    bool atPadding(){
+        if(length - position >= 8)
+            return false;
+        while(position < length){
+            if(read())
+                return false;
+        }
+        return true;
+    }
+    /*Past the end zeros are read and the overrun is remembered*/
+    int read(){
+        if(position >= length){
+            position = length + 1;
+            return 0;
+        }
+        int bit = (data[position >> 3] >> (7 - (position & 7))) & 1;
+        position++;
+        return bit;
+    }
+    int read(int count){
+        int value = 0;
+        for(int i = 0; i < count; i++)
+            value = (value << 1) | read();
+        return value;
+    }
+};
+
+
+/*-----------------*/
+/*Encoder / decoder*/
+/*-----------------*/
+
+QByteArray encodeImage(const QByteArray &raw, int width, int height){
+    int lineBytes = width * 2;
+    if(raw.size() != lineBytes * height)
+        return QByteArray();
+
+    const uint8_t *image = (const uint8_t*) raw.constData();
+    QByteArray packed;
+    packed.reserve(raw.size());
+    packed.append((char) CODEC_VERSION);
+
+    RiceContext contexts[2];
+    BitWriter writer(packed);
+    for(int line = 0; line < height; line++){
+        const uint8_t *current = image + line * lineBytes;
+        for(int i = 0; i < lineBytes; i++){
+            int value = zigzag((uint8_t)(current[i] - predict(current, i, lineBytes, line == 0)));
+            RiceContext &context = contexts[i & 1];
+            int k = context.k();
+            int quotient = value >> k;
+            if(quotient < RICE_ESCAPE){
+                writer.write((1u << (quotient + 1)) - 2, quotient + 1);     /*quotient ones and a zero*/
+                writer.write(value & ((1 << k) - 1), k);
+            }
+            else{
+                writer.write((1u << RICE_ESCAPE) - 1, RICE_ESCAPE);
+                writer.write(value, 8);
+            }
+            context.update(value);
+        }
+    }
+    writer.flush();
+    return packed.toBase64();
+}
+
+
+bool decodeImage(const QByteArray &encoded, QByteArray &raw, int width, int height){
+    int lineBytes = width * 2;
+    QByteArray packed = QByteArray::fromBase64(encoded);
+    if(packed.isEmpty() || packed.at(0) != CODEC_VERSION)
+        return false;
+
+    raw.resize(lineBytes * height);
+    uint8_t *image = (uint8_t*) raw.data();
+
+    RiceContext contexts[2];
+    BitReader reader((const uint8_t*) packed.constData() + 1, packed.size() - 1);
+    for(int line = 0; line < height; line++){
+        uint8_t *current = image + line * lineBytes;
+        for(int i = 0; i < lineBytes; i++){
+            if(reader.atEnd())
+                return false;
+            RiceContext &context = contexts[i & 1];
+            int k = context.k();
+            int quotient = 0;
+            while(quotient < RICE_ESCAPE && reader.read())
+                quotient++;
+            int value = (quotient < RICE_ESCAPE) ? ((quotient << k) | reader.read(k)) : reader.read(8);
+            if(value > 255)
+                return false;
+            current[i] = (uint8_t)(unzigzag(value) + predict(current, i, lineBytes, line == 0));
+            context.update(value);
+        }
+    }
+    return !reader.overrun() && reader.atPadding();
+}
@@ -0,0 +1,27 @@
+#ifndef IMAGECODEC_H
+#define IMAGECODEC_H
+
+#include <QByteArray>
+
+/*Lossless codec for the YCbCr 4:2:2 camera frames of the compressed downlink mode, LOCO-I style.
+ * Every byte is predicted from the same component (Y every 2 bytes, Cb and Cr every 4 bytes) by the
+ * median edge detector of left, above and above-left; the first line uses the left neighbour, the
+ * first pixel pair 128, the first pair of other lines the byte above.
+ * The residual modulo 256 is zigzag mapped (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) and Rice coded with
+ * parameter k: value >> k as that many 1 bits and a 0 bit, then the low k bits, MSB first.
+ * k is the smallest value with count << k >= sum, at most 7, from the running residual sum and count
+ * of its context (one for luma, one for both chroma components); both are halved every 64 values.
+ * A prefix of 24 1 bits without the 0 bit is an escape followed by the plain 8 bit value.
+ * Stream: one version byte (1), the bits of all lines in raster order, the last byte padded with 0 bits.
+ * The result is Base64 encoded, so it contains no & and can be framed like the other messages:
+ * "&CFRAME START<base64>CFRAME STOP&".
+ * The encoder is the reference for the satellite side and for loopback tests.*/
+
+/*raw has to hold width*height*2 bytes*/
+QByteArray encodeImage(const QByteArray &raw, int width, int height);
+
+/*Returns false if the data does not decode to exactly width*height*2 bytes,
+ * if it ends inside a code or if anything but the zero padding follows the last pixel*/
+bool decodeImage(const QByteArray &encoded, QByteArray &raw, int width, int height);
+
+#endif // IMAGECODEC_H
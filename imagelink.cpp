@@ -1,6 +1,6 @@
 #include "imagelink.h"
 
-Imagelink::Imagelink(QObject *parent) : QObject(parent), consoleText(""), currentImage(QImage(160, 121, QImage::Format_RGB32)), imageTransmitActive(false), portOpen(false){
+Imagelink::Imagelink(QObject *parent) : QObject(parent), currentImage(QImage(IMAGE_WIDTH, IMAGE_HEIGHT, QImage::Format_RGB32)), imageTransmitActive(false), frameDataStart(0), decodedLines(0), portOpen(false), colorMode(ColorModeRgb){
     bluetoothPort = new QSerialPort(this);
 }
 
@@ -9,80 +9,103 @@ void Imagelink::initializePort(){
     connect(bluetoothPort, SIGNAL(readyRead()), this, SLOT(readData()));
 
     /*Make internal list of available ports, all inactive*/
+    listMutex.lock();
     foreach (const QSerialPortInfo &info, QSerialPortInfo::availablePorts()){
         list.append(PortInfo(info.portName(), false));
     }
+    listMutex.unlock();
     emit updateStatus();
 }
 
 
-void Imagelink::openPort(){
-    QSerialPortInfo activePortInfo;
-    foreach (const QSerialPortInfo &info, QSerialPortInfo::availablePorts()){
-        if(activePortName == info.portName()){
-            activePortInfo = info;
-        }
-    }
-    if(activePortInfo.isNull()){
-        console("ERROR: No port selected or port could not be found.");
+/*Adds a port the system does not enumerate, call before initializePort()*/
+void Imagelink::addPort(const QString &portName){
+    QMutexLocker locker(&listMutex);
+    list.append(PortInfo(portName, false));
+}
+
+
+void Imagelink::openPort(const QString &portName){
+    activePortName = portName;
+    if(!selectPort(activePortName)){
+        console(LogError, MsgPortNotFound);
         return;
     }
-    bluetoothPort->setPort(activePortInfo);
     bluetoothPort->setBaudRate(BAUDRATE);
     bluetoothPort->setDataBits(DATABITS);
     bluetoothPort->setParity(PARITY);
     bluetoothPort->setStopBits(STOPBITS);
     bluetoothPort->setFlowControl(FLOWCONTROL);
     if(bluetoothPort->open(QIODevice::ReadWrite)){
-        console(QString("Port \"%1\" opened.").arg(activePortName));
+        console(LogInfo, MsgPortOpened, activePortName);
         portOpen = true;
         PortInfo activeInfo = PortInfo(activePortName, false);
 
         /*Search selected and opened port in list of available ports and set opened port to active*/
+        listMutex.lock();
         for(int i = 0; i < list.length(); i++){
             PortInfo listInfo = list.at(i);
             if(listInfo == activeInfo)
                 list.replace(i, PortInfo(activePortName, true));
         }
+        listMutex.unlock();
         emit updateStatus();
     }
     else
-        console(QString("ERROR: Port \"%1\" could not be opened.").arg(activePortName));
+        console(LogError, MsgPortOpenFailed, activePortName);
 }
 
 
-void Imagelink::closePort(){
-    QSerialPortInfo activePortInfo;
-    foreach (const QSerialPortInfo &info, QSerialPortInfo::availablePorts()){
-        if(activePortName == info.portName()){
-            activePortInfo = info;
-        }
-    }
-    if(activePortInfo.isNull()){
-        console("ERROR: No port selected or port could not be found.");
+void Imagelink::closePort(const QString &portName){
+    activePortName = portName;
+    if(!selectPort(activePortName)){
+        console(LogError, MsgPortNotFound);
         return;
     }
-    bluetoothPort->setPort(activePortInfo);
     bluetoothPort->close();
-    console(QString("Port \"%1\" closed.").arg(activePortInfo.portName()));
+    console(LogInfo, MsgPortClosed, activePortName);
     portOpen = false;
     PortInfo activeInfo = PortInfo(activePortName, true);
     /*Set port inactive in list of available ports*/
+    listMutex.lock();
     for(int i = 0; i < list.length(); i++){
         PortInfo listInfo = list.at(i);
         if(listInfo == activeInfo)
             list.replace(i, PortInfo(activePortName, false));
     }
+    listMutex.unlock();
     emit updateStatus();
 }
 
 
+/*Ports that are not enumerated, like the pseudo-terminal of the camera simulator, are used by their path*/
+bool Imagelink::selectPort(const QString &portName){
+    foreach (const QSerialPortInfo &info, QSerialPortInfo::availablePorts()){
+        if(portName == info.portName()){
+            bluetoothPort->setPort(info);
+            return true;
+        }
+    }
+    if(!QFile::exists(portName))
+        return false;
+    bluetoothPort->setPortName(portName);
+    return true;
+}
+
+
+/*Closing the port from within the worker thread, so the serial port notifiers are torn down where they live*/
+void Imagelink::shutdown(){
+    if(bluetoothPort->isOpen())
+        bluetoothPort->close();
+}
+
+
 /*Sending data (not used)*/
 void Imagelink::sendData(const QByteArray &command){
     bluetoothPort->write(command);
 }
 
-/*Sending commands (not used)*/
+/*Sending commands (not used), may be called from any thread*/
 void Imagelink::sendCommand(const Command &tc){
     QByteArray buffer(sizeof(Command), 0x00);
     memcpy(buffer.data(), (char*)&tc, sizeof(Command));
@@ -90,18 +113,47 @@ void Imagelink::sendCommand(const Command &tc){
 //    console(QString("ID: %1").arg(tc.id));
 //    console(QString("Identifier: %1").arg(tc.identifier));
 //    console(QString("Value: %1").arg(tc.value));
-    sendData(buffer);
+    QMetaObject::invokeMethod(this, "sendData", Qt::QueuedConnection, Q_ARG(QByteArray, buffer));
 }
 
 
 /*Reading out port*/
 void Imagelink::readData(){
     QByteArray data = bluetoothPort->readAll();
+    if(imageBuffer.isEmpty())
+        messageTimer.start();
+    int searchFrom = qMax(0, imageBuffer.length() - 11);
     imageBuffer.append(data);
-    /*all used flags are designed as "&<start flag>DATA<end flag>&"*/
-    if(data.endsWith("&")){
+    /*all used flags are designed as "&<start flag>DATA<end flag>&", every end flag ends with "STOP&".
+     * A read may end on the & of a start flag, that is no reason to evaluate yet.*/
+    if(imageBuffer.endsWith("STOP&")){
         evaluateBuffer();
+        return;
+    }
+    readImageProgress(searchFrom);
+}
+
+
+/*Decode every completed scanline while a frame is still being received.
+ * A new start flag means the previous frame was cut short, the image starts over behind it.*/
+void Imagelink::readImageProgress(int searchFrom){
+    if(imageTransmitActive)
+        searchFrom = qMax(searchFrom, frameDataStart);
+    int start = imageBuffer.indexOf("&FRAME START", searchFrom);
+    while(start >= 0){
+        startImage();
+        frameDataStart = start + 12;
+        start = imageBuffer.indexOf("&FRAME START", frameDataStart);
     }
+    if(!imageTransmitActive)
+        return;
+
+    int lines = qMin((imageBuffer.length() - frameDataStart) / IMAGE_LINE_DIGITS, IMAGE_HEIGHT);
+    if(lines <= decodedLines)
+        return;
+    int firstLine = decodedLines;
+    readImageLines(imageBuffer.constData() + frameDataStart, lines);
+    emit updateImageLines(currentImage, firstLine, lines - 1);
 }
 
 
@@ -109,6 +161,9 @@ void Imagelink::readData(){
 void Imagelink::evaluateBuffer(){
     /*Remove everything before flag and the & at flag beginning to get rid of some error messages*/
     int x = imageBuffer.lastIndexOf("&", imageBuffer.length()-2);
+
+    /*Lines shown during the transmission are only kept if they belong to this very frame*/
+    bool progressValid = imageTransmitActive && frameDataStart == x + 12;
     imageBuffer.remove(0, x+1);
 
     /*Remove last & char*/
@@ -118,11 +173,25 @@ void Imagelink::evaluateBuffer(){
     /*Start flag "&FRAME START", end flag "FRAME STOP&"*/
     /*& chars already removed*/
     if((imageBuffer.startsWith("FRAME START")) && (imageBuffer.endsWith("FRAME STOP"))){
-        console("Image received.");
+        console(LogInfo, MsgImageReceived);
         /*Remove rest of flags*/
         imageBuffer.remove(0, 11);
         imageBuffer.remove(imageBuffer.length()-10, 10);
-        readImage();
+        readImage(progressValid);
+        endMessage();
+        return;
+    }
+
+    /*Check whether it's a compressed image*/
+    /*Start flag "&CFRAME START", end flag "CFRAME STOP&"*/
+    /*& chars already removed*/
+    if((imageBuffer.startsWith("CFRAME START")) && (imageBuffer.endsWith("CFRAME STOP"))){
+        console(LogInfo, MsgCompressedImageReceived, imageBuffer.length());
+        /*Remove rest of flags*/
+        imageBuffer.remove(0, 12);
+        imageBuffer.remove(imageBuffer.length()-11, 11);
+        readCompressedImage();
+        endMessage();
         return;
     }
 
@@ -133,140 +202,141 @@ void Imagelink::evaluateBuffer(){
         /*Remove rest of flags*/
         imageBuffer.remove(0, 13);
         imageBuffer.remove(imageBuffer.length()-12, 12);
-        console(imageBuffer);
-        imageBuffer.clear();
+        console(LogInfo, MsgText, QString::fromLatin1(imageBuffer));
+        endMessage();
         return;
     }
-    console("Bluetooth message dropped due to incomplete flags.");
-    imageBuffer.clear();
+    console(LogWarning, MsgBluetoothMessageDropped);
+    endMessage();
 }
 
 
-void Imagelink::readImage(){
-    /*Readings from saved imageBuffer file*/
-//    QFile file("D:\\SPACEMASTER\\SFPICS\\new_picture.txt");
-//    file.open(QIODevice::ReadOnly);
-//    imageBuffer = file.readAll();
-//    file.close();
+/*Whatever the message was, the next one starts from scratch*/
+void Imagelink::endMessage(){
+    imageBuffer.clear();
+    imageTransmitActive = false;
+    frameDataStart = 0;
+    decodedLines = 0;
+}
 
-    /*Save imageBuffer in file for later tests*/
-//    int i = QDateTime::currentDateTime().toMSecsSinceEpoch();
-//    QFile file2(QString("D:\\SPACEMASTER\\SFPICS\\image_%1.txt").arg(abs(i)));
-//    file2.open(QIODevice::WriteOnly);
-//    file2.write(imageBuffer);
-//    file2.close();
 
+void Imagelink::readImage(bool progressValid){
     /*Check length*/
     if(imageBuffer.length() != IMAGE_PIXELS*2*3){
-        console("ERROR: Received image package size does not fit required size.");
-        imageBuffer.clear();
+        console(LogError, MsgImageSizeInvalid);
         return;
     }
 
-    /*Extract linear uint8-array out of data*/
-    QByteArray buffer(3,0x00);
-    uint8_t orig[IMAGE_PIXELS*2];
-    for(int i = 0; i<(IMAGE_PIXELS*2); i++){
-        buffer[0] = (imageBuffer.at(3*i));
-        buffer[1] = (imageBuffer.at(3*i+1));
-        buffer[2] = (imageBuffer.at(3*i+2));
-        orig[i] = (uint8_t) buffer.toInt();
-    }
+    /*Lines already shown during the transmission are not decoded again*/
+    if(!progressValid)
+        startImage();
+    readImageLines(imageBuffer.constData(), IMAGE_HEIGHT);
+
+    /*Update image, the receivers get implicitly shared copies*/
+    emit updateImage(currentImage);
+    emit imageReceived(rawImage, imageInfo(IMAGE_PIXELS*2*3 + 23, false));
+}
+
+
+/*Start a fresh image, the previous one may still be shared with the UI*/
+void Imagelink::startImage(){
+    imageTransmitActive = true;
+    decodedLines = 0;
+    frameDataStart = 0;
+    rawImage.fill(0x00, IMAGE_PIXELS*2);
+    currentImage = QImage(IMAGE_WIDTH, IMAGE_HEIGHT, QImage::Format_RGB32);
+    currentImage.fill(Qt::black);
+}
+
 
+/*Compressed images arrive as a whole, see imagecodec.h*/
+void Imagelink::readCompressedImage(){
+    startImage();
+    bool valid = decodeImage(imageBuffer, rawImage, IMAGE_WIDTH, IMAGE_HEIGHT);
+    int linkBytes = imageBuffer.length() + 25;
     imageBuffer.clear();
+    if(!valid){
+        console(LogError, MsgCompressedImageInvalid);
+        return;
+    }
+    convertImageLines(0, IMAGE_HEIGHT);
+    emit updateImage(currentImage);
+    emit imageReceived(rawImage, imageInfo(linkBytes, true));
+}
+
+
+/*Receive statistics of the message just evaluated, linkBytes includes the flags*/
+FrameRecordInfo Imagelink::imageInfo(int linkBytes, bool compressed){
+    FrameRecordInfo info;
+    info.receiveTime = QDateTime::currentMSecsSinceEpoch();
+    info.transferTime = messageTimer.elapsed();
+    info.linkBytes = linkBytes;
+    info.compressed = compressed;
+    return info;
+}
+
 
-    /*Initialize RGB/Grayscale image*/
-    QImage rgb(IMAGE_WIDTH, IMAGE_HEIGHT, QImage::Format_RGB32);
-    uint8_t y1 = 0;
-    uint8_t y2 = 0;
-//    uint8_t cb = 0;
-//    uint8_t cr = 0;
-
-    /*Combine to RGB-/Grayscale image*/
-    for(int line = 0; line < IMAGE_HEIGHT; line++){
-        for(int column = 0; column < IMAGE_WIDTH; column +=2){
-            y1   = orig[IMAGE_WIDTH*2*line + 2*column + 0];
-//            cb  = orig[IMAGE_WIDTH*2*line + 2*column + 1];
-            y2   = orig[IMAGE_WIDTH*2*line + 2*column + 2];
-//            cr  = orig[IMAGE_WIDTH*2*line + 2*column + 3];
-
-            /*RGB (doesn't work for whatever reason)*/
-//            rgb.setPixel(column, line, getRgbValue(y1, cb, cr));
-//            rgb.setPixel(column+1, line, getRgbValue(y2, cb, cr));
-
-            /*Grayscale (works fine)*/
-            rgb.setPixel(column, line, qRgb(y1, y1, y1));
-            rgb.setPixel(column+1, line, qRgb(y2, y2, y2));
+/*Extract lines [decodedLines, lines) out of data and convert them straight into the scanlines of the RGB/Grayscale image*/
+void Imagelink::readImageLines(const char *digits, int lines){
+    for(int line = decodedLines; line < lines; line++){
+        /*Every byte is sent as three decimal digits*/
+        uint8_t *raw = (uint8_t*) rawImage.data() + line * IMAGE_WIDTH * 2;
+        const char *lineDigits = digits + line * IMAGE_LINE_DIGITS;
+        for(int i = 0; i < IMAGE_WIDTH * 2; i++){
+            raw[i] = decimalToByte(lineDigits + 3*i);
         }
     }
-
-    /*Sven's grayscale picture (working)*/
-//    QByteArray buffer(3,0x00);
-//    uint8_t orig[IMAGE_WIDTH][IMAGE_HEIGHT];
-//    for(int lines = 0; lines<121; lines++){
-//        for(int columns = 0; columns<160 ; columns++){
-//            buffer[0] = (imageBuffer.at(4*columns+642*lines));
-//            buffer[1] = (imageBuffer.at(4*columns+642*lines+1));
-//            buffer[2] = (imageBuffer.at(4*columns+642*lines+2));
-//            orig[columns][lines] = (uint8_t) buffer.toInt();
-//            console(buffer);
-//        }
-//    }
-//    for(int i = 0; i<256; i++){
-//        QRgb value = qRgb(i,i,i);
-//        rgb.setColor(i, value);
-//    }
-//    for(int line = 0; line < IMAGE_HEIGHT; line++){
-//        for(int column = 0; column < IMAGE_WIDTH; column++){
-//            y   = orig[column][line];
-//            rgb.setPixel(column, line, y);
-
-//        }
-//    }
-
-    /*Update image*/
-    currentImage = rgb;
-    emit updateImage();
+    convertImageLines(decodedLines, lines);
+    decodedLines = qMax(decodedLines, lines);
 }
 
 
-/*-------------------------------------------*/
-/*YCbCr-RGB conversions. None really working */
-/*-------------------------------------------*/
+/*Convert YCbCr 4:2:2 lines [first, last) of rawImage to RGB or grayscale*/
+void Imagelink::convertImageLines(int first, int last){
+    ColorMode mode = (ColorMode) colorMode.load();
+    for(int line = first; line < last; line++){
+        const uint8_t *raw = (const uint8_t*) rawImage.constData() + line * IMAGE_WIDTH * 2;
+        QRgb *pixels = (QRgb*) currentImage.scanLine(line);
+        if(mode == ColorModeGrayscale)
+            convertLineGrayscale(raw, pixels, IMAGE_WIDTH);
+        else
+            convertLineYCbCr422(raw, pixels, IMAGE_WIDTH);
+    }
+}
+
 
-/*Wikipedia JPEG convention*/
-//QRgb Imagelink::getRgbValue(uint8_t y, uint8_t cb, uint8_t cr){
-//    uint32_t r = (uint32_t) y + 1.402 * ((uint32_t) cr - 128);
-//    uint32_t g = (uint32_t) y - 0.34414 * ((uint32_t) cb - 128) - 0.71414 * ((uint32_t) cr - 128);
-//    uint32_t b = (uint32_t) y + 1.772 * ((uint32_t) cb - 128);
-//    return qRgb(r, g, b);
-//}
+/*Parse three ASCII characters like QByteArray::toInt() does, padding blanks are skipped*/
+uint8_t Imagelink::decimalToByte(const char *digits){
+    int value = 0;
+    for(int i = 0; i < 3; i++){
+        if(digits[i] >= '0' && digits[i] <= '9')
+            value = value * 10 + (digits[i] - '0');
+    }
+    return (uint8_t) value;
+}
 
 
-/*Wikipedia some other convention*/
-QRgb Imagelink::getRgbValue(uint8_t y, uint8_t cb, uint8_t cr){
-    uint32_t r = (uint32_t) (255/219)*(y-16) + (255/112)*0.701* ((uint32_t) cr - 128);
-    uint32_t g = (uint32_t) (255/219)*(y-16) - (255/112)*0.886*(0.114/0.587)*(cb-128) - (255/112)*0.701* (0.299/0.587)*((uint32_t) cr - 128);
-    uint32_t b = (uint32_t) (255/219)*(y-16) + (255/112)*0.886*(cb-128) ;
-    return qRgb(r, g, b);
+void Imagelink::setColorMode(ColorMode mode){
+    colorMode.store(mode);
 }
 
 
 /*Printing text into console*/
-void Imagelink::console(QString msg){
-    consoleText = msg;
-    emit updateConsole();
+void Imagelink::console(LogLevel level, LogMessageId id, const LogArg &arg1){
+    Logger::post(level, LogImagelink, id, arg1);
 }
 
 
-bool Imagelink::isOpen(){
-    PortInfo activeInfo = PortInfo(activePortName, false);
+bool Imagelink::isOpen(const QString &portName){
+    PortInfo activeInfo = PortInfo(portName, false);
+    QMutexLocker locker(&listMutex);
     for(int i = 0; i < list.length(); i++){
         PortInfo listInfo = list.at(i);
         if(listInfo == activeInfo)
             return listInfo.isOpen;
     }
-    console("ERROR: Port problem.");
+    locker.unlock();
+    console(LogError, MsgPortProblem);
     return 0;
 }
 
@@ -10,10 +10,17 @@
 #include <QFile>
 #include <QColor>
 #include <QDateTime>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
 
 #include "stdint.h"
 
 #include "payload.h"
+#include "colorconversion.h"
+#include "imagecodec.h"
+#include "framestore.h"
+#include "logger.h"
 
 #define LOCAL_COMPORT "COM3"
 #define BAUDRATE 921600
@@ -25,6 +32,7 @@
 #define IMAGE_WIDTH 160
 #define IMAGE_HEIGHT 121
 #define IMAGE_PIXELS IMAGE_WIDTH*IMAGE_HEIGHT
+#define IMAGE_LINE_DIGITS (IMAGE_WIDTH*2*3)     /*one scanline as sent over the link*/
 
 struct PortInfo{
     QString portName;
@@ -38,34 +46,53 @@ class Imagelink : public QObject
     Q_OBJECT
 
 public:
-    QString activePortName;
-    QString consoleText;
-    QImage currentImage;
-
     explicit Imagelink(QObject *parent = 0);
+    void sendCommand(const Command &tc);
+    bool isOpen(const QString &portName);
+    void addPort(const QString &portName);
+    void setColorMode(ColorMode mode);
+
+/*Slots run in the thread Imagelink lives in, call them queued from other threads*/
+public slots:
     void initializePort();
-    void openPort();
-    void closePort();
+    void openPort(const QString &portName);
+    void closePort(const QString &portName);
+    void shutdown();
     void sendData(const QByteArray &command);
-    void sendCommand(const Command &tc);
-    bool isOpen();
 
 signals:
-    void updateConsole();
-    void updateImage();
+    void updateImage(const QImage &image);
+    void updateImageLines(const QImage &image, int firstLine, int lastLine);   /*partial image, lines up to lastLine are valid, the rest is cleared*/
     void updateStatus();
+    void imageReceived(const QByteArray &rawImage, const FrameRecordInfo &info);     /*YCbCr 4:2:2 bytes of every complete image*/
 
 private:
     QSerialPort *bluetoothPort;
+    QString activePortName;
+    QImage currentImage;
     QByteArray imageBuffer;
+    QByteArray rawImage;        /*YCbCr 4:2:2 bytes of currentImage*/
     bool imageTransmitActive;
+    int frameDataStart;         /*first pixel digit in imageBuffer while imageTransmitActive*/
+    int decodedLines;
+    QElapsedTimer messageTimer; /*started with the first byte of a message*/
     bool portOpen;
+    QAtomicInt colorMode;
     QList<PortInfo> list;
+    QMutex listMutex;       /*list is read by the GUI thread through isOpen()*/
 
-    void console(QString msg);
-    QRgb getRgbValue(uint8_t y, uint8_t cb, uint8_t cr);
+    void console(LogLevel level, LogMessageId id, const LogArg &arg1 = LogArg());
+    bool selectPort(const QString &portName);
     void evaluateBuffer();
-    void readImage();
+    void endMessage();
+    void readImage(bool progressValid);
+    void readImageProgress(int searchFrom);
+    void startImage();
+    void readImageLines(const char *digits, int lines);
+    void readCompressedImage();
+    void convertImageLines(int first, int last);
+    FrameRecordInfo imageInfo(int linkBytes, bool compressed);
+    static uint8_t decimalToByte(const char *digits);
 
 private slots:
     void readData();
@@ -0,0 +1,133 @@
+#include "imageview.h"
+
+#include <QPainter>
+#include <QMenu>
+#include <QContextMenuEvent>
+
+ImageView::ImageView(QWidget *parent) : QWidget(parent), dirtyFirstLine(0), dirtyLastLine(-1), mode(BilinearScaling){
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+
+void ImageView::setScalingMode(ScalingMode scaling){
+    mode = scaling;
+    update();
+}
+
+ImageView::ScalingMode ImageView::scalingMode() const{
+    return mode;
+}
+
+
+/*Whole new image*/
+void ImageView::setImage(const QImage &newImage){
+    updateImageLines(newImage, 0, newImage.height() - 1);
+}
+
+
+/*Only lines [firstLine, lastLine] changed since the last image.
+ * Updates starting at line 0 begin a new frame, the lines below still show the previous one
+ * and are replaced by the rest of the new image as well.*/
+void ImageView::updateImageLines(const QImage &newImage, int firstLine, int lastLine){
+    bool resized = newImage.size() != image.size();
+    image = newImage;
+    if(firstLine == 0)
+        lastLine = image.height() - 1;
+    if(resized){
+        texture = QPixmap();
+        firstLine = 0;
+        lastLine = image.height() - 1;
+        updateTarget();
+        update();
+    }
+    else{
+        update(targetLines(firstLine, lastLine));
+    }
+    if(dirtyFirstLine > dirtyLastLine){
+        dirtyFirstLine = firstLine;
+        dirtyLastLine = lastLine;
+    }
+    else{
+        dirtyFirstLine = qMin(dirtyFirstLine, firstLine);
+        dirtyLastLine = qMax(dirtyLastLine, lastLine);
+    }
+}
+
+
+void ImageView::clear(){
+    image = QImage();
+    texture = QPixmap();
+    dirtyFirstLine = 0;
+    dirtyLastLine = -1;
+    updateTarget();
+    update();
+}
+
+
+void ImageView::paintEvent(QPaintEvent *){
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().window());
+    if(image.isNull())
+        return;
+
+    /*Upload the changed lines into the native size pixmap, the allocation is reused*/
+    if(texture.isNull()){
+        texture = QPixmap::fromImage(image);
+    }
+    else if(dirtyFirstLine <= dirtyLastLine){
+        QRect lines(0, dirtyFirstLine, image.width(), dirtyLastLine - dirtyFirstLine + 1);
+        QPainter upload(&texture);
+        upload.setCompositionMode(QPainter::CompositionMode_Source);
+        upload.drawImage(lines, image, lines);
+    }
+    dirtyFirstLine = 0;
+    dirtyLastLine = -1;
+
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, mode == BilinearScaling);
+    painter.drawPixmap(target, texture);
+}
+
+
+/*The scaled geometry only changes with the widget size*/
+void ImageView::resizeEvent(QResizeEvent *event){
+    QWidget::resizeEvent(event);
+    updateTarget();
+}
+
+
+void ImageView::contextMenuEvent(QContextMenuEvent *event){
+    QMenu menu(this);
+    QAction *nearest = menu.addAction("Nearest neighbour scaling");
+    QAction *bilinear = menu.addAction("Bilinear scaling");
+    nearest->setCheckable(true);
+    bilinear->setCheckable(true);
+    nearest->setChecked(mode == NearestScaling);
+    bilinear->setChecked(mode == BilinearScaling);
+    QAction *chosen = menu.exec(event->globalPos());
+    if(chosen == nearest)
+        setScalingMode(NearestScaling);
+    else if(chosen == bilinear)
+        setScalingMode(BilinearScaling);
+}
+
+
+/*Largest centered rectangle with the aspect ratio of the image*/
+void ImageView::updateTarget(){
+    if(image.isNull()){
+        target = QRect();
+        return;
+    }
+    QSize size = image.size().scaled(this->size(), Qt::KeepAspectRatio);
+    target = QRect(QPoint((width() - size.width()) / 2, (height() - size.height()) / 2), size);
+}
+
+
+/*Widget area covered by image lines [firstLine, lastLine]*/
+QRect ImageView::targetLines(int firstLine, int lastLine) const{
+    if(image.isNull() || target.isEmpty())
+        return QRect();
+    double scale = (double) target.height() / image.height();
+    int top = target.top() + (int)(firstLine * scale) - 1;
+    int bottom = target.top() + (int)((lastLine + 1) * scale + 1);
+    return QRect(target.left(), top, target.width(), bottom - top).intersected(target);
+}
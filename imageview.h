@@ -0,0 +1,47 @@
+#ifndef IMAGEVIEW_H
+#define IMAGEVIEW_H
+
+#include <QWidget>
+#include <QImage>
+#include <QPixmap>
+
+/*Displays an image scaled to the widget with kept aspect ratio.
+ * The image is kept at its native size as a pixmap, only changed lines are uploaded
+ * and the scaling is done while painting.*/
+class ImageView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum ScalingMode{
+        NearestScaling,
+        BilinearScaling
+    };
+
+    explicit ImageView(QWidget *parent = 0);
+    void setScalingMode(ScalingMode mode);
+    ScalingMode scalingMode() const;
+
+public slots:
+    void setImage(const QImage &image);
+    void updateImageLines(const QImage &image, int firstLine, int lastLine);
+    void clear();
+
+protected:
+    void paintEvent(QPaintEvent *event) Q_DECL_OVERRIDE;
+    void resizeEvent(QResizeEvent *event) Q_DECL_OVERRIDE;
+    void contextMenuEvent(QContextMenuEvent *event) Q_DECL_OVERRIDE;
+
+private:
+    QImage image;
+    QPixmap texture;
+    int dirtyFirstLine;     /*lines of image not yet in texture, first > last if none*/
+    int dirtyLastLine;
+    QRect target;
+    ScalingMode mode;
+
+    void updateTarget();
+    QRect targetLines(int firstLine, int lastLine) const;
+};
+
+#endif // IMAGEVIEW_H
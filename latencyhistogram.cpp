@@ -0,0 +1,122 @@
+#include "latencyhistogram.h"
+
+#include <QtAlgorithms>
+#include <math.h>
+
+#define SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define HALF_SUB_BUCKETS (SUB_BUCKETS / 2)
+#define BUCKET_COUNT (SUB_BUCKETS + (LATENCY_MAX_MAGNITUDE - LATENCY_SUB_BUCKET_BITS + 1) * HALF_SUB_BUCKETS)
+
+LatencyHistogram::LatencyHistogram() : counts(BUCKET_COUNT, 0){
+    reset();
+}
+
+
+void LatencyHistogram::reset(){
+    counts.fill(0);
+    totalCount = 0;
+    minValue = 0;
+    maxValue = 0;
+    sum = 0;
+}
+
+
+/*Position of the highest set bit, value must not be 0*/
+static inline int highestBit(quint64 value){
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#elif QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    return 63 - (int) qCountLeadingZeroBits(value);
+#else
+    int bit = 0;
+    while(value >>= 1)
+        bit++;
+    return bit;
+#endif
+}
+
+
+/*Values below SUB_BUCKETS are exact, above every power of two is split into HALF_SUB_BUCKETS*/
+int LatencyHistogram::bucketIndex(qint64 value){
+    if(value < SUB_BUCKETS)
+        return (int) value;
+    int magnitude = highestBit((quint64) value) - (LATENCY_SUB_BUCKET_BITS - 1);
+    int index = SUB_BUCKETS + (magnitude - 1) * HALF_SUB_BUCKETS + (int)(value >> magnitude) - HALF_SUB_BUCKETS;
+    return qMin(index, BUCKET_COUNT - 1);
+}
+
+qint64 LatencyHistogram::bucketValue(int index){
+    if(index < SUB_BUCKETS)
+        return index;
+    int magnitude = (index - SUB_BUCKETS) / HALF_SUB_BUCKETS + 1;
+    qint64 sub = (index - SUB_BUCKETS) % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+    return ((sub + 1) << magnitude) - 1;
+}
+
+
+void LatencyHistogram::record(qint64 nanoseconds){
+    qint64 value = qMax((qint64) 0, nanoseconds / 1000);
+    counts[bucketIndex(value)]++;
+    if(!totalCount || value < minValue)
+        minValue = value;
+    if(value > maxValue)
+        maxValue = value;
+    totalCount++;
+    sum += value;
+}
+
+
+quint64 LatencyHistogram::count() const{
+    return totalCount;
+}
+
+qint64 LatencyHistogram::min() const{
+    return minValue;
+}
+
+qint64 LatencyHistogram::max() const{
+    return maxValue;
+}
+
+double LatencyHistogram::mean() const{
+    return totalCount ? sum / totalCount : 0;
+}
+
+
+qint64 LatencyHistogram::percentile(double p) const{
+    if(!totalCount)
+        return 0;
+    quint64 rank = qMax((quint64) 1, (quint64)(p / 100 * totalCount + 0.5));
+    quint64 seen = 0;
+    for(int i = 0; i < counts.size(); i++){
+        seen += counts.at(i);
+        if(seen >= rank)
+            return qBound(minValue, bucketValue(i), maxValue);
+    }
+    return maxValue;
+}
+
+
+/*Five lines per halving of the distance to 100%, like HdrHistogram does*/
+void LatencyHistogram::writePercentiles(QTextStream &out) const{
+    out << "       Value     Percentile TotalCount 1/(1-Percentile)\n\n";
+    quint64 seen = 0;
+    double nextPercentile = 0;
+    for(int i = 0; i < counts.size() && totalCount; i++){
+        if(!counts.at(i))
+            continue;
+        seen += counts.at(i);
+        while(100.0 * seen / totalCount >= nextPercentile && seen < totalCount){
+            out << QString("%1 %2 %3 %4\n")
+                   .arg(qBound(minValue, bucketValue(i), maxValue) / 1000.0, 12, 'f', 3)
+                   .arg(nextPercentile / 100, 14, 'f', 12)
+                   .arg(seen, 10)
+                   .arg(1 / (1 - nextPercentile / 100), 14, 'f', 2);
+            double halvings = floor(log(100 / (100 - nextPercentile)) / log(2.0));
+            nextPercentile += 100 / (pow(2, halvings + 1) * 5);
+        }
+    }
+    out << QString("%1 %2 %3\n").arg(maxValue / 1000.0, 12, 'f', 3).arg(1.0, 14, 'f', 12).arg(totalCount, 10);
+    out << QString("#[Mean    = %1, Max = %2 (ms)]\n").arg(mean() / 1000.0, 0, 'f', 3).arg(maxValue / 1000.0, 0, 'f', 3);
+    out << QString("#[Total count    = %1]\n").arg(totalCount);
+}
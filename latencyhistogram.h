@@ -0,0 +1,40 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <QTextStream>
+
+#define LATENCY_SUB_BUCKET_BITS 7       /*128 sub buckets, values are kept within 1/64 = 1.6%*/
+#define LATENCY_MAX_MAGNITUDE 36        /*us, about 19 hours*/
+
+/*Histogram with logarithmic buckets of linear sub buckets (HdrHistogram layout).
+ * Values are recorded in us, recording is a few shifts and one increment.*/
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+    void record(qint64 nanoseconds);
+    void reset();
+
+    quint64 count() const;
+    qint64 min() const;                 /*us*/
+    qint64 max() const;                 /*us*/
+    double mean() const;                /*us*/
+    qint64 percentile(double p) const;  /*us, p in [0, 100]*/
+
+    /*Percentile distribution in the text format of HdrHistogram (.hgrm)*/
+    void writePercentiles(QTextStream &out) const;
+
+private:
+    QVector<quint64> counts;
+    quint64 totalCount;
+    qint64 minValue;
+    qint64 maxValue;
+    double sum;
+
+    static int bucketIndex(qint64 value);
+    static qint64 bucketValue(int index);   /*highest value of the bucket*/
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,78 @@
+#include "latencymonitor.h"
+#include "clocksync.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+
+LatencyMonitor::LatencyMonitor() : packetPending(false), sampleTime(0), decodeTime(0), replotTime(0){
+}
+
+
+/*First three stages are known as soon as the payload struct is decoded*/
+void LatencyMonitor::decoded(const PayloadSatellite &payload){
+    decodeTime = groundTime();
+    sampleTime = payload.sampleTime;
+    replotTime = 0;
+    packetPending = true;
+    histograms[LatencyNetwork].record(payload.receiveTime - payload.sampleTime);
+    histograms[LatencyQueue].record(payload.dequeueTime - payload.receiveTime);
+    histograms[LatencyDecode].record(decodeTime - payload.dequeueTime);
+}
+
+
+/*Connected to afterReplot of the plots, a packet may replot several of them*/
+void LatencyMonitor::replotted(){
+    if(packetPending)
+        replotTime = groundTime();
+}
+
+
+/*Packets without a plot only count for the first stages*/
+void LatencyMonitor::finished(){
+    if(packetPending && replotTime){
+        histograms[LatencyRender].record(replotTime - decodeTime);
+        histograms[LatencyTotal].record(replotTime - sampleTime);
+    }
+    packetPending = false;
+}
+
+
+void LatencyMonitor::reset(){
+    for(int i = 0; i < LatencyStageCount; i++){
+        histograms[i].reset();
+    }
+}
+
+
+const LatencyHistogram &LatencyMonitor::histogram(LatencyStage stage) const{
+    return histograms[stage];
+}
+
+
+/*One percentile distribution per stage, values in ms*/
+bool LatencyMonitor::exportTo(const QString &fileName) const{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+    QTextStream out(&file);
+    out << "# Telemetry latency, " << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n";
+    for(int i = 0; i < LatencyStageCount; i++){
+        out << "\n# Stage: " << stageName((LatencyStage) i) << "\n";
+        histograms[i].writePercentiles(out);
+    }
+    return out.status() == QTextStream::Ok;
+}
+
+
+const char *LatencyMonitor::stageName(LatencyStage stage){
+    switch(stage){
+    case LatencyNetwork:    return "Network";
+    case LatencyQueue:      return "Queue";
+    case LatencyDecode:     return "Decode";
+    case LatencyRender:     return "Render";
+    case LatencyTotal:      return "Total";
+    default:                break;
+    }
+    return "";
+}
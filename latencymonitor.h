@@ -0,0 +1,42 @@
+#ifndef LATENCYMONITOR_H
+#define LATENCYMONITOR_H
+
+#include <QString>
+
+#include "payload.h"
+#include "latencyhistogram.h"
+
+/*Stages of a telemetry packet from publishing on board to pixels on screen*/
+enum LatencyStage{
+    LatencyNetwork,     /*on-board timestamp -> socket receive, above the fastest packet*/
+    LatencyQueue,       /*socket receive -> Connection::read*/
+    LatencyDecode,      /*Connection::read -> payload struct decoded*/
+    LatencyRender,      /*decoded -> last afterReplot of the packet*/
+    LatencyTotal,       /*on-board timestamp -> last afterReplot*/
+    LatencyStageCount
+};
+
+/*Per stage latency histograms, fed from the GUI thread while packets are displayed*/
+class LatencyMonitor
+{
+public:
+    LatencyMonitor();
+    void decoded(const PayloadSatellite &payload);
+    void replotted();
+    void finished();
+    void reset();
+
+    const LatencyHistogram &histogram(LatencyStage stage) const;
+    bool exportTo(const QString &fileName) const;
+
+    static const char *stageName(LatencyStage stage);
+
+private:
+    LatencyHistogram histograms[LatencyStageCount];
+    bool packetPending;
+    qint64 sampleTime;
+    qint64 decodeTime;
+    qint64 replotTime;
+};
+
+#endif // LATENCYMONITOR_H
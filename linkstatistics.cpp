@@ -0,0 +1,227 @@
+#include "linkstatistics.h"
+
+#include <math.h>
+
+LinkStatistics::Topic::Topic() : received(0), lost(0), reordered(0), duplicates(0), lateDrops(0), jitter(0), period(0), resetRequested(0){
+    clearTracking();
+}
+
+void LinkStatistics::Topic::clearTracking(){
+    started = false;
+    lastCounter = 0;
+    sequenceMask = 0;
+    lastTimestamp = 0;
+    lastTransit = 0;
+    jitterEstimate = 0;
+    periodEstimate = 0;
+    historyPosition = 0;
+    for(int i = 0; i < LINK_DUPLICATE_HISTORY; i++){
+        history[i] = 0;
+    }
+    gapPosition = 0;
+    for(int i = 0; i < LINK_GAP_HISTORY; i++){
+        gaps[i].start = gaps[i].end = 0;
+        gaps[i].missing = 0;
+    }
+}
+
+
+LinkStatistics::LinkStatistics(){
+}
+
+LinkStatistics::~LinkStatistics(){
+    qDeleteAll(topics);
+}
+
+
+void LinkStatistics::addTopic(quint32 topic){
+    if(topics.contains(topic))
+        return;
+    topics.insert(topic, new Topic());
+    topicOrder.append(topic);
+}
+
+
+void LinkStatistics::packetReceived(const PayloadSatellite &payload){
+    Topic *state = topics.value(payload.topic);
+    if(!state)
+        return;
+    if(state->resetRequested.fetchAndStoreAcquire(0))
+        state->clearTracking();
+
+    state->received.fetchAndAddRelaxed(1);
+    if(payload.topic == PayloadCounterType)
+        trackSequence(state, PayloadCounter(payload).counter);
+    else
+        trackTimestamp(state, payload.timestamp);
+    trackJitter(state, payload);
+    state->started = true;
+}
+
+
+void LinkStatistics::lateDrop(quint32 topic){
+    Topic *state = topics.value(topic);
+    if(state)
+        state->lateDrops.fetchAndAddRelaxed(1);
+}
+
+
+/*Counter topic: every missing sequence number is a lost packet.
+ * A late packet only takes back a loss if its number is one of the gaps counted before,
+ * numbers already received are duplicates. Beyond LINK_SEQUENCE_WINDOW it is only counted as reordered.*/
+void LinkStatistics::trackSequence(Topic *state, qint32 counter){
+    if(!state->started){
+        state->lastCounter = counter;
+        state->sequenceMask = 1;
+        return;
+    }
+    qint32 step = counter - state->lastCounter;
+    if(step > 0){
+        if(step > 1)
+            state->lost.fetchAndAddRelaxed(step - 1);
+        state->sequenceMask = (step < LINK_SEQUENCE_WINDOW) ? (state->sequenceMask << step) | 1 : 1;
+        state->lastCounter = counter;
+        return;
+    }
+
+    qint32 back = -step;
+    if(back > LINK_SEQUENCE_RESTART){
+        state->lastCounter = counter;
+        state->sequenceMask = 1;
+        return;
+    }
+    if(back >= LINK_SEQUENCE_WINDOW){
+        state->reordered.fetchAndAddRelaxed(1);
+        return;
+    }
+    quint64 bit = (quint64) 1 << back;
+    if(state->sequenceMask & bit){
+        state->duplicates.fetchAndAddRelaxed(1);
+        return;
+    }
+    state->sequenceMask |= bit;
+    state->reordered.fetchAndAddRelaxed(1);
+    if(state->lost.load())
+        state->lost.fetchAndSubRelaxed(1);
+}
+
+
+/*Other topics: reordering and duplicates by timestamp, gaps by the publishing period.
+ * A late packet only takes back a loss if it falls into one of the last LINK_GAP_HISTORY gaps
+ * that still has missing packets, other late packets are only counted as reordered.*/
+void LinkStatistics::trackTimestamp(Topic *state, quint64 timestamp){
+    if(isDuplicate(state, timestamp)){
+        state->duplicates.fetchAndAddRelaxed(1);
+        return;
+    }
+    state->history[state->historyPosition] = timestamp;
+    state->historyPosition = (state->historyPosition + 1) % LINK_DUPLICATE_HISTORY;
+
+    if(state->started){
+        qint64 interval = (qint64)(timestamp - state->lastTimestamp);
+        if(interval < 0){
+            if(-interval > LINK_RESYNC_TIME){
+                /*Gaps before a restart cannot be filled any more*/
+                for(int i = 0; i < LINK_GAP_HISTORY; i++){
+                    state->gaps[i].missing = 0;
+                }
+                state->lastTimestamp = timestamp;
+                return;
+            }
+            state->reordered.fetchAndAddRelaxed(1);
+            if(fillGap(state, timestamp) && state->lost.load())
+                state->lost.fetchAndSubRelaxed(1);
+            return;
+        }
+        if(state->periodEstimate > 0 && interval > LINK_GAP_FACTOR * state->periodEstimate){
+            quint32 missing = (quint32) qRound(interval / state->periodEstimate) - 1;
+            state->lost.fetchAndAddRelaxed(missing);
+            countGap(state, state->lastTimestamp, timestamp, missing);
+        }
+        else{
+            /*Only regular intervals train the period*/
+            state->periodEstimate = state->periodEstimate > 0 ? state->periodEstimate + (interval - state->periodEstimate) / 16 : interval;
+            state->period.store((quint32)(state->periodEstimate / 1000));
+        }
+    }
+    state->lastTimestamp = timestamp;
+}
+
+
+bool LinkStatistics::isDuplicate(Topic *state, quint64 timestamp){
+    for(int i = 0; i < LINK_DUPLICATE_HISTORY; i++){
+        if(state->history[i] == timestamp)
+            return true;
+    }
+    return false;
+}
+
+
+/*The oldest gap is forgotten, its missing packets stay lost*/
+void LinkStatistics::countGap(Topic *state, quint64 start, quint64 end, quint32 missing){
+    Gap &gap = state->gaps[state->gapPosition];
+    gap.start = start;
+    gap.end = end;
+    gap.missing = missing;
+    state->gapPosition = (state->gapPosition + 1) % LINK_GAP_HISTORY;
+}
+
+
+bool LinkStatistics::fillGap(Topic *state, quint64 timestamp){
+    for(int i = 0; i < LINK_GAP_HISTORY; i++){
+        Gap &gap = state->gaps[i];
+        if(gap.missing && timestamp > gap.start && timestamp < gap.end){
+            gap.missing--;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/*RFC 3550: J += (|D| - J) / 16, D = difference of arrival and on-board intervals*/
+void LinkStatistics::trackJitter(Topic *state, const PayloadSatellite &payload){
+    qint64 transit = payload.receiveTime - (qint64) payload.timestamp;
+    if(state->started){
+        double difference = fabs((double)(transit - state->lastTransit));
+        state->jitterEstimate += (difference - state->jitterEstimate) / 16;
+        state->jitter.store((quint32)(state->jitterEstimate / 1000));
+    }
+    state->lastTransit = transit;
+}
+
+
+QVector<TopicStatistics> LinkStatistics::snapshot() const{
+    QVector<TopicStatistics> result;
+    foreach(quint32 topic, topicOrder){
+        const Topic *state = topics.value(topic);
+        TopicStatistics statistics;
+        statistics.topic = topic;
+        statistics.received = state->received.load();
+        statistics.lost = state->lost.load();
+        statistics.reordered = state->reordered.load();
+        statistics.duplicates = state->duplicates.load();
+        statistics.lateDrops = state->lateDrops.load();
+        statistics.jitter = state->jitter.load() / 1000.0;
+        statistics.period = state->period.load() / 1000.0;
+        quint32 expected = statistics.received + statistics.lost;
+        statistics.lossRate = expected ? (double) statistics.lost / expected : 0;
+        result.append(statistics);
+    }
+    return result;
+}
+
+
+/*Counters restart at once, the tracking state on the next packet*/
+void LinkStatistics::reset(){
+    foreach(Topic *state, topics){
+        state->received.store(0);
+        state->lost.store(0);
+        state->reordered.store(0);
+        state->duplicates.store(0);
+        state->lateDrops.store(0);
+        state->jitter.store(0);
+        state->period.store(0);
+        state->resetRequested.storeRelease(1);
+    }
+}
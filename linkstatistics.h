@@ -0,0 +1,91 @@
+#ifndef LINKSTATISTICS_H
+#define LINKSTATISTICS_H
+
+#include <QHash>
+#include <QVector>
+#include <QAtomicInteger>
+
+#include "payload.h"
+
+#define LINK_DUPLICATE_HISTORY 32           /*recent on-board timestamps checked for duplicates*/
+#define LINK_SEQUENCE_WINDOW 64             /*sequence numbers behind the newest one remembered as received or lost*/
+#define LINK_SEQUENCE_RESTART 1000          /*sequence numbers, a larger step back is a satellite restart*/
+#define LINK_RESYNC_TIME 10000000000LL      /*ns, a larger step back is a satellite restart*/
+#define LINK_GAP_FACTOR 1.5                 /*intervals above 1.5 periods contain lost packets*/
+#define LINK_GAP_HISTORY 16                 /*recent timestamp gaps a late packet can fill*/
+
+/*Link quality of one topic at the time of LinkStatistics::snapshot*/
+struct TopicStatistics{
+    quint32 topic;
+    quint32 received;
+    quint32 lost;
+    quint32 reordered;
+    quint32 duplicates;
+    quint32 lateDrops;      /*arrived after the jitter buffer released newer packets*/
+    double jitter;          /*ms, RFC 3550 inter-arrival jitter*/
+    double period;          /*ms, estimated publishing period*/
+    double lossRate;        /*lost / expected*/
+};
+
+/*Per topic loss, reordering, duplicate and jitter tracking.
+ * The counter topic is checked by its sequence number, all others by the RODOS
+ * timestamp and their publishing period. Only Connection updates the tracking,
+ * the published counters are atomics and can be read from any thread.*/
+class LinkStatistics
+{
+public:
+    LinkStatistics();
+    ~LinkStatistics();
+    void addTopic(quint32 topic);               /*before any packet arrives*/
+    void packetReceived(const PayloadSatellite &payload);
+    void lateDrop(quint32 topic);
+    QVector<TopicStatistics> snapshot() const;
+    void reset();
+
+private:
+    /*Interval between two timestamps counted as missing packets*/
+    struct Gap{
+        quint64 start;
+        quint64 end;
+        quint32 missing;                /*not yet filled by late packets*/
+    };
+
+    struct Topic{
+        /*Published*/
+        QAtomicInteger<quint32> received;
+        QAtomicInteger<quint32> lost;
+        QAtomicInteger<quint32> reordered;
+        QAtomicInteger<quint32> duplicates;
+        QAtomicInteger<quint32> lateDrops;
+        QAtomicInteger<quint32> jitter;         /*us*/
+        QAtomicInteger<quint32> period;         /*us*/
+        QAtomicInteger<quint32> resetRequested;
+
+        /*Tracking, receive path only*/
+        bool started;
+        qint32 lastCounter;
+        quint64 sequenceMask;           /*bit n: lastCounter - n was received*/
+        quint64 lastTimestamp;
+        qint64 lastTransit;             /*receive time - on-board time*/
+        double jitterEstimate;
+        double periodEstimate;
+        quint64 history[LINK_DUPLICATE_HISTORY];
+        int historyPosition;
+        Gap gaps[LINK_GAP_HISTORY];
+        int gapPosition;
+
+        Topic();
+        void clearTracking();
+    };
+    QHash<quint32, Topic*> topics;
+    QVector<quint32> topicOrder;
+
+    void trackSequence(Topic *state, qint32 counter);
+    void trackTimestamp(Topic *state, quint64 timestamp);
+    void trackJitter(Topic *state, const PayloadSatellite &payload);
+    bool isDuplicate(Topic *state, quint64 timestamp);
+    void countGap(Topic *state, quint64 start, quint64 end, quint32 missing);
+    bool fillGap(Topic *state, quint64 timestamp);
+};
+
+#endif // LINKSTATISTICS_H
@@ -0,0 +1,186 @@
+#include "logfile.h"
+
+#include <QDateTime>
+
+#include <string.h>
+#include <zlib.h>
+
+LogFile::LogFile(const QString &directory, QObject *parent) :
+    QThread(parent), directory(directory), droppedRecords(0), stopping(false),
+    maxSize(LOG_FILE_MAX_SIZE), maxAge(LOG_FILE_MAX_AGE), compression(true), fileSize(0){
+    QDir().mkpath(directory);
+}
+
+LogFile::~LogFile(){
+    stop();
+}
+
+
+void LogFile::setMaxSize(qint64 bytes){
+    QMutexLocker locker(&mutex);
+    maxSize = bytes;
+}
+
+void LogFile::setMaxAge(int seconds){
+    QMutexLocker locker(&mutex);
+    maxAge = seconds;
+}
+
+void LogFile::setCompression(bool enabled){
+    QMutexLocker locker(&mutex);
+    compression = enabled;
+}
+
+
+/*Writes everything still pending and ends the writer thread*/
+void LogFile::stop(){
+    mutex.lock();
+    stopping = true;
+    pendingCondition.wakeOne();
+    mutex.unlock();
+    wait();
+}
+
+
+/*GUI thread: format outside the lock, then only append*/
+void LogFile::writeRecords(const QVector<LogRecord> &records){
+    QByteArray text;
+    foreach(const LogRecord &record, records){
+        text += QDateTime::fromMSecsSinceEpoch(Logger::wallClock(record.timestamp)).toString("yyyy-MM-dd hh:mm:ss.zzz ").toLatin1();
+        text += Logger::levelName(record.level);
+        text += ' ';
+        text += Logger::subsystemName(record.subsystem);
+        text += ": ";
+        text += Logger::format(record).toUtf8();
+        text += '\n';
+    }
+
+    QMutexLocker locker(&mutex);
+    if(pending.size() + text.size() > LOG_FILE_MAX_PENDING){
+        droppedRecords += records.size();
+        return;
+    }
+    pending += text;
+    pendingCondition.wakeOne();
+}
+
+
+/*-------------*/
+/*Writer thread*/
+/*-------------*/
+
+void LogFile::run(){
+    openFile();
+    QByteArray chunk;
+    bool finished = false;
+    while(!finished){
+        mutex.lock();
+        if(pending.isEmpty() && !stopping)
+            pendingCondition.wait(&mutex, LOG_FILE_FLUSH_INTERVAL);
+        chunk.swap(pending);
+        quint32 dropped = droppedRecords;
+        droppedRecords = 0;
+        finished = stopping;
+        qint64 sizeLimit = maxSize;
+        int ageLimit = maxAge;
+        mutex.unlock();
+
+        if(dropped)
+            chunk += QString("%1 log records dropped, disk too slow.\n").arg(dropped).toLatin1();
+        if(!chunk.isEmpty() && file.isOpen()){
+            fileSize += file.write(chunk);
+            file.flush();
+        }
+        chunk.clear();
+
+        /*An idle log is rotated as well, but never an empty one*/
+        if(fileSize > 0 && (fileSize >= sizeLimit || fileAge.elapsed() >= (qint64) ageLimit*1000))
+            rotate();
+    }
+    file.close();
+}
+
+
+/*A new file per session and rotation, named after its start time.
+ * Further files started in the same second get _001, _002, ... so no log is ever appended to
+ * or overwritten, the suffix sorts behind the plain name.*/
+bool LogFile::openFile(){
+    QString start = QDateTime::currentDateTime().toString("'session-'yyyyMMdd-hhmmss");
+    QString name = start + ".log";
+    for(int sequence = 1; directory.exists(name) || directory.exists(name + ".gz"); sequence++){
+        name = start + QString("_%1.log").arg(sequence, 3, 10, QChar('0'));
+    }
+    file.setFileName(directory.filePath(name));
+    fileSize = 0;
+    fileAge.start();
+    return file.open(QIODevice::WriteOnly);
+}
+
+
+void LogFile::rotate(){
+    QString rotated = file.fileName();
+    file.close();
+    mutex.lock();
+    bool compress = compression;
+    mutex.unlock();
+    if(compress)
+        compressFile(rotated);
+    removeOldFiles();
+    openFile();
+}
+
+
+/*Streams the file through deflate, the .log.gz can be read with gunzip or zcat*/
+void LogFile::compressFile(const QString &fileName){
+    QFile plain(fileName);
+    if(!plain.open(QIODevice::ReadOnly))
+        return;
+    QFile compressed(fileName + ".gz");
+    if(!compressed.open(QIODevice::WriteOnly))
+        return;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK){  /*15 + 16: gzip header and trailer*/
+        compressed.remove();
+        return;
+    }
+    QByteArray input;
+    QByteArray output(LOG_FILE_COMPRESS_CHUNK, Qt::Uninitialized);
+    bool ok = true;
+    int result = Z_OK;
+    while(ok && result != Z_STREAM_END){
+        input = plain.read(LOG_FILE_COMPRESS_CHUNK);
+        int flush = plain.atEnd() ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in = (Bytef*) input.data();
+        stream.avail_in = input.size();
+        do{
+            stream.next_out = (Bytef*) output.data();
+            stream.avail_out = output.size();
+            result = deflate(&stream, flush);
+            qint64 bytes = output.size() - stream.avail_out;
+            if(result == Z_STREAM_ERROR || compressed.write(output.constData(), bytes) != bytes)
+                ok = false;
+        } while(ok && stream.avail_out == 0);
+        if(flush != Z_FINISH && input.isEmpty())
+            ok = false;                     /*read error before the end*/
+    }
+    deflateEnd(&stream);
+
+    if(ok){
+        compressed.close();
+        plain.remove();
+    }
+    else{
+        compressed.remove();
+    }
+}
+
+
+/*Names sort by start time, the oldest ones go first*/
+void LogFile::removeOldFiles(){
+    QStringList files = directory.entryList(QStringList() << "session-*.log" << "session-*.log.gz", QDir::Files, QDir::Name);
+    for(int i = 0; i < files.size() - LOG_FILE_MAX_FILES; i++){
+        directory.remove(files.at(i));
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef LOGFILE_H
+#define LOGFILE_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFile>
+#include <QDir>
+#include <QElapsedTimer>
+
+#include "logger.h"
+
+#define LOG_FILE_MAX_SIZE (8*1024*1024)     /*bytes before the session log is rotated*/
+#define LOG_FILE_MAX_AGE (60*60)            /*s before the session log is rotated*/
+#define LOG_FILE_MAX_FILES 50               /*rotated files kept in the log directory*/
+#define LOG_FILE_MAX_PENDING (4*1024*1024)  /*bytes buffered for the writer, records beyond are dropped*/
+#define LOG_FILE_FLUSH_INTERVAL 1000        /*ms*/
+#define LOG_FILE_COMPRESS_CHUNK (64*1024)   /*bytes read and deflated at once when a file is rotated*/
+
+/*Session log on disk. Records are formatted in the GUI thread and handed to a
+ * writer thread, only a buffer append happens under the lock. If the disk stalls
+ * the buffer fills up and records are counted as dropped, the caller never waits.*/
+class LogFile : public QThread, public LogSink
+{
+    Q_OBJECT
+
+public:
+    explicit LogFile(const QString &directory, QObject *parent = 0);
+    ~LogFile();
+
+    void setMaxSize(qint64 bytes);
+    void setMaxAge(int seconds);
+    void setCompression(bool enabled);      /*rotated files are stored gzip compressed as .log.gz*/
+    void stop();
+
+    void writeRecords(const QVector<LogRecord> &records) Q_DECL_OVERRIDE;
+
+protected:
+    void run() Q_DECL_OVERRIDE;
+
+private:
+    QDir directory;
+
+    /*Shared with the writer thread*/
+    QMutex mutex;
+    QWaitCondition pendingCondition;
+    QByteArray pending;
+    quint32 droppedRecords;
+    bool stopping;
+    qint64 maxSize;
+    int maxAge;
+    bool compression;
+
+    /*Writer thread only*/
+    QFile file;
+    qint64 fileSize;
+    QElapsedTimer fileAge;
+
+    bool openFile();
+    void rotate();
+    void compressFile(const QString &fileName);
+    void removeOldFiles();
+};
+
+#endif // LOGFILE_H
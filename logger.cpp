@@ -0,0 +1,215 @@
+#include "logger.h"
+#include "clocksync.h"
+
+/*Formats of LogMessageId, the level adds its own prefix*/
+static const char *const messageFormats[MsgCount] = {
+    "%1",                                                           /*MsgText*/
+    "Telemetry online.",                                            /*MsgTelemetryOnline*/
+    "Telemetry lost.",                                              /*MsgTelemetryLost*/
+    "Calibration running...",                                       /*MsgCalibrationRunning*/
+    "TC: Set orientation to %1 degrees",                            /*MsgSetOrientation*/
+    "TC: Set rotation speed to %1 deg/sec",                         /*MsgSetRotation*/
+    "Orientation angle invalid",                                    /*MsgAngleInvalid*/
+    "Binding ground station to IP %1 at port %2.",                  /*MsgBinding*/
+    "Binding successful.",                                          /*MsgBindingSuccessful*/
+    "Binding not possible.",                                        /*MsgBindingFailed*/
+    "No port selected or port could not be found.",                 /*MsgPortNotFound*/
+    "Port \"%1\" opened.",                                          /*MsgPortOpened*/
+    "Port \"%1\" could not be opened.",                             /*MsgPortOpenFailed*/
+    "Port \"%1\" closed.",                                          /*MsgPortClosed*/
+    "Port problem.",                                                /*MsgPortProblem*/
+    "Image received.",                                              /*MsgImageReceived*/
+    "Compressed image received (%1 bytes).",                        /*MsgCompressedImageReceived*/
+    "Received image package size does not fit required size.",      /*MsgImageSizeInvalid*/
+    "Compressed image could not be decoded.",                       /*MsgCompressedImageInvalid*/
+    "Bluetooth message dropped due to incomplete flags.",           /*MsgBluetoothMessageDropped*/
+    "Image archive \"%1\" could not be opened.",                    /*MsgArchiveOpenFailed*/
+    "Image could not be stored in the archive.",                    /*MsgArchiveAppendFailed*/
+    "Image archive full (%1 images), further images are not stored.", /*MsgArchiveFull*/
+    "Export to \"%1\" failed.",                                     /*MsgExportFailed*/
+    "Telemetry dictionary \"%1\" loaded, %2 topics.",               /*MsgDictionaryLoaded*/
+    "Telemetry dictionary ignored: %1",                             /*MsgDictionaryInvalid*/
+    "Telemetry archive \"%1\" could not be opened.",                /*MsgTelemetryArchiveOpenFailed*/
+    "Telemetry could not be written to \"%1\".",                    /*MsgTelemetryArchiveWriteFailed*/
+    "%1 telemetry rows exported to \"%2\".",                        /*MsgTelemetryExported*/
+    "TC %1 (identifier %2) acknowledged by the satellite.",         /*MsgTelecommandAcknowledged*/
+    "%1 log messages dropped, queue full."                          /*MsgLogRecordsDropped*/
+};
+
+static LogQueue &logQueue(){
+    static LogQueue queue;
+    return queue;
+}
+
+static QAtomicInteger<quint32> droppedRecords;
+
+
+LogRecord::LogRecord() : timestamp(0), level(LogInfo), subsystem(LogGroundstation), id(MsgText){
+}
+
+
+/*------------------------------*/
+/*Bounded MPSC queue (D. Vyukov)*/
+/*------------------------------*/
+/*Every cell carries a sequence number: position when free for the producer of that position,
+ * position+1 when filled for the consumer.*/
+
+LogQueue::LogQueue() : enqueuePosition(0), dequeuePosition(0){
+    for(quint32 i = 0; i < LOG_QUEUE_SIZE; i++){
+        cells[i].sequence.store(i);
+    }
+}
+
+bool LogQueue::push(const LogRecord &record){
+    quint32 position = enqueuePosition.load();
+    Cell *cell;
+    for(;;){
+        cell = &cells[position & (LOG_QUEUE_SIZE - 1)];
+        qint32 difference = (qint32)(cell->sequence.loadAcquire() - position);
+        if(difference == 0){
+            if(enqueuePosition.testAndSetRelaxed(position, position + 1))
+                break;
+            position = enqueuePosition.load();
+        }
+        else if(difference < 0){
+            return false;
+        }
+        else{
+            position = enqueuePosition.load();
+        }
+    }
+    cell->record = record;
+    cell->sequence.storeRelease(position + 1);
+    return true;
+}
+
+bool LogQueue::pop(LogRecord &record){
+    Cell *cell = &cells[dequeuePosition & (LOG_QUEUE_SIZE - 1)];
+    qint32 difference = (qint32)(cell->sequence.loadAcquire() - (dequeuePosition + 1));
+    if(difference < 0)
+        return false;
+    record = cell->record;
+    cell->record = LogRecord();     /*release string arguments right away*/
+    cell->sequence.storeRelease(dequeuePosition + LOG_QUEUE_SIZE);
+    dequeuePosition++;
+    return true;
+}
+
+
+/*------*/
+/*Logger*/
+/*------*/
+
+Logger::Logger(QObject *parent) : QObject(parent){
+    groundTime();
+    logQueue();
+    batch.reserve(LOG_QUEUE_SIZE);
+    drainTimer.setInterval(LOG_DRAIN_INTERVAL);
+    connect(&drainTimer, SIGNAL(timeout()), this, SLOT(drain()));
+    drainTimer.start();
+}
+
+
+void Logger::addSink(LogSink *sink){
+    sinks.append(sink);
+}
+
+void Logger::removeSink(LogSink *sink){
+    sinks.removeAll(sink);
+}
+
+
+/*Cheap enough for the ingest path: no formatting, no allocation for literal and number arguments*/
+void Logger::post(LogLevel level, LogSubsystem subsystem, LogMessageId id, const LogArg &arg1, const LogArg &arg2){
+    LogRecord record;
+    record.timestamp = now();
+    record.level = level;
+    record.subsystem = subsystem;
+    record.id = id;
+    record.args[0] = arg1;
+    record.args[1] = arg2;
+    if(!logQueue().push(record))
+        droppedRecords.fetchAndAddRelaxed(1);
+}
+
+
+/*Records share the ground clock with received telemetry*/
+qint64 Logger::now(){
+    return groundTime();
+}
+
+qint64 Logger::wallClock(qint64 timestamp){
+    return groundWallClock(timestamp);
+}
+
+
+/*Hand everything queued since the last call to the sinks as one batch*/
+void Logger::drain(){
+    batch.clear();
+    LogRecord record;
+    while(logQueue().pop(record)){
+        batch.append(record);
+    }
+
+    quint32 dropped = droppedRecords.fetchAndStoreRelaxed(0);
+    if(dropped){
+        LogRecord notice;
+        notice.timestamp = now();
+        notice.level = LogWarning;
+        notice.id = MsgLogRecordsDropped;
+        notice.args[0] = LogArg((qint64) dropped);
+        batch.append(notice);
+    }
+
+    if(batch.isEmpty())
+        return;
+    foreach(LogSink *sink, sinks){
+        sink->writeRecords(batch);
+    }
+}
+
+
+QString Logger::format(const LogRecord &record){
+    QString text = QLatin1String(messageFormats[record.id]);
+    for(int i = 0; i < LOG_MAX_ARGS; i++){
+        const LogArg &arg = record.args[i];
+        switch(arg.type){
+        case LogArg::Integer:
+            text = text.arg(arg.integer);
+            break;
+        case LogArg::Real:
+            text = text.arg(arg.real);
+            break;
+        case LogArg::Literal:
+            text = text.arg(QLatin1String(arg.literal));
+            break;
+        case LogArg::String:
+            text = text.arg(arg.string);
+            break;
+        default:
+            break;
+        }
+    }
+    return text;
+}
+
+
+const char *Logger::levelName(LogLevel level){
+    switch(level){
+    case LogDebug:      return "DEBUG";
+    case LogInfo:       return "INFO";
+    case LogWarning:    return "WARNING";
+    case LogError:      return "ERROR";
+    }
+    return "";
+}
+
+const char *Logger::subsystemName(LogSubsystem subsystem){
+    switch(subsystem){
+    case LogGroundstation:  return "groundstation";
+    case LogConnection:     return "connection";
+    case LogImagelink:      return "imagelink";
+    case LogArchive:        return "archive";
+    }
+    return "";
+}
@@ -0,0 +1,155 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QList>
+#include <QTimer>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+
+#define LOG_QUEUE_SIZE 8192         /*records, has to be a power of two*/
+#define LOG_MAX_ARGS 2
+#define LOG_DRAIN_INTERVAL 16       /*ms, sinks get at most one batch per frame*/
+
+enum LogLevel{
+    LogDebug,
+    LogInfo,
+    LogWarning,
+    LogError
+};
+
+enum LogSubsystem{
+    LogGroundstation,
+    LogConnection,
+    LogImagelink,
+    LogArchive
+};
+
+/*Every message has a fixed format, see messageFormats in logger.cpp*/
+enum LogMessageId{
+    MsgText,                        /*%1, literal or satellite text*/
+    MsgTelemetryOnline,
+    MsgTelemetryLost,
+    MsgCalibrationRunning,
+    MsgSetOrientation,
+    MsgSetRotation,
+    MsgAngleInvalid,
+    MsgBinding,
+    MsgBindingSuccessful,
+    MsgBindingFailed,
+    MsgPortNotFound,
+    MsgPortOpened,
+    MsgPortOpenFailed,
+    MsgPortClosed,
+    MsgPortProblem,
+    MsgImageReceived,
+    MsgCompressedImageReceived,
+    MsgImageSizeInvalid,
+    MsgCompressedImageInvalid,
+    MsgBluetoothMessageDropped,
+    MsgArchiveOpenFailed,
+    MsgArchiveAppendFailed,
+    MsgArchiveFull,
+    MsgExportFailed,
+    MsgDictionaryLoaded,
+    MsgDictionaryInvalid,
+    MsgTelemetryArchiveOpenFailed,
+    MsgTelemetryArchiveWriteFailed,
+    MsgTelemetryExported,
+    MsgTelecommandAcknowledged,
+    MsgLogRecordsDropped,
+    MsgCount
+};
+
+/*Argument of a log record, formatted only when it is displayed or written.
+ * Literals have to be static strings, they are stored as pointers.*/
+struct LogArg{
+    enum Type{
+        None,
+        Integer,
+        Real,
+        Literal,
+        String
+    };
+    Type type;
+    union{
+        qint64 integer;
+        double real;
+        const char *literal;
+    };
+    QString string;
+
+    LogArg() : type(None), integer(0){}
+    LogArg(int value) : type(Integer), integer(value){}
+    LogArg(qint64 value) : type(Integer), integer(value){}
+    LogArg(double value) : type(Real), real(value){}
+    LogArg(const char *value) : type(Literal), literal(value){}
+    LogArg(const QString &value) : type(String), integer(0), string(value){}
+};
+
+struct LogRecord{
+    qint64 timestamp;           /*ns, ground clock*/
+    LogLevel level;
+    LogSubsystem subsystem;
+    LogMessageId id;
+    LogArg args[LOG_MAX_ARGS];
+    LogRecord();
+};
+
+/*Receiver of drained records, called in the GUI thread*/
+class LogSink
+{
+public:
+    virtual ~LogSink(){}
+    virtual void writeRecords(const QVector<LogRecord> &records) = 0;
+};
+
+/*Bounded multi producer / single consumer queue, preallocated, lock-free (D. Vyukov)*/
+class LogQueue
+{
+public:
+    LogQueue();
+    bool push(const LogRecord &record);     /*any thread, false if full*/
+    bool pop(LogRecord &record);            /*consumer thread only*/
+
+private:
+    struct Cell{
+        QAtomicInteger<quint32> sequence;
+        LogRecord record;
+    };
+    Cell cells[LOG_QUEUE_SIZE];
+    QAtomicInteger<quint32> enqueuePosition;
+    quint32 dequeuePosition;
+};
+
+/*Structured logging channel. Any thread posts records, the Logger object
+ * drains them in the GUI thread and hands them in batches to the sinks.*/
+class Logger : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Logger(QObject *parent = 0);
+    void addSink(LogSink *sink);
+    void removeSink(LogSink *sink);
+
+    static void post(LogLevel level, LogSubsystem subsystem, LogMessageId id, const LogArg &arg1 = LogArg(), const LogArg &arg2 = LogArg());
+    static qint64 now();
+    static qint64 wallClock(qint64 timestamp);     /*ms since epoch of a record timestamp*/
+
+    static QString format(const LogRecord &record);
+    static const char *levelName(LogLevel level);
+    static const char *subsystemName(LogSubsystem subsystem);
+
+public slots:
+    void drain();
+
+private:
+    QList<LogSink*> sinks;
+    QVector<LogRecord> batch;
+    QTimer drainTimer;
+};
+
+#endif // LOGGER_H
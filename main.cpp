@@ -1,17 +1,32 @@
 #include "groundstation.h"
+#include "headless.h"
 #include <QApplication>
 #include <QStyleFactory>
 
 int main(int argc, char *argv[])
 {
+    /*Batch jobs on recorded sessions need no window*/
+    if(isHeadless(argc, argv)){
+        if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        QApplication a(argc, argv);
+        QCommandLineParser parser;
+        addCommandLineOptions(parser);
+        parser.process(a);
+        return runHeadless(parser);
+    }
+
     /*Set darker window theme with gray buttons*/
     QApplication::setStyle(QStyleFactory::create("Fusion"));
     QPalette p;
     QApplication a(argc, argv);
+    QCommandLineParser parser;
+    addCommandLineOptions(parser);
+    parser.process(a);
     p = a.palette();
     p.setColor(QPalette::Button, QColor(150,150,150));
     a.setPalette(p);
-    Groundstation w;
+    Groundstation w(parser);
     w.show();
 
     return a.exec();
@@ -1,76 +1,193 @@
 #include "payload.h"
 
-PayloadSatellite::PayloadSatellite() : checksum(0), senderNode(0), timestamp(0), senderThread(0), topic(0), ttl(0), userDataLen(0){
+const char *payloadTypeName(quint32 topic){
+    switch(topic){
+    case PayloadCounterType:        return "Counter";
+    case PayloadSensorIMUType:      return "Sensor IMU";
+    case PayloadElectricalType:     return "Electrical";
+    case PayloadMissionType:        return "Mission";
+    case PayloadLightType:          return "Light";
+    }
+    return "Unknown";
+}
+
+PayloadSatellite::PayloadSatellite() : checksum(0), senderNode(0), timestamp(0), senderThread(0), topic(0), ttl(0), userDataLen(0), receiveTime(0), sampleTime(0), dequeueTime(0){
     userData[0] = 0;
 }
 
-PayloadSatellite::PayloadSatellite(const QByteArray &buffer) : checksum(0), senderNode(0), timestamp(0), senderThread(0), topic(0), ttl(0), userDataLen(0){
+PayloadSatellite::PayloadSatellite(const QByteArray &buffer) : checksum(0), senderNode(0), timestamp(0), senderThread(0), topic(0), ttl(0), userDataLen(0), receiveTime(0), sampleTime(0), dequeueTime(0){
     userData[0] = 0;
     if(buffer.size() < 1023)
         return;
 
-    checksum = qFromBigEndian(*((quint16*)(buffer.constData() + 0)));
-    senderNode = qFromBigEndian(*((quint32*)(buffer.constData() + 2)));
-    timestamp = qFromBigEndian(*((quint64*)(buffer.constData() + 6)));
-    senderThread = qFromBigEndian(*((quint32*)(buffer.constData() + 14)));
-    topic = qFromBigEndian(*((quint32*)(buffer.constData() + 18)));
-    ttl = qFromBigEndian(*((quint16*)(buffer.constData() + 22)));
-    userDataLen = qFromBigEndian(*((quint16*)(buffer.constData() + 24)));
+    const uchar *header = (const uchar*) buffer.constData();
+    checksum = qFromBigEndian<quint16>(header + 0);
+    senderNode = qFromBigEndian<quint32>(header + 2);
+    timestamp = qFromBigEndian<quint64>(header + 6);
+    senderThread = qFromBigEndian<quint32>(header + 14);
+    topic = qFromBigEndian<quint32>(header + 18);
+    ttl = qFromBigEndian<quint16>(header + 22);
+    userDataLen = qMin(qFromBigEndian<quint16>(header + 24), (quint16)(sizeof(userData) - 1));
     memcpy(userData, buffer.constData() + 26, userDataLen);
     userData[userDataLen] = 0x00;
 }
 
-PayloadCounter::PayloadCounter(const PayloadSatellite payload): counter(0){
-    if(payload.userDataLen != sizeof(PayloadCounter) || payload.topic != PayloadCounterType)
+PAYLOAD_SCHEMA_FIELDS(PayloadCounterSchema, PAYLOAD_COUNTER_FIELDS)
+PAYLOAD_SCHEMA_FIELDS(PayloadSensorIMUSchema, PAYLOAD_SENSOR_IMU_FIELDS)
+PAYLOAD_SCHEMA_FIELDS(PayloadElectricalSchema, PAYLOAD_ELECTRICAL_FIELDS)
+PAYLOAD_SCHEMA_FIELDS(PayloadLightSchema, PAYLOAD_LIGHT_FIELDS)
+PAYLOAD_SCHEMA_FIELDS(PayloadMissionSchema, PAYLOAD_MISSION_FIELDS)
+
+const PayloadField *payloadFields(quint32 topic, int *count){
+    switch(topic){
+    case PayloadCounterType:
+        *count = PayloadCounterSchema::fieldCount;
+        return PayloadCounterSchema::fields;
+    case PayloadSensorIMUType:
+        *count = PayloadSensorIMUSchema::fieldCount;
+        return PayloadSensorIMUSchema::fields;
+    case PayloadElectricalType:
+        *count = PayloadElectricalSchema::fieldCount;
+        return PayloadElectricalSchema::fields;
+    case PayloadLightType:
+        *count = PayloadLightSchema::fieldCount;
+        return PayloadLightSchema::fields;
+    case PayloadMissionType:
+        *count = PayloadMissionSchema::fieldCount;
+        return PayloadMissionSchema::fields;
+    }
+    *count = 0;
+    return 0;
+}
+
+
+/*Decoders: all fields zero unless topic and size match, then one load per field.
+ * The float values of the electrical topic used to be read at offset 5, but the
+ * satellite aligns them to 8. The schema takes care of that now.*/
+
+PayloadCounter::PayloadCounter(const PayloadSatellite &payload){
+    typedef PayloadCounterSchema Schema;
+    PAYLOAD_COUNTER_FIELDS(PAYLOAD_FIELD_INIT)
+    if(payload.userDataLen != Schema::size() || payload.topic != PayloadCounterType)
         return;
-    counter = *(int*)(payload.userData);
+    PAYLOAD_COUNTER_FIELDS(PAYLOAD_FIELD_DECODE)
 }
 
-PayloadSensorIMU::PayloadSensorIMU(const PayloadSatellite payload):ax(0), ay(0), az(0), wx(0), wy(0), wz(0), roll(0), pitch(0), headingFusion(0), headingXm(0), headingGyro(0){
-    if(payload.userDataLen != sizeof(PayloadSensorIMU) || payload.topic != PayloadSensorIMUType)
+PayloadSensorIMU::PayloadSensorIMU(const PayloadSatellite &payload){
+    typedef PayloadSensorIMUSchema Schema;
+    PAYLOAD_SENSOR_IMU_FIELDS(PAYLOAD_FIELD_INIT)
+    if(payload.userDataLen != Schema::size() || payload.topic != PayloadSensorIMUType)
         return;
-    ax = *(float*)(payload.userData);
-    ay = *(float*)(payload.userData + 1 * sizeof(float));
-    az = *(float*)(payload.userData + 2 * sizeof(float));
-    wx = *(float*)(payload.userData + 3 * sizeof(float));
-    wy = *(float*)(payload.userData + 4 * sizeof(float));
-    wz = *(float*)(payload.userData + 5 * sizeof(float));
-    roll = *(float*)(payload.userData + 6 * sizeof(float));
-    pitch = *(float*)(payload.userData + 7 * sizeof(float));
-    headingFusion = *(float*)(payload.userData + 8 * sizeof(float));
-    headingXm = *(float*)(payload.userData + 9 * sizeof(float));
-    headingGyro = *(float*)(payload.userData + 10 * sizeof(float));
-    calibrationActive = *(bool*)(payload.userData+ 11*sizeof(float));
-}
-
-/*This struct gives strange values. All the bools are just fine, but none of the floats is alright.
- * It's neither a bit/byteshift nor a bigEndian/littleEndian problem, we tried everything. Moving the lightsensor value into
- * another struct gives the right values. Due to time constrictions and low priority, we didn't send all the current and voltage
- * floats in a new struct.*/
-PayloadElectrical::PayloadElectrical(const PayloadSatellite payload): lightsensorOn(0), electromagnetOn(0), thermalKnifeOn(0), batteryCurrent(0), batteryVoltage(0), solarPanelCurrent(0), solarPanelVoltage(0){
-    if(payload.userDataLen != sizeof(PayloadElectrical) || payload.topic != PayloadElectricalType)
+    PAYLOAD_SENSOR_IMU_FIELDS(PAYLOAD_FIELD_DECODE)
+}
+
+PayloadElectrical::PayloadElectrical(const PayloadSatellite &payload){
+    typedef PayloadElectricalSchema Schema;
+    PAYLOAD_ELECTRICAL_FIELDS(PAYLOAD_FIELD_INIT)
+    if(payload.userDataLen != Schema::size() || payload.topic != PayloadElectricalType)
         return;
-    lightsensorOn =     *(bool*)(payload.userData);
-    electromagnetOn =   *(bool*)(payload.userData + 1 * sizeof(bool));
-    thermalKnifeOn =    *(bool*)(payload.userData + 2 * sizeof(bool));
-    racksOut =          *(bool*)(payload.userData + 3 * sizeof(bool));
-    solarPanelsOut =    *(bool*)(payload.userData + 4 * sizeof(bool));
-    batteryCurrent =    *(float*)(payload.userData + 5 * sizeof(bool));
-    batteryVoltage =    *(float*)(payload.userData + 5 * sizeof(bool) + 1 * sizeof(float));
-    solarPanelCurrent = *(float*)(payload.userData + 5 * sizeof(bool) + 2 * sizeof(float));
-    solarPanelVoltage = *(float*)(payload.userData + 5 * sizeof(bool) + 3 * sizeof(float));
+    PAYLOAD_ELECTRICAL_FIELDS(PAYLOAD_FIELD_DECODE)
+}
+
+PayloadLight::PayloadLight(const PayloadSatellite &payload){
+    typedef PayloadLightSchema Schema;
+    PAYLOAD_LIGHT_FIELDS(PAYLOAD_FIELD_INIT)
+    if(payload.userDataLen != Schema::size() || payload.topic != PayloadLightType)
+        return;
+    PAYLOAD_LIGHT_FIELDS(PAYLOAD_FIELD_DECODE)
+}
+
+PayloadMission::PayloadMission(const PayloadSatellite &payload){
+    typedef PayloadMissionSchema Schema;
+    PAYLOAD_MISSION_FIELDS(PAYLOAD_FIELD_INIT)
+    if(payload.userDataLen != Schema::size() || payload.topic != PayloadMissionType)
+        return;
+    PAYLOAD_MISSION_FIELDS(PAYLOAD_FIELD_DECODE)
+}
+
+/*Encoders: the inverse of the decoders, padding bytes are zero. Returns the wire size.*/
+
+PayloadCounter::PayloadCounter(){
+    PAYLOAD_COUNTER_FIELDS(PAYLOAD_FIELD_INIT)
+}
+
+int PayloadCounter::encode(uchar *data) const{
+    typedef PayloadCounterSchema Schema;
+    memset(data, 0, Schema::size());
+    PAYLOAD_COUNTER_FIELDS(PAYLOAD_FIELD_ENCODE)
+    return Schema::size();
+}
+
+PayloadSensorIMU::PayloadSensorIMU(){
+    PAYLOAD_SENSOR_IMU_FIELDS(PAYLOAD_FIELD_INIT)
+}
+
+int PayloadSensorIMU::encode(uchar *data) const{
+    typedef PayloadSensorIMUSchema Schema;
+    memset(data, 0, Schema::size());
+    PAYLOAD_SENSOR_IMU_FIELDS(PAYLOAD_FIELD_ENCODE)
+    return Schema::size();
 }
 
-PayloadLight::PayloadLight(const PayloadSatellite payload): lightValue(0){
-    lightValue = *(uint16_t*)(payload.userData);
+PayloadElectrical::PayloadElectrical(){
+    PAYLOAD_ELECTRICAL_FIELDS(PAYLOAD_FIELD_INIT)
 }
 
-PayloadMission::PayloadMission(const PayloadSatellite payload): partNumber(0), angle(0), isCleaned(0){
-    partNumber = *(int*)(payload.userData);
-    angle = *(float*)(payload.userData + 1 * sizeof(int));
-    isCleaned = *(bool*)(payload.userData + 1 * sizeof(int) + 1 * sizeof(float));
+int PayloadElectrical::encode(uchar *data) const{
+    typedef PayloadElectricalSchema Schema;
+    memset(data, 0, Schema::size());
+    PAYLOAD_ELECTRICAL_FIELDS(PAYLOAD_FIELD_ENCODE)
+    return Schema::size();
+}
+
+PayloadLight::PayloadLight(){
+    PAYLOAD_LIGHT_FIELDS(PAYLOAD_FIELD_INIT)
+}
+
+int PayloadLight::encode(uchar *data) const{
+    typedef PayloadLightSchema Schema;
+    memset(data, 0, Schema::size());
+    PAYLOAD_LIGHT_FIELDS(PAYLOAD_FIELD_ENCODE)
+    return Schema::size();
+}
+
+PayloadMission::PayloadMission(){
+    PAYLOAD_MISSION_FIELDS(PAYLOAD_FIELD_INIT)
+}
+
+int PayloadMission::encode(uchar *data) const{
+    typedef PayloadMissionSchema Schema;
+    memset(data, 0, Schema::size());
+    PAYLOAD_MISSION_FIELDS(PAYLOAD_FIELD_ENCODE)
+    return Schema::size();
 }
 
 Command::Command(int tc_id, int tc_identifier, int tc_value): id(tc_id), identifier(tc_identifier), value(tc_value){
 
 }
+
+
+/*RODOS checksum: rotate right by one, then add the next byte, over everything behind the checksum itself*/
+quint16 rodosChecksum(const uchar *frame, int end){
+    quint16 checksum = 0;
+    for(int i = 2; i < end; ++i){
+        checksum = (quint16)((checksum >> 1) | (checksum << 15));
+        checksum += frame[i];
+    }
+    return checksum;
+}
+
+
+/*Fills a whole RODOS_FRAME_SIZE frame: header, user data, terminating zero and checksum*/
+void writeRodosFrame(uchar *frame, quint32 topic, quint64 timestamp, const uchar *data, int length){
+    length = qBound(0, length, RODOS_FRAME_SIZE - RODOS_HEADER_SIZE - 1);
+    qToBigEndian<quint32>(1, frame + 2);            /*senderNode*/
+    qToBigEndian<quint64>(timestamp, frame + 6);
+    qToBigEndian<quint32>(1, frame + 14);           /*senderThread*/
+    qToBigEndian<quint32>(topic, frame + 18);
+    qToBigEndian<quint16>(10, frame + 22);          /*ttl*/
+    qToBigEndian<quint16>(length, frame + 24);
+    memcpy(frame + RODOS_HEADER_SIZE, data, length);
+    memset(frame + RODOS_HEADER_SIZE + length, 0, RODOS_FRAME_SIZE - RODOS_HEADER_SIZE - length);
+    qToBigEndian<quint16>(rodosChecksum(frame, RODOS_HEADER_SIZE + length), frame);
+}
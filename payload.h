@@ -7,6 +7,15 @@
 #include <QDebug>
 
 #include "stdint.h"
+#include "payloadschema.h"
+
+#define RODOS_FRAME_SIZE 1023
+#define RODOS_HEADER_SIZE 26
+#define TOPIC_TABLE_BASE 5000       /*subscribable topic ids are [5000, 5064)*/
+#define TOPIC_TABLE_SIZE 64         /*size of the flat per-topic tables*/
+
+#define TELECOMMAND_TOPIC_ID 5555
+#define TELECOMMAND_ACK_TOPIC_ID 5006   /*echoes the received Command, reserved for the link*/
 
 enum PayloadType{
     PayloadCounterType = 5001,
@@ -16,6 +25,8 @@ enum PayloadType{
     PayloadLightType = 5005
 };
 
+const char *payloadTypeName(quint32 topic);
+
 struct PayloadCounter;
 struct PayloadSensorIMU;
 struct PayloadElectrical;
@@ -30,54 +41,103 @@ struct PayloadSatellite{
     quint16 ttl;
     quint16 userDataLen;
     quint8 userData[998];
+    qint64 receiveTime;         /*ns, ground clock at arrival*/
+    qint64 sampleTime;          /*ns, on-board timestamp mapped to the ground clock*/
+    qint64 dequeueTime;         /*ns, ground clock when read from the Connection*/
     PayloadSatellite();
     PayloadSatellite(const QByteArray &buffer);
 };
 
+/*Topic layouts: FIELD(type, name, unit, scale, endian), in on-board order.
+ * Adding a channel means adding one line here, offsets and decoders follow.*/
+
+#define PAYLOAD_COUNTER_FIELDS(FIELD) \
+    FIELD(qint32,   counter,            "",         1,  Little)
+
+#define PAYLOAD_SENSOR_IMU_FIELDS(FIELD) \
+    FIELD(float,    ax,                 "milli-g",  1,  Little) \
+    FIELD(float,    ay,                 "milli-g",  1,  Little) \
+    FIELD(float,    az,                 "milli-g",  1,  Little) \
+    FIELD(float,    wx,                 "rad/sec",  1,  Little) \
+    FIELD(float,    wy,                 "rad/sec",  1,  Little) \
+    FIELD(float,    wz,                 "rad/sec",  1,  Little) \
+    FIELD(float,    roll,               "rad",      1,  Little) \
+    FIELD(float,    pitch,              "rad",      1,  Little) \
+    FIELD(float,    headingFusion,      "rad",      1,  Little) \
+    FIELD(float,    headingXm,          "rad",      1,  Little) \
+    FIELD(float,    headingGyro,        "rad",      1,  Little) \
+    FIELD(bool,     calibrationActive,  "",         1,  Little)
+
+#define PAYLOAD_ELECTRICAL_FIELDS(FIELD) \
+    FIELD(bool,     lightsensorOn,      "",         1,  Little) \
+    FIELD(bool,     electromagnetOn,    "",         1,  Little) \
+    FIELD(bool,     thermalKnifeOn,     "",         1,  Little) \
+    FIELD(bool,     racksOut,           "",         1,  Little) \
+    FIELD(bool,     solarPanelsOut,     "",         1,  Little) \
+    FIELD(float,    batteryCurrent,     "mA",       1,  Little) \
+    FIELD(float,    batteryVoltage,     "V",        1,  Little) \
+    FIELD(float,    solarPanelCurrent,  "mA",       1,  Little) \
+    FIELD(float,    solarPanelVoltage,  "V",        1,  Little)
+
+#define PAYLOAD_LIGHT_FIELDS(FIELD) \
+    FIELD(quint16,  lightValue,         "raw",      1,  Little)
+
+#define PAYLOAD_MISSION_FIELDS(FIELD) \
+    FIELD(qint32,   partNumber,         "",         1,  Little) \
+    FIELD(float,    angle,              "deg",      1,  Little) \
+    FIELD(bool,     isCleaned,          "",         1,  Little)
+
+PAYLOAD_SCHEMA(PayloadCounterSchema, PAYLOAD_COUNTER_FIELDS)
+PAYLOAD_SCHEMA(PayloadSensorIMUSchema, PAYLOAD_SENSOR_IMU_FIELDS)
+PAYLOAD_SCHEMA(PayloadElectricalSchema, PAYLOAD_ELECTRICAL_FIELDS)
+PAYLOAD_SCHEMA(PayloadLightSchema, PAYLOAD_LIGHT_FIELDS)
+PAYLOAD_SCHEMA(PayloadMissionSchema, PAYLOAD_MISSION_FIELDS)
+
+/*Sizes of the structs on board, userDataLen has to match them*/
+static_assert(PayloadCounterSchema::size() == 4, "Counter layout changed");
+static_assert(PayloadSensorIMUSchema::size() == 48, "SensorIMU layout changed");
+static_assert(PayloadElectricalSchema::size() == 24, "Electrical layout changed");
+static_assert(PayloadLightSchema::size() == 2, "Light layout changed");
+static_assert(PayloadMissionSchema::size() == 12, "Mission layout changed");
+static_assert(PayloadSensorIMUSchema::size() <= RODOS_FRAME_SIZE - RODOS_HEADER_SIZE, "Topic does not fit into a RODOS frame");
+static_assert(PayloadElectricalSchema::offset(PayloadElectricalSchema::batteryCurrentIndex) == 8, "Floats are aligned on board");
+
+/*Field descriptions of a topic, 0 for unknown topics*/
+const PayloadField *payloadFields(quint32 topic, int *count);
+
 struct PayloadCounter{
-    int counter;
-    PayloadCounter(const PayloadSatellite payload);
+    PAYLOAD_COUNTER_FIELDS(PAYLOAD_FIELD_MEMBER)
+    PayloadCounter();
+    PayloadCounter(const PayloadSatellite &payload);
+    int encode(uchar *data) const;
 };
 
 struct PayloadSensorIMU{
-    float ax;               /*milli-g*/
-    float ay;               /*milli-g*/
-    float az;               /*milli-g*/
-    float wx;               /*rad/sec*/
-    float wy;               /*rad/sec*/
-    float wz;               /*rad/sec*/
-    float roll;             /*rad*/
-    float pitch;            /*rad*/
-    float headingFusion;    /*rad*/
-    float headingXm;        /*rad*/
-    float headingGyro;      /*rad*/
-    bool calibrationActive;
-    PayloadSensorIMU(const PayloadSatellite payload);
+    PAYLOAD_SENSOR_IMU_FIELDS(PAYLOAD_FIELD_MEMBER)
+    PayloadSensorIMU();
+    PayloadSensorIMU(const PayloadSatellite &payload);
+    int encode(uchar *data) const;
 };
 
 struct PayloadElectrical{
-    bool lightsensorOn;
-    bool electromagnetOn;
-    bool thermalKnifeOn;
-    bool racksOut;
-    bool solarPanelsOut;
-    float batteryCurrent;       /*mA*/
-    float batteryVoltage;       /*V*/
-    float solarPanelCurrent;    /*mA*/
-    float solarPanelVoltage;    /*V*/
-    PayloadElectrical(const PayloadSatellite payload);
+    PAYLOAD_ELECTRICAL_FIELDS(PAYLOAD_FIELD_MEMBER)
+    PayloadElectrical();
+    PayloadElectrical(const PayloadSatellite &payload);
+    int encode(uchar *data) const;
 };
 
 struct PayloadLight{
-    uint16_t lightValue;        /*raw data*/
-    PayloadLight(const PayloadSatellite payload);
+    PAYLOAD_LIGHT_FIELDS(PAYLOAD_FIELD_MEMBER)
+    PayloadLight();
+    PayloadLight(const PayloadSatellite &payload);
+    int encode(uchar *data) const;
 };
 
 struct PayloadMission{
-    int partNumber;
-    float angle;
-    bool isCleaned;
-    PayloadMission(const PayloadSatellite payload);
+    PAYLOAD_MISSION_FIELDS(PAYLOAD_FIELD_MEMBER)
+    PayloadMission();
+    PayloadMission(const PayloadSatellite &payload);
+    int encode(uchar *data) const;
 };
 
 struct Command{
@@ -87,4 +147,17 @@ struct Command{
     Command(int tc_id, int tc_identifier, int tc_value);
 };
 
+/*Frame helpers shared by the connection, the simulators and the benchmarks*/
+quint16 rodosChecksum(const uchar *frame, int end);     /*over bytes [2, end)*/
+void writeRodosFrame(uchar *frame, quint32 topic, quint64 timestamp, const uchar *data, int length);
+
+/*Topic filter of the receive path, reads the header only. Returns the index of the topic
+ * in the per-topic tables, -1 for unsubscribed topics and malformed frames.*/
+inline int rodosTopicFilter(const uchar *frame, qint64 size, quint64 topicMask){
+    if(size < RODOS_HEADER_SIZE || qFromBigEndian<quint16>(frame + 24) > RODOS_FRAME_SIZE - RODOS_HEADER_SIZE - 1)
+        return -1;
+    quint32 index = qFromBigEndian<quint32>(frame + 18) - TOPIC_TABLE_BASE;
+    return index < TOPIC_TABLE_SIZE && ((topicMask >> index) & 1) ? (int) index : -1;
+}
+
 #endif // PAYLOAD_H
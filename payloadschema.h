@@ -0,0 +1,177 @@
+#ifndef PAYLOADSCHEMA_H
+#define PAYLOADSCHEMA_H
+
+#include <QtGlobal>
+#include <QtEndian>
+#include <string.h>
+
+/*Declarative layout of the satellite's topic structs.
+ * A topic lists its fields once as FIELD(type, name, unit, scale, endian), in the order
+ * of the struct on board. The on-board compiler aligns every field naturally, the offsets
+ * and the total size follow from that at compile time and do not depend on the host.*/
+
+enum WireEndian{
+    WireLittleEndian,
+    WireBigEndian
+};
+
+enum PayloadFieldType{
+    FieldBool,
+    FieldInt16,
+    FieldUInt16,
+    FieldInt32,
+    FieldUInt32,
+    FieldFloat
+};
+
+/*Description of one field for generic consumers (dictionary, recorder, export)*/
+struct PayloadField{
+    const char *name;
+    const char *unit;
+    PayloadFieldType type;
+    double scale;
+    WireEndian endian;
+    quint16 offset;
+};
+
+template<class T> struct PayloadFieldTraits;
+template<> struct PayloadFieldTraits<bool>{ static const PayloadFieldType fieldType = FieldBool; };
+template<> struct PayloadFieldTraits<qint16>{ static const PayloadFieldType fieldType = FieldInt16; };
+template<> struct PayloadFieldTraits<quint16>{ static const PayloadFieldType fieldType = FieldUInt16; };
+template<> struct PayloadFieldTraits<qint32>{ static const PayloadFieldType fieldType = FieldInt32; };
+template<> struct PayloadFieldTraits<quint32>{ static const PayloadFieldType fieldType = FieldUInt32; };
+template<> struct PayloadFieldTraits<float>{ static const PayloadFieldType fieldType = FieldFloat; };
+
+
+/*-----------------------------*/
+/*Compile time offset machinery*/
+/*-----------------------------*/
+
+/*Scalars are aligned to their size*/
+constexpr quint16 wireAlign(quint16 offset, quint16 alignment){
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+/*Offset of field index behind fields of the given sizes, index == count gives the end*/
+constexpr quint16 wireOffset(int, quint16 offset){
+    return offset;
+}
+template<class... Sizes>
+constexpr quint16 wireOffset(int index, quint16 offset, quint16 size, Sizes... sizes){
+    return index == 0 ? wireAlign(offset, size) : wireOffset(index - 1, wireAlign(offset, size) + size, sizes...);
+}
+
+constexpr quint16 wireMaxAlign(quint16 alignment){
+    return alignment;
+}
+template<class... Sizes>
+constexpr quint16 wireMaxAlign(quint16 alignment, quint16 size, Sizes... sizes){
+    return wireMaxAlign(size > alignment ? size : alignment, sizes...);
+}
+
+
+/*------------------------*/
+/*Field decoding/encoding*/
+/*------------------------*/
+
+/*One memcpy sized load per field, the offset is a template argument so it is never computed at runtime*/
+template<class T, WireEndian endian>
+struct WireValue{
+    static T load(const uchar *data){
+        return endian == WireLittleEndian ? qFromLittleEndian<T>(data) : qFromBigEndian<T>(data);
+    }
+    static void store(T value, uchar *data){
+        if(endian == WireLittleEndian)
+            qToLittleEndian<T>(value, data);
+        else
+            qToBigEndian<T>(value, data);
+    }
+};
+
+template<WireEndian endian>
+struct WireValue<bool, endian>{
+    static bool load(const uchar *data){
+        return data[0] != 0;
+    }
+    static void store(bool value, uchar *data){
+        data[0] = value;
+    }
+};
+
+template<WireEndian endian>
+struct WireValue<float, endian>{
+    static float load(const uchar *data){
+        quint32 bits = WireValue<quint32, endian>::load(data);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    static void store(float value, uchar *data){
+        quint32 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        WireValue<quint32, endian>::store(bits, data);
+    }
+};
+
+template<class T, quint16 offset, WireEndian endian>
+inline T decodeWire(const uchar *data){
+    return WireValue<T, endian>::load(data + offset);
+}
+
+template<class T, quint16 offset, WireEndian endian>
+inline void encodeWire(uchar *data, T value){
+    WireValue<T, endian>::store(value, data + offset);
+}
+
+/*The scale is a literal, a scale of 1 folds away*/
+template<class T>
+inline T wireScale(T value, double scale){
+    return scale == 1 ? value : (T)(value * scale);
+}
+
+template<>
+inline bool wireScale<bool>(bool value, double){
+    return value;
+}
+
+/*Inverse of wireScale for encoding, used by simulators and benchmarks*/
+template<class T>
+inline T wireUnscale(T value, double scale){
+    return scale == 1 ? value : (T)(value / scale);
+}
+
+template<>
+inline bool wireUnscale<bool>(bool value, double){
+    return value;
+}
+
+
+/*------------------*/
+/*X-macro generators*/
+/*------------------*/
+
+#define PAYLOAD_FIELD_MEMBER(type, name, unit, scale, endian) type name;
+#define PAYLOAD_FIELD_INDEX(type, name, unit, scale, endian) name##Index,
+#define PAYLOAD_FIELD_SIZE(type, name, unit, scale, endian) , (quint16) sizeof(type)
+#define PAYLOAD_FIELD_INIT(type, name, unit, scale, endian) name = type();
+#define PAYLOAD_FIELD_DECODE(type, name, unit, scale, endian) \
+    name = wireScale<type>(decodeWire<type, Schema::offset(Schema::name##Index), Wire##endian##Endian>(payload.userData), scale);
+#define PAYLOAD_FIELD_ENCODE(type, name, unit, scale, endian) \
+    encodeWire<type, Schema::offset(Schema::name##Index), Wire##endian##Endian>(data, wireUnscale<type>(name, scale));
+#define PAYLOAD_FIELD_INFO(type, name, unit, scale, endian) \
+    {#name, unit, PayloadFieldTraits<type>::fieldType, scale, Wire##endian##Endian, offset(name##Index)},
+
+/*Schema struct of a topic: field indices, constexpr offsets, wire size and field descriptions*/
+#define PAYLOAD_SCHEMA(Schema, FIELDS) \
+    struct Schema{ \
+        enum Field{ FIELDS(PAYLOAD_FIELD_INDEX) fieldCount }; \
+        static constexpr quint16 offset(int field){ return wireOffset(field, 0 FIELDS(PAYLOAD_FIELD_SIZE)); } \
+        static constexpr quint16 size(){ return wireAlign(offset(fieldCount), wireMaxAlign(1 FIELDS(PAYLOAD_FIELD_SIZE))); } \
+        static const PayloadField fields[]; \
+    };
+
+/*Definitions for the .cpp file*/
+#define PAYLOAD_SCHEMA_FIELDS(Schema, FIELDS) \
+    const PayloadField Schema::fields[] = { FIELDS(PAYLOAD_FIELD_INFO) };
+
+#endif // PAYLOADSCHEMA_H
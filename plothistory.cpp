@@ -0,0 +1,94 @@
+#include "plothistory.h"
+#include "clocksync.h"
+
+PlotHistory::PlotHistory(QCustomPlot *plot, TelemetryQuery *query, double visibleTime, QObject *parent)
+    : QObject(parent), plot(plot), query(query), visibleTime(visibleTime), browsing(false), dragging(false)
+{
+    plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    plot->axisRect()->setRangeDrag(Qt::Horizontal);
+    plot->axisRect()->setRangeZoom(Qt::Horizontal);
+    connect(plot, SIGNAL(mousePress(QMouseEvent*)), this, SLOT(onMousePress(QMouseEvent*)));
+    connect(plot, SIGNAL(mouseMove(QMouseEvent*)), this, SLOT(onMouseMove(QMouseEvent*)));
+    connect(plot, SIGNAL(mouseRelease(QMouseEvent*)), this, SLOT(onMouseRelease()));
+    connect(plot, SIGNAL(mouseWheel(QWheelEvent*)), this, SLOT(onMouseWheel()));
+    connect(plot, SIGNAL(mouseDoubleClick(QMouseEvent*)), this, SLOT(follow()));
+    connect(plot->xAxis, SIGNAL(rangeChanged(QCPRange)), this, SLOT(onRangeChanged(QCPRange)));
+}
+
+
+void PlotHistory::addGraph(int graph, int channel, double scale){
+    if(channel < 0 || graph >= plot->graphCount())
+        return;
+    Binding binding = {graph, channel, scale};
+    bindings.append(binding);
+}
+
+
+bool PlotHistory::isBrowsing() const{
+    return browsing;
+}
+
+
+/*Back to the live view, the visible window is refilled from the store so it has no gap*/
+void PlotHistory::follow(){
+    browsing = false;
+    double now = groundSeconds(groundTime());
+    QCPRange range(now - visibleTime, now);
+    reload(range);
+    plot->xAxis->setRange(now + 0.25, visibleTime, Qt::AlignRight);
+    plot->replot();
+}
+
+
+/*A click alone keeps following, only moving the time axis starts browsing.
+ * The live updates change the range while the button is down as well, so the mouse has to move.
+ * QCustomPlot emits mouseMove before it drags the axis.*/
+void PlotHistory::onMousePress(QMouseEvent *event){
+    dragging = true;
+    pressPosition = event->pos();
+}
+
+void PlotHistory::onMouseMove(QMouseEvent *event){
+    if(dragging && event->pos() != pressPosition)
+        browsing = true;
+}
+
+void PlotHistory::onMouseRelease(){
+    dragging = false;
+}
+
+void PlotHistory::onMouseWheel(){
+    browsing = true;
+}
+
+
+void PlotHistory::onRangeChanged(const QCPRange &range){
+    if(!browsing)
+        return;
+    reload(range);
+    plot->replot();
+}
+
+
+/*Single samples are drawn as they are, aggregated buckets as their min and max*/
+void PlotHistory::reload(const QCPRange &range){
+    double origin = groundSeconds(0);
+    qint64 from = (qint64)((range.lower - origin) * 1e9);
+    qint64 to = (qint64)((range.upper - origin) * 1e9);
+    int resolution = qMax(1, plot->axisRect()->width());
+    for(int i = 0; i < bindings.size(); i++){
+        const Binding &binding = bindings.at(i);
+        QCPGraph *graph = plot->graph(binding.graph);
+        graph->clearData();
+        foreach(const TelemetryPoint &point, query->range(binding.channel, from, to, resolution)){
+            double key = groundSeconds(point.time);
+            if(point.count == 1){
+                graph->addData(key, point.mean * binding.scale);
+            }else{
+                graph->addData(key, point.min * binding.scale);
+                graph->addData(key, point.max * binding.scale);
+            }
+        }
+        graph->rescaleValueAxis(i > 0);
+    }
+}
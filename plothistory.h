@@ -0,0 +1,49 @@
+#ifndef PLOTHISTORY_H
+#define PLOTHISTORY_H
+
+#include <QObject>
+#include <QVector>
+
+#include "qcustomplot.h"
+#include "telemetryquery.h"
+
+/*Scrolling and zooming back in time on a live plot.
+ * Dragging or zooming the time axis stops following the live data, the graphs are then
+ * filled from the TelemetryQuery at the plot's pixel resolution. Double click follows again.*/
+class PlotHistory : public QObject
+{
+    Q_OBJECT
+
+public:
+    PlotHistory(QCustomPlot *plot, TelemetryQuery *query, double visibleTime, QObject *parent = 0);
+    void addGraph(int graph, int channel, double scale = 1);   /*graph shows channel * scale*/
+    bool isBrowsing() const;
+
+public slots:
+    void follow();
+
+private:
+    struct Binding{
+        int graph;
+        int channel;
+        double scale;
+    };
+    QCustomPlot *plot;
+    TelemetryQuery *query;
+    QVector<Binding> bindings;
+    double visibleTime;
+    bool browsing;
+    bool dragging;
+    QPoint pressPosition;
+
+    void reload(const QCPRange &range);
+
+private slots:
+    void onMousePress(QMouseEvent *event);
+    void onMouseMove(QMouseEvent *event);
+    void onMouseRelease();
+    void onMouseWheel();
+    void onRangeChanged(const QCPRange &range);
+};
+
+#endif // PLOTHISTORY_H
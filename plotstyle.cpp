@@ -0,0 +1,94 @@
+#include "plotstyle.h"
+
+#include <math.h>
+
+const StandardPlot standardPlots[StandardPlotCount] = {
+    {"Acceleration (g)", 3, {"x", "y", "z"},
+     {"SensorIMU.ax", "SensorIMU.ay", "SensorIMU.az"}, 0.001},
+    {"Angular Speed (deg/sec)", 3, {"x", "y", "z"},
+     {"SensorIMU.wx", "SensorIMU.wy", "SensorIMU.wz"}, 180 / M_PI},
+    {"Heading (deg)", 3, {"Xm", "Gyro", "Combined"},
+     {"SensorIMU.headingXm", "SensorIMU.headingGyro", "SensorIMU.headingFusion"}, 180 / M_PI},
+    {"Lightsensor Data", 1, {0, 0, 0},
+     {"Light.lightValue", 0, 0}, 1}
+};
+
+
+void setupStandardPlot(QCustomPlot *plot, const StandardPlot &definition, const QFont &font){
+    static const Qt::GlobalColor colors[PLOT_MAX_GRAPHS] = {Qt::yellow, Qt::red, Qt::green};
+
+    /*Defining fonts*/
+    QFont legendFont = font;
+    legendFont.setPointSize(7);
+
+    QFont labelFont1 = font;
+    labelFont1.setPointSize(9);
+
+    /*Defining grey gradients*/
+    QLinearGradient plotGradient;
+    plotGradient.setStart(0, 0);
+    plotGradient.setFinalStop(0, 350);
+    plotGradient.setColorAt(0, QColor(120, 120, 120));
+    plotGradient.setColorAt(1, QColor(80, 80, 80));
+
+    QLinearGradient axisRectGradient;
+    axisRectGradient.setStart(0, 0);
+    axisRectGradient.setFinalStop(0, 350);
+    axisRectGradient.setColorAt(0, QColor(120, 120, 120));
+    axisRectGradient.setColorAt(1, QColor(80, 80, 80));
+
+    plot->xAxis->setLabel("Current Time");
+    plot->xAxis->setTickLabelType(QCPAxis::ltDateTime);
+    plot->xAxis->setDateTimeFormat("hh:mm:ss");
+    plot->xAxis->setAutoTickStep(false);
+    plot->xAxis->setTickStep(XAXIS_TICKSTEP);
+    plot->yAxis->setLabel(definition.valueLabel);
+    plot->xAxis->setLabelFont(labelFont1);
+    plot->yAxis->setLabelFont(labelFont1);
+    plot->axisRect()->setupFullAxesBox();
+    if(definition.graphNames[0]){
+        plot->legend->setVisible(true);
+        plot->legend->setFont(legendFont);
+        plot->legend->setBrush(QBrush(QColor(255,255,255,230)));
+        plot->legend->setIconSize(10,5);
+        plot->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignBottom|Qt::AlignLeft);
+    }
+    for(int i = 0; i < definition.graphCount; i++){
+        plot->addGraph();
+        plot->graph(i)->setPen(QPen(colors[i]));
+        if(definition.graphNames[i])
+            plot->graph(i)->setName(definition.graphNames[i]);
+    }
+    plot->xAxis->setBasePen(QPen(Qt::white, 1));
+    plot->xAxis2->setBasePen(QPen(Qt::white, 1));
+    plot->yAxis->setBasePen(QPen(Qt::white, 1));
+    plot->yAxis2->setBasePen(QPen(Qt::white, 1));
+    plot->xAxis->setTickPen(QPen(Qt::white, 1));
+    plot->xAxis2->setTickPen(QPen(Qt::white, 1));
+    plot->yAxis->setTickPen(QPen(Qt::white, 1));
+    plot->yAxis2->setTickPen(QPen(Qt::white, 1));
+    plot->xAxis->setSubTickPen(QPen(Qt::white, 1));
+    plot->xAxis2->setSubTickPen(QPen(Qt::white, 1));
+    plot->yAxis->setSubTickPen(QPen(Qt::white, 1));
+    plot->yAxis2->setSubTickPen(QPen(Qt::white, 1));
+    plot->xAxis->setTickLabelColor(Qt::white);
+    plot->yAxis->setTickLabelColor(Qt::white);
+    plot->xAxis->setLabelColor(Qt::white);
+    plot->yAxis->setLabelColor(Qt::white);
+    plot->legend->setBorderPen(QPen(Qt::white, 1));
+    plot->legend->setTextColor(Qt::white);
+    plot->legend->setBrush(plotGradient);
+    plot->xAxis->grid()->setPen(QPen(QColor(140, 140, 140), 1, Qt::DotLine));
+    plot->yAxis->grid()->setPen(QPen(QColor(140, 140, 140), 1, Qt::DotLine));
+    plot->xAxis->grid()->setSubGridPen(QPen(QColor(80, 80, 80), 1, Qt::DotLine));
+    plot->yAxis->grid()->setSubGridPen(QPen(QColor(80, 80, 80), 1, Qt::DotLine));
+    plot->xAxis->grid()->setSubGridVisible(true);
+    plot->yAxis->grid()->setSubGridVisible(true);
+    plot->xAxis->grid()->setZeroLinePen(Qt::NoPen);
+    plot->yAxis->grid()->setZeroLinePen(Qt::NoPen);
+    plot->setBackground(plotGradient);
+    plot->axisRect()->setBackground(axisRectGradient);
+    /*make left and bottom axes transfer their ranges to right and top axes*/
+    QObject::connect(plot->xAxis, SIGNAL(rangeChanged(QCPRange)), plot->xAxis2, SLOT(setRange(QCPRange)));
+    QObject::connect(plot->yAxis, SIGNAL(rangeChanged(QCPRange)), plot->yAxis2, SLOT(setRange(QCPRange)));
+}
@@ -0,0 +1,33 @@
+#ifndef PLOTSTYLE_H
+#define PLOTSTYLE_H
+
+#include <QFont>
+
+#include "qcustomplot.h"
+
+#define XAXIS_TICKSTEP 5
+#define PLOT_MAX_GRAPHS 3
+
+/*The telemetry plots of the ground station window, shared with the offline report*/
+enum StandardPlotId{
+    PlotAccelerometer,
+    PlotGyroscope,
+    PlotHeading,
+    PlotSunFinder,
+    StandardPlotCount
+};
+
+struct StandardPlot{
+    const char *valueLabel;
+    int graphCount;
+    const char *graphNames[PLOT_MAX_GRAPHS];    /*0 for plots without legend*/
+    const char *channels[PLOT_MAX_GRAPHS];      /*dictionary channel of every graph*/
+    double scale;                               /*channel value -> plotted value*/
+};
+
+extern const StandardPlot standardPlots[StandardPlotCount];
+
+/*Grey gradient theme with white axes, date time axis and one colored graph per channel*/
+void setupStandardPlot(QCustomPlot *plot, const StandardPlot &definition, const QFont &font);
+
+#endif // PLOTSTYLE_H
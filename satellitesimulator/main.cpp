@@ -0,0 +1,104 @@
+#include "satellitesimulator.h"
+#include "connection.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QStringList>
+#include <QDateTime>
+#include <stdio.h>
+
+/*Topic names of --rate*/
+static bool parseTopic(const QString &name, PayloadType &type){
+    static const struct { const char *name; PayloadType type; } names[] = {
+        {"counter", PayloadCounterType},
+        {"imu", PayloadSensorIMUType},
+        {"electrical", PayloadElectricalType},
+        {"mission", PayloadMissionType},
+        {"light", PayloadLightType}
+    };
+    for(unsigned i = 0; i < sizeof(names) / sizeof(names[0]); i++){
+        if(name == QLatin1String(names[i].name)){
+            type = names[i].type;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*"imu=20000,light=100", topics not mentioned keep their rate*/
+static bool parseRates(const QString &text, SatelliteSimulator &simulator){
+    foreach(const QString &entry, text.split(',', QString::SkipEmptyParts)){
+        QStringList parts = entry.split('=');
+        PayloadType type;
+        bool ok = false;
+        double rate = parts.size() == 2 ? parts.at(1).toDouble(&ok) : 0;
+        if(!ok || !parseTopic(parts.at(0).trimmed(), type)){
+            fprintf(stderr, "Invalid rate \"%s\"\n", qPrintable(entry));
+            return false;
+        }
+        simulator.setRate(type, rate);
+    }
+    return true;
+}
+
+static double percent(const QCommandLineParser &parser, const char *name){
+    return qBound(0.0, parser.value(name).toDouble(), 100.0) / 100;
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Publishes synthetic RODOS telemetry to the ground station and acknowledges its telecommands.\n"
+                                     "Start the ground station with --local 127.0.0.1 --satellite 127.0.0.2 to use it on one machine.");
+    parser.addHelpOption();
+    parser.addOptions(QList<QCommandLineOption>()
+        << QCommandLineOption("local", "Address of the simulated satellite.", "address", "127.0.0.2")
+        << QCommandLineOption("ground", "Address of the ground station.", "address", "127.0.0.1")
+        << QCommandLineOption("port", "UDP port of both sides.", "port", QString::number(PORT))
+        << QCommandLineOption("rate", "Frames per second per topic, e.g. imu=20000,light=100. "
+                                      "Topics: counter, imu, electrical, mission, light.", "rates")
+        << QCommandLineOption("burst", "Frames of a topic sent back to back, the average rate stays.", "frames", "1")
+        << QCommandLineOption("duty", "Publish for <on> ms, then stay silent for <off> ms.", "on:off")
+        << QCommandLineOption("loss", "Percentage of frames not sent.", "percent", "0")
+        << QCommandLineOption("reorder", "Percentage of frames sent after their successor.", "percent", "0")
+        << QCommandLineOption("corrupt", "Percentage of frames with a flipped bit behind the checksum.", "percent", "0")
+        << QCommandLineOption("duration", "Seconds to run, until interrupted by default.", "seconds", "0")
+        << QCommandLineOption("seed", "Seed of the fault injection and noise.", "number"));
+    parser.process(a);
+
+    /*Rates of the real satellite unless told otherwise*/
+    SatelliteSimulator simulator;
+    simulator.setRate(PayloadCounterType, 1);
+    simulator.setRate(PayloadSensorIMUType, 50);
+    simulator.setRate(PayloadElectricalType, 2);
+    simulator.setRate(PayloadMissionType, 1);
+    simulator.setRate(PayloadLightType, 20);
+    if(parser.isSet("rate") && !parseRates(parser.value("rate"), simulator))
+        return 1;
+
+    simulator.setBurst(parser.value("burst").toInt());
+    if(parser.isSet("duty")){
+        QStringList duty = parser.value("duty").split(':');
+        if(duty.size() != 2){
+            fprintf(stderr, "Invalid duty cycle \"%s\"\n", qPrintable(parser.value("duty")));
+            return 1;
+        }
+        simulator.setDutyCycle(duty.at(0).toInt(), duty.at(1).toInt());
+    }
+    simulator.setLoss(percent(parser, "loss"));
+    simulator.setReordering(percent(parser, "reorder"));
+    simulator.setCorruption(percent(parser, "corrupt"));
+    qsrand(parser.isSet("seed") ? parser.value("seed").toUInt() : (uint) QDateTime::currentMSecsSinceEpoch());
+
+    QString error;
+    if(!simulator.bind(QHostAddress(parser.value("local")), QHostAddress(parser.value("ground")), parser.value("port").toUShort(), &error)){
+        fprintf(stderr, "Binding to %s failed: %s\n", qPrintable(parser.value("local")), qPrintable(error));
+        return 1;
+    }
+    QObject::connect(&simulator, SIGNAL(finished()), &a, SLOT(quit()));
+    simulator.start(parser.value("duration").toInt());
+
+    return a.exec();
+}
@@ -0,0 +1,260 @@
+#include "satellitesimulator.h"
+#include "connection.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static const PayloadType simulatedTypes[SIMULATOR_TOPIC_COUNT] = {
+    PayloadCounterType, PayloadSensorIMUType, PayloadElectricalType, PayloadMissionType, PayloadLightType
+};
+
+SimulatedTopic::SimulatedTopic() : type(PayloadCounterType), rate(0), due(0), published(0), sent(0){
+}
+
+SimulatorStatistics::SimulatorStatistics() : sent(0), lost(0), reordered(0), corrupted(0), sendErrors(0), telecommands(0){
+}
+
+
+SatelliteSimulator::SatelliteSimulator(QObject *parent)
+    : QObject(parent), socket(this), port(PORT), duration(0), burst(1), onTime(0), offTime(0), loss(0), reordering(0), corruption(0), frame(RODOS_FRAME_SIZE, 0x00){
+    for(int i = 0; i < SIMULATOR_TOPIC_COUNT; i++){
+        topics[i].type = simulatedTypes[i];
+    }
+    tickTimer.setInterval(SIMULATOR_TICK);
+    tickTimer.setTimerType(Qt::PreciseTimer);
+    connect(&tickTimer, SIGNAL(timeout()), this, SLOT(tick()));
+    reportTimer.setInterval(1000);
+    connect(&reportTimer, SIGNAL(timeout()), this, SLOT(report()));
+    connect(&socket, SIGNAL(readyRead()), this, SLOT(receiveTelecommands()));
+}
+
+
+/*The ground station sends telecommands to the port it listens on itself, so on one machine
+ * the simulator needs an address of its own, e.g. 127.0.0.2*/
+bool SatelliteSimulator::bind(const QHostAddress &local, const QHostAddress &ground, quint16 port, QString *error){
+    groundAddress = ground;
+    this->port = port;
+    if(!socket.bind(local, port)){
+        *error = socket.errorString();
+        return false;
+    }
+    return true;
+}
+
+
+void SatelliteSimulator::setRate(PayloadType topic, double rate){
+    for(int i = 0; i < SIMULATOR_TOPIC_COUNT; i++){
+        if(topics[i].type == topic)
+            topics[i].rate = qMax(0.0, rate);
+    }
+}
+
+void SatelliteSimulator::setBurst(int frames){
+    burst = qMax(1, frames);
+}
+
+void SatelliteSimulator::setDutyCycle(int onTime, int offTime){
+    this->onTime = qMax(0, onTime);
+    this->offTime = qMax(0, offTime);
+}
+
+void SatelliteSimulator::setLoss(double probability){
+    loss = probability;
+}
+
+void SatelliteSimulator::setReordering(double probability){
+    reordering = probability;
+}
+
+void SatelliteSimulator::setCorruption(double probability){
+    corruption = probability;
+}
+
+
+void SatelliteSimulator::start(int duration){
+    this->duration = (qint64) duration * 1000000000;
+    clock.start();
+    tickTimer.start();
+    reportTimer.start();
+}
+
+
+/*Catches up on every frame due since the last tick, a timer cannot fire at tens of kHz*/
+void SatelliteSimulator::tick(){
+    qint64 now = clock.nsecsElapsed();
+    if(duration > 0 && now >= duration){
+        tickTimer.stop();
+        reportTimer.stop();
+        if(!heldFrame.isEmpty())
+            transmit(heldFrame);
+        report();
+        emit finished();
+        return;
+    }
+
+    /*Nothing is sampled in the silent part of the duty cycle*/
+    bool silent = offTime > 0 && (now / 1000000) % (onTime + offTime) >= onTime;
+    for(int i = 0; i < SIMULATOR_TOPIC_COUNT; i++){
+        SimulatedTopic &topic = topics[i];
+        if(topic.rate <= 0)
+            continue;
+        topic.due = (quint64)(now * topic.rate / 1e9);
+        if(silent){
+            topic.published = topic.due;
+            continue;
+        }
+        while(topic.due - topic.published >= (quint64) burst){
+            for(int b = 0; b < burst; b++){
+                publish(topic, topic.published++);
+            }
+        }
+    }
+}
+
+
+void SatelliteSimulator::publish(SimulatedTopic &topic, quint64 index){
+    uchar data[RODOS_FRAME_SIZE - RODOS_HEADER_SIZE];
+    double time = index / topic.rate;
+    int length = encodeSample(topic.type, index, time, data);
+    uchar *bytes = (uchar*) frame.data();
+    writeRodosFrame(bytes, topic.type, (quint64)(time * 1e9), data, length);
+
+    if(chance(loss)){
+        statistics.lost++;
+        return;
+    }
+    if(chance(corruption)){
+        int bit = qrand() % ((RODOS_HEADER_SIZE + length) * 8);
+        bytes[bit / 8] ^= 1 << (bit % 8);
+        statistics.corrupted++;
+    }
+    topic.sent++;
+    if(heldFrame.isEmpty() && chance(reordering)){
+        heldFrame = frame;
+        statistics.reordered++;
+        return;
+    }
+    transmit(frame);
+    if(!heldFrame.isEmpty()){
+        transmit(heldFrame);
+        heldFrame.clear();
+    }
+}
+
+
+/*Smooth synthetic signals with a little noise, so the plots of the ground station show something*/
+int SatelliteSimulator::encodeSample(PayloadType type, quint64 index, double time, uchar *data){
+    double noise = (qrand() % 2001 - 1000) / 1000.0;
+    switch(type){
+    case PayloadCounterType:{
+        PayloadCounter counter;
+        counter.counter = (qint32) index;
+        return counter.encode(data);
+    }
+    case PayloadSensorIMUType:{
+        PayloadSensorIMU imu;
+        double heading = fmod(0.3 * time, 2 * M_PI) - M_PI;
+        imu.ax = 20 * sin(M_PI * time) + noise;
+        imu.ay = 20 * cos(M_PI * time) + noise;
+        imu.az = 1000 + 5 * sin(6 * M_PI * time) + noise;
+        imu.wx = 0.01 * noise;
+        imu.wy = 0.01 * noise;
+        imu.wz = 0.3 + 0.05 * sin(0.2 * M_PI * time);
+        imu.roll = 0.05 * sin(0.4 * M_PI * time);
+        imu.pitch = 0.05 * cos(0.4 * M_PI * time);
+        imu.headingFusion = heading;
+        imu.headingXm = heading + 0.02 * noise;
+        imu.headingGyro = heading + 0.001 * time;
+        imu.calibrationActive = false;
+        return imu.encode(data);
+    }
+    case PayloadElectricalType:{
+        PayloadElectrical electrical;
+        electrical.lightsensorOn = true;
+        electrical.electromagnetOn = (index / 20) % 2;
+        electrical.thermalKnifeOn = false;
+        electrical.racksOut = time > 30;
+        electrical.solarPanelsOut = time > 10;
+        electrical.batteryCurrent = 350 + 50 * sin(0.1 * M_PI * time) + noise;
+        electrical.batteryVoltage = qMax(6.4, 8.2 - 0.0005 * time) + 0.01 * noise;
+        electrical.solarPanelCurrent = electrical.solarPanelsOut ? 120 + 20 * noise : 0;
+        electrical.solarPanelVoltage = electrical.solarPanelsOut ? 5.5 + 0.1 * noise : 0;
+        return electrical.encode(data);
+    }
+    case PayloadMissionType:{
+        PayloadMission mission;
+        mission.partNumber = (qint32)(index % 8);
+        mission.angle = fmod(10 * time, 360);
+        mission.isCleaned = (index / 8) % 2;
+        return mission.encode(data);
+    }
+    case PayloadLightType:{
+        PayloadLight light;
+        light.lightValue = (quint16)(2000 + 1800 * sin(0.1 * M_PI * time) + 20 * noise);
+        return light.encode(data);
+    }
+    }
+    return 0;
+}
+
+
+void SatelliteSimulator::transmit(const QByteArray &datagram){
+    if(socket.writeDatagram(datagram, groundAddress, port) < 0)
+        statistics.sendErrors++;
+    else
+        statistics.sent++;
+}
+
+
+/*Only checksummed telecommands are accepted, like on board*/
+void SatelliteSimulator::receiveTelecommands(){
+    QByteArray buffer(RODOS_FRAME_SIZE, 0x00);
+    const uchar *header = (const uchar*) buffer.constData();
+    while(socket.hasPendingDatagrams()){
+        qint64 size = socket.readDatagram(buffer.data(), buffer.size());
+        if(size < RODOS_HEADER_SIZE)
+            continue;
+        PayloadSatellite payload(buffer);
+        if(payload.topic != TELECOMMAND_TOPIC_ID || payload.userDataLen < sizeof(Command))
+            continue;
+        if(rodosChecksum(header, RODOS_HEADER_SIZE + payload.userDataLen) != payload.checksum){
+            fprintf(stderr, "Telecommand with wrong checksum dropped\n");
+            continue;
+        }
+        Command telecommand(0, 0, 0);
+        memcpy(&telecommand, payload.userData, sizeof(Command));
+        acknowledge(telecommand);
+    }
+}
+
+
+/*The acknowledgement echoes the command on its own topic*/
+void SatelliteSimulator::acknowledge(const Command &telecommand){
+    QByteArray ack(RODOS_FRAME_SIZE, 0x00);
+    writeRodosFrame((uchar*) ack.data(), TELECOMMAND_ACK_TOPIC_ID, clock.nsecsElapsed(), (const uchar*) &telecommand, sizeof(Command));
+    socket.writeDatagram(ack, groundAddress, port);
+    statistics.telecommands++;
+    printf("TC %d identifier %d value %d acknowledged\n", telecommand.id, telecommand.identifier, telecommand.value);
+    fflush(stdout);
+}
+
+
+/*Frames per second since the last report*/
+void SatelliteSimulator::report(){
+    printf("%.1f s: %llu frames/s sent, %llu lost, %llu reordered, %llu corrupted, %llu send errors, %llu telecommands\n",
+           clock.nsecsElapsed() / 1e9,
+           statistics.sent - lastStatistics.sent,
+           statistics.lost - lastStatistics.lost,
+           statistics.reordered - lastStatistics.reordered,
+           statistics.corrupted - lastStatistics.corrupted,
+           statistics.sendErrors - lastStatistics.sendErrors,
+           statistics.telecommands - lastStatistics.telecommands);
+    fflush(stdout);
+    lastStatistics = statistics;
+}
+
+
+bool SatelliteSimulator::chance(double probability){
+    return probability > 0 && qrand() < probability * ((double) RAND_MAX + 1);
+}
@@ -0,0 +1,91 @@
+#ifndef SATELLITESIMULATOR_H
+#define SATELLITESIMULATOR_H
+
+#include <QObject>
+#include <QUdpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QByteArray>
+
+#include "payload.h"
+
+#define SIMULATOR_TICK 1                /*ms, frames due since the last tick are sent together*/
+#define SIMULATOR_TOPIC_COUNT 5
+
+/*One published topic. Frame n is sampled at n / rate seconds on the on-board clock,
+ * so the rate holds on average however late the ticks come.*/
+struct SimulatedTopic{
+    PayloadType type;
+    double rate;                /*frames per second, 0 switches the topic off*/
+    quint64 due;                /*frames that should have been published by now*/
+    quint64 published;          /*frames handled, sent or deliberately lost*/
+    quint64 sent;
+    SimulatedTopic();
+};
+
+/*Counters since the start, printed once per second*/
+struct SimulatorStatistics{
+    quint64 sent;
+    quint64 lost;
+    quint64 reordered;
+    quint64 corrupted;
+    quint64 sendErrors;
+    quint64 telecommands;
+    SimulatorStatistics();
+};
+
+/*Publishes synthetic telemetry of every topic as RODOS frames and answers telecommands.
+ * Faults are injected per frame after the checksum was written: a lost frame is not sent,
+ * a reordered one is held back until the next frame of any topic went out and a corrupted
+ * one gets a flipped bit anywhere in the header or user data.*/
+class SatelliteSimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SatelliteSimulator(QObject *parent = 0);
+    bool bind(const QHostAddress &local, const QHostAddress &ground, quint16 port, QString *error);
+    void setRate(PayloadType topic, double rate);
+    void setBurst(int frames);                  /*frames sent back to back, the average rate stays*/
+    void setDutyCycle(int onTime, int offTime); /*ms publishing, then ms silent*/
+    void setLoss(double probability);
+    void setReordering(double probability);
+    void setCorruption(double probability);
+    void start(int duration);                   /*s, 0 runs until interrupted*/
+
+signals:
+    void finished();
+
+private slots:
+    void tick();
+    void receiveTelecommands();
+    void report();
+
+private:
+    QUdpSocket socket;
+    QHostAddress groundAddress;
+    quint16 port;
+    QTimer tickTimer;
+    QTimer reportTimer;
+    QElapsedTimer clock;
+    qint64 duration;                            /*ns*/
+    SimulatedTopic topics[SIMULATOR_TOPIC_COUNT];
+    int burst;
+    int onTime;
+    int offTime;
+    double loss;
+    double reordering;
+    double corruption;
+    QByteArray frame;
+    QByteArray heldFrame;                       /*reordered frame waiting for its successor*/
+    SimulatorStatistics statistics;
+    SimulatorStatistics lastStatistics;
+
+    void publish(SimulatedTopic &topic, quint64 index);
+    int encodeSample(PayloadType type, quint64 index, double time, uchar *data);
+    void transmit(const QByteArray &datagram);
+    void acknowledge(const Command &telecommand);
+    static bool chance(double probability);
+};
+
+#endif // SATELLITESIMULATOR_H
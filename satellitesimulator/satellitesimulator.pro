@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# Stand-in for the satellite: publishes RODOS frames over UDP
+# and acknowledges telecommands
+#
+#-------------------------------------------------
+
+QT       += core \
+            network
+QT       -= gui
+
+TARGET = satellitesimulator
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    satellitesimulator.cpp \
+    ../payload.cpp
+
+HEADERS  += satellitesimulator.h \
+    ../payload.h \
+    ../payloadschema.h
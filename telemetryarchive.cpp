@@ -0,0 +1,369 @@
+#include "telemetryarchive.h"
+#include "telemetrycodec.h"
+#include "logger.h"
+#include "clocksync.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QThread>
+#include <QtConcurrent>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+
+TelemetryArchive::TelemetryArchive(const TelemetryDictionary *dictionary) : dictionary(dictionary), spanCheckTime(LLONG_MAX){
+    pending.resize(dictionary->topicCount());
+    for(int i = 0; i < dictionary->topicCount(); i++){
+        topicIndex.insert(dictionary->topicAt(i).id, i);
+    }
+}
+
+TelemetryArchive::~TelemetryArchive(){
+    close();
+}
+
+
+bool TelemetryArchive::open(const QString &fileName){
+    close();
+    file.setFileName(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    /*Channel names let later dictionaries find their columns again*/
+    QJsonArray topics;
+    for(int i = 0; i < dictionary->topicCount(); i++){
+        const TelemetryTopic &topic = dictionary->topicAt(i);
+        QJsonArray channels;
+        for(int c = 0; c < topic.opCount; c++){
+            channels.append(dictionary->channel(topic.firstOp + c).name);
+        }
+        QJsonObject object;
+        object.insert("id", (int) topic.id);
+        object.insert("channels", channels);
+        topics.append(object);
+    }
+    QJsonObject root;
+    root.insert("topics", topics);
+    QByteArray names = QJsonDocument(root).toJson(QJsonDocument::Compact);
+
+    TelemetryArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TELEMETRY_ARCHIVE_MAGIC;
+    header.version = TELEMETRY_ARCHIVE_VERSION;
+    header.dictionaryBytes = names.size();
+    header.wallClockStart = groundWallClock(0);
+    if(file.write((const char*)&header, sizeof(header)) != sizeof(header) || file.write(names) != names.size()){
+        file.close();
+        return false;
+    }
+    file.flush();
+    return true;
+}
+
+
+void TelemetryArchive::close(){
+    if(!file.isOpen())
+        return;
+    flush();
+    file.close();
+}
+
+
+void TelemetryArchive::flush(){
+    for(int i = 0; i < pending.size(); i++){
+        writeBlock(dictionary->topicAt(i), pending[i]);
+    }
+    spanCheckTime = LLONG_MAX;
+}
+
+
+QString TelemetryArchive::fileName() const{
+    return file.fileName();
+}
+
+
+qint64 TelemetryArchive::size() const{
+    return file.size();
+}
+
+
+void TelemetryArchive::writeSample(const TelemetryTopic &topic, qint64 time, const float *values){
+    int index = topicIndex.value(topic.id, -1);
+    if(index < 0 || !file.isOpen())
+        return;
+    if(time >= spanCheckTime)
+        writeSpannedBlocks(time);
+    PendingBlock &block = pending[index];
+    if(block.times.isEmpty())
+        spanCheckTime = qMin(spanCheckTime, time + TELEMETRY_BLOCK_SPAN);
+    block.times.append(time);
+    for(int i = 0; i < topic.opCount; i++){
+        block.values.append(values[i]);
+    }
+    if(block.times.size() >= TELEMETRY_BLOCK_ROWS)
+        writeBlock(topic, block);
+}
+
+
+/*Blocks of all topics, also of those without new samples*/
+void TelemetryArchive::writeSpannedBlocks(qint64 time){
+    spanCheckTime = LLONG_MAX;
+    for(int i = 0; i < pending.size(); i++){
+        PendingBlock &block = pending[i];
+        if(block.times.isEmpty())
+            continue;
+        if(time - block.times.first() >= TELEMETRY_BLOCK_SPAN)
+            writeBlock(dictionary->topicAt(i), block);
+        else
+            spanCheckTime = qMin(spanCheckTime, block.times.first() + TELEMETRY_BLOCK_SPAN);
+    }
+}
+
+
+void TelemetryArchive::writeBlock(const TelemetryTopic &topic, PendingBlock &block){
+    int rows = block.times.size();
+    if(!rows || !file.isOpen())
+        return;
+    int channels = topic.opCount;
+
+    QByteArray timeStream = encodeTimestamps(block.times.constData(), rows);
+    QVector<QByteArray> streams(channels);
+    QVector<quint32> channelBytes(channels);
+    QVector<TelemetryBlockRange> ranges(channels);
+    int size = sizeof(TelemetryBlockHeader) + channels * (sizeof(quint32) + sizeof(TelemetryBlockRange)) + timeStream.size();
+    for(int c = 0; c < channels; c++){
+        const float *column = block.values.constData() + c;
+        streams[c] = encodeFloats(column, rows, channels);
+        channelBytes[c] = streams.at(c).size();
+        size += streams.at(c).size();
+        TelemetryBlockRange range = {column[0], column[0]};
+        for(int r = 1; r < rows; r++){
+            range.min = qMin(range.min, column[r * channels]);
+            range.max = qMax(range.max, column[r * channels]);
+        }
+        ranges[c] = range;
+    }
+
+    TelemetryBlockHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TELEMETRY_BLOCK_MAGIC;
+    header.topic = topic.id;
+    header.rows = rows;
+    header.channels = channels;
+    header.size = size;
+    header.timeBytes = timeStream.size();
+    header.firstTime = block.times.first();
+    header.lastTime = block.times.last();
+
+    QByteArray bytes;
+    bytes.reserve(size);
+    bytes.append((const char*)&header, sizeof(header));
+    bytes.append((const char*)channelBytes.constData(), channels * sizeof(quint32));
+    bytes.append(timeStream);
+    for(int c = 0; c < channels; c++){
+        bytes.append(streams.at(c));
+    }
+    bytes.append((const char*)ranges.constData(), channels * sizeof(TelemetryBlockRange));
+
+    block.times.clear();
+    block.values.clear();
+    if(file.write(bytes) != bytes.size()){
+        Logger::post(LogError, LogArchive, MsgTelemetryArchiveWriteFailed, file.fileName());
+        return;
+    }
+    file.flush();
+}
+
+
+TelemetryArchiveReader::TelemetryArchiveReader() : map(0), wallStart(0){
+}
+
+TelemetryArchiveReader::~TelemetryArchiveReader(){
+    close();
+}
+
+
+/*Maps the file and indexes the blocks by walking their headers, no stream is decoded*/
+bool TelemetryArchiveReader::open(const QString &fileName, QString *error){
+    close();
+    file.setFileName(fileName);
+    if(!file.open(QIODevice::ReadOnly)){
+        *error = file.errorString();
+        return false;
+    }
+    qint64 fileSize = file.size();
+    TelemetryArchiveHeader header;
+    if(fileSize < (qint64) sizeof(header) || !(map = file.map(0, fileSize))){
+        *error = "Not a telemetry archive";
+        close();
+        return false;
+    }
+    memcpy(&header, map, sizeof(header));
+    if(header.magic != TELEMETRY_ARCHIVE_MAGIC || header.version != TELEMETRY_ARCHIVE_VERSION
+            || sizeof(header) + (qint64) header.dictionaryBytes > fileSize){
+        *error = "Not a telemetry archive or unsupported version";
+        close();
+        return false;
+    }
+
+    wallStart = header.wallClockStart;
+    QByteArray names = QByteArray::fromRawData((const char*)map + sizeof(header), header.dictionaryBytes);
+    foreach(const QJsonValue &value, QJsonDocument::fromJson(names).object().value("topics").toArray()){
+        QJsonObject topic = value.toObject();
+        QStringList channels;
+        foreach(const QJsonValue &channel, topic.value("channels").toArray()){
+            channels.append(channel.toString());
+        }
+        topicChannels.insert((quint32) topic.value("id").toInt(), channels);
+    }
+
+    qint64 offset = sizeof(header) + header.dictionaryBytes;
+    while(offset + (qint64) sizeof(TelemetryBlockHeader) <= fileSize){
+        TelemetryBlockHeader blockHeader;
+        memcpy(&blockHeader, map + offset, sizeof(blockHeader));
+        qint64 tableBytes = blockHeader.channels * (qint64)(sizeof(quint32) + sizeof(TelemetryBlockRange));
+        if(blockHeader.magic != TELEMETRY_BLOCK_MAGIC || blockHeader.size < sizeof(blockHeader) + tableBytes
+                || offset + blockHeader.size > fileSize)
+            break;
+
+        TelemetryArchiveBlock block;
+        block.topic = blockHeader.topic;
+        block.rows = blockHeader.rows;
+        block.firstTime = blockHeader.firstTime;
+        block.lastTime = blockHeader.lastTime;
+        block.offset = offset;
+        block.ranges.resize(blockHeader.channels);
+        memcpy(block.ranges.data(), map + offset + blockHeader.size - blockHeader.channels * sizeof(TelemetryBlockRange),
+               blockHeader.channels * sizeof(TelemetryBlockRange));
+        blocks.append(block);
+        offset += blockHeader.size;
+    }
+    return true;
+}
+
+
+void TelemetryArchiveReader::close(){
+    if(map)
+        file.unmap(map);
+    map = 0;
+    blocks.clear();
+    topicChannels.clear();
+    if(file.isOpen())
+        file.close();
+}
+
+
+int TelemetryArchiveReader::blockCount() const{
+    return blocks.size();
+}
+
+const TelemetryArchiveBlock &TelemetryArchiveReader::block(int index) const{
+    return blocks.at(index);
+}
+
+QStringList TelemetryArchiveReader::channelNames(quint32 topic) const{
+    return topicChannels.value(topic);
+}
+
+qint64 TelemetryArchiveReader::wallClockStart() const{
+    return wallStart;
+}
+
+
+/*Columns of one decoded block, values are column major*/
+struct DecodedTelemetryBlock{
+    bool valid;
+    QVector<qint64> times;
+    QVector<float> values;
+};
+
+struct TelemetryBlockDecoder{
+    typedef DecodedTelemetryBlock result_type;
+    const uchar *map;
+    const QVector<TelemetryArchiveBlock> *blocks;
+
+    DecodedTelemetryBlock operator()(int index) const{
+        DecodedTelemetryBlock decoded;
+        const TelemetryArchiveBlock &block = blocks->at(index);
+        TelemetryBlockHeader header;
+        memcpy(&header, map + block.offset, sizeof(header));
+        const uchar *table = map + block.offset + sizeof(header);
+        const uchar *stream = table + header.channels * sizeof(quint32);
+        const uchar *end = map + block.offset + header.size - header.channels * sizeof(TelemetryBlockRange);
+
+        decoded.times.resize(header.rows);
+        decoded.values.resize(header.rows * header.channels);
+        decoded.valid = stream + header.timeBytes <= end
+                && decodeTimestamps(stream, header.timeBytes, decoded.times.data(), header.rows);
+        stream += header.timeBytes;
+        for(int c = 0; c < header.channels && decoded.valid; c++){
+            quint32 bytes;
+            memcpy(&bytes, table + c * sizeof(quint32), sizeof(bytes));
+            decoded.valid = stream + bytes <= end
+                    && decodeFloats(stream, bytes, decoded.values.data() + c * header.rows, header.rows);
+            stream += bytes;
+        }
+        return decoded;
+    }
+};
+
+
+bool TelemetryArchiveReader::loadInto(TelemetryStore *store, const TelemetryDictionary *dictionary, QString *error) const{
+    if(!map){
+        *error = "No archive open";
+        return false;
+    }
+
+    /*Archive column of every dictionary channel, -1 if the archive does not have it*/
+    QHash<quint32, QVector<int> > columns;
+    for(int i = 0; i < dictionary->topicCount(); i++){
+        const TelemetryTopic &topic = dictionary->topicAt(i);
+        QStringList names = topicChannels.value(topic.id);
+        QVector<int> topicColumns(topic.opCount);
+        for(int c = 0; c < topic.opCount; c++){
+            topicColumns[c] = names.indexOf(dictionary->channel(topic.firstOp + c).name);
+        }
+        columns.insert(topic.id, topicColumns);
+    }
+
+    /*Batches keep the decoded data small while all cores decode*/
+    TelemetryBlockDecoder decoder = {map, &blocks};
+    int batchSize = qMax(1, QThread::idealThreadCount()) * 4;
+    QVector<float> values;
+    int invalid = 0;
+    qint64 shift = wallStart ? (wallStart - groundWallClock(0)) * 1000000 : 0;
+    for(int first = 0; first < blocks.size(); first += batchSize){
+        QVector<int> indices;
+        for(int i = first; i < qMin(first + batchSize, blocks.size()); i++){
+            indices.append(i);
+        }
+        QVector<DecodedTelemetryBlock> decoded = QtConcurrent::blockingMapped<QVector<DecodedTelemetryBlock> >(indices, decoder);
+
+        for(int b = 0; b < decoded.size(); b++){
+            const TelemetryArchiveBlock &block = blocks.at(indices.at(b));
+            const TelemetryTopic *topic = dictionary->topic(block.topic);
+            if(!decoded.at(b).valid){
+                invalid++;
+                continue;
+            }
+            if(!topic)
+                continue;
+            const QVector<int> &topicColumns = columns[block.topic];
+            const float *data = decoded.at(b).values.constData();
+            values.resize(topic->opCount);
+            for(int row = 0; row < block.rows; row++){
+                for(int c = 0; c < topic->opCount; c++){
+                    int column = topicColumns.at(c);
+                    values[c] = column >= 0 ? data[column * block.rows + row] : NAN;
+                }
+                store->writeSample(*topic, decoded.at(b).times.at(row) + shift, values.constData());
+            }
+        }
+    }
+    if(invalid){
+        *error = QString("%1 corrupt blocks skipped").arg(invalid);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,124 @@
+#ifndef TELEMETRYARCHIVE_H
+#define TELEMETRYARCHIVE_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+#include "telemetryrouter.h"
+#include "telemetrystore.h"
+
+#define TELEMETRY_ARCHIVE_MAGIC 0x414D4C54      /*"TLMA"*/
+#define TELEMETRY_BLOCK_MAGIC 0x424D4C54        /*"TLMB"*/
+#define TELEMETRY_ARCHIVE_VERSION 1
+#define TELEMETRY_BLOCK_ROWS 4096               /*rows per block at most*/
+#define TELEMETRY_BLOCK_SPAN 10000000000LL      /*ns, no block holds more than 10 s of a topic*/
+
+/*File layout: TelemetryArchiveHeader, the channel names as JSON
+ * ({"topics": [{"id": 5002, "channels": ["SensorIMU.ax", ...]}]}), then blocks.
+ * Every block is independently decodable:
+ *     TelemetryBlockHeader
+ *     quint32 channelBytes[channels]
+ *     timestamp stream (timeBytes)
+ *     one float stream per channel
+ *     TelemetryBlockRange footer[channels]
+ * Blocks are only ever appended, a partly written last block is ignored when reading.*/
+struct TelemetryArchiveHeader{
+    quint32 magic;
+    quint32 version;
+    quint32 dictionaryBytes;
+    quint32 reserved0;
+    qint64 wallClockStart;      /*ms since epoch at ground time 0, 0 if unknown*/
+    quint32 reserved[2];
+};
+
+struct TelemetryBlockHeader{
+    quint32 magic;
+    quint32 topic;
+    quint32 rows;
+    quint16 channels;
+    quint16 reserved;
+    quint32 size;               /*bytes of the whole block*/
+    quint32 timeBytes;
+    qint64 firstTime;           /*ns, ground clock*/
+    qint64 lastTime;
+};
+
+struct TelemetryBlockRange{
+    float min;
+    float max;
+};
+
+/*Writes every decoded sample to a session archive, as sink of the TelemetryRouter.
+ * Rows are collected per topic and compressed when a block is full or spans 10 s.
+ * Every sample checks the blocks of all topics, so while any telemetry arrives no row of a
+ * topic that went quiet waits longer than TELEMETRY_BLOCK_SPAN for its block to be written.*/
+class TelemetryArchive : public TelemetrySink
+{
+public:
+    explicit TelemetryArchive(const TelemetryDictionary *dictionary);
+    ~TelemetryArchive();
+
+    bool open(const QString &fileName);    /*creates a new archive*/
+    void close();
+    void flush();                           /*writes all pending rows*/
+    QString fileName() const;
+    qint64 size() const;
+
+    void writeSample(const TelemetryTopic &topic, qint64 time, const float *values) Q_DECL_OVERRIDE;
+
+private:
+    struct PendingBlock{
+        QVector<qint64> times;
+        QVector<float> values;              /*row major*/
+    };
+    const TelemetryDictionary *dictionary;
+    QFile file;
+    QVector<PendingBlock> pending;          /*per dictionary topic*/
+    QHash<quint32, int> topicIndex;
+    qint64 spanCheckTime;                   /*ground time at which the oldest pending block spans TELEMETRY_BLOCK_SPAN*/
+
+    void writeSpannedBlocks(qint64 time);
+    void writeBlock(const TelemetryTopic &topic, PendingBlock &block);
+};
+
+/*Block index of an archive, from the headers and footers only*/
+struct TelemetryArchiveBlock{
+    quint32 topic;
+    int rows;
+    qint64 firstTime;
+    qint64 lastTime;
+    qint64 offset;
+    QVector<TelemetryBlockRange> ranges;
+};
+
+class TelemetryArchiveReader
+{
+public:
+    TelemetryArchiveReader();
+    ~TelemetryArchiveReader();
+
+    bool open(const QString &fileName, QString *error);
+    void close();
+
+    int blockCount() const;
+    const TelemetryArchiveBlock &block(int index) const;
+    QStringList channelNames(quint32 topic) const;
+    qint64 wallClockStart() const;
+
+    /*Decodes all blocks on the global thread pool and appends them to the store in file order.
+     * Channels are matched by name, ones missing in the archive are NaN. Times are moved to
+     * this session's ground clock, so earlier sessions have negative times.*/
+    bool loadInto(TelemetryStore *store, const TelemetryDictionary *dictionary, QString *error) const;
+
+private:
+    QFile file;
+    uchar *map;
+    qint64 wallStart;
+    QVector<TelemetryArchiveBlock> blocks;
+    QHash<quint32, QStringList> topicChannels;
+};
+
+#endif // TELEMETRYARCHIVE_H
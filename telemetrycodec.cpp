@@ -0,0 +1,224 @@
+#include "telemetrycodec.h"
+
+#include <QtEndian>
+#include <string.h>
+
+BitWriter::BitWriter() : current(0), used(0){
+}
+
+
+void BitWriter::write(quint64 value, int bits){
+    if(bits < 64)
+        value &= ((quint64) 1 << bits) - 1;
+    int available = 64 - used;
+    if(bits < available){
+        current |= value << (available - bits);
+        used += bits;
+        return;
+    }
+    int rest = bits - available;
+    current |= value >> rest;
+    words.append(current);
+    current = rest ? value << (64 - rest) : 0;
+    used = rest;
+}
+
+
+QByteArray BitWriter::finish(){
+    if(used)
+        words.append(current);
+    current = 0;
+    used = 0;
+    QByteArray bytes(words.size() * 8, Qt::Uninitialized);
+    uchar *out = (uchar*) bytes.data();
+    for(int i = 0; i < words.size(); i++){
+        qToBigEndian<quint64>(words.at(i), out + i * 8);
+    }
+    words.clear();
+    return bytes;
+}
+
+
+BitReader::BitReader(const uchar *data, int size) : data(data), words(size / 8), next(0), current(0), used(0), overrunFlag(false){
+    advance();
+}
+
+
+/*Past the end the stream continues with zeros, reading them sets the overrun flag*/
+void BitReader::advance(){
+    current = next < words ? qFromBigEndian<quint64>(data + next * 8) : 0;
+    next++;
+    used = 0;
+}
+
+
+quint64 BitReader::read(int bits){
+    if(next > words)
+        overrunFlag = true;
+    int available = 64 - used;
+    quint64 value;
+    if(bits < available){
+        value = (current << used) >> (64 - bits);
+        used += bits;
+        return value;
+    }
+    int rest = bits - available;
+    value = (current << used) >> used;      /*the remaining bits of this word*/
+    advance();
+    if(rest){
+        if(next > words)
+            overrunFlag = true;
+        value = (value << rest) | (current >> (64 - rest));
+        used = rest;
+    }
+    return value;
+}
+
+
+bool BitReader::overrun() const{
+    return overrunFlag;
+}
+
+
+static inline qint64 signExtend(quint64 value, int bits){
+    return (qint64)(value << (64 - bits)) >> (64 - bits);
+}
+
+static inline bool fitsSigned(qint64 value, int bits){
+    qint64 limit = (qint64) 1 << (bits - 1);
+    return value >= -limit && value < limit;
+}
+
+
+QByteArray encodeTimestamps(const qint64 *times, int count){
+    BitWriter out;
+    if(count > 0)
+        out.write(times[0], 64);
+    qint64 previousDelta = 0;
+    for(int i = 1; i < count; i++){
+        qint64 delta = (qint64)((quint64) times[i] - (quint64) times[i - 1]);      /*wraps instead of overflowing*/
+        qint64 deltaOfDelta = (qint64)((quint64) delta - (quint64) previousDelta);
+        previousDelta = delta;
+        if(deltaOfDelta == 0){
+            out.write(0, 1);
+        }else if(fitsSigned(deltaOfDelta, 16)){
+            out.write(2, 2);
+            out.write(deltaOfDelta, 16);
+        }else if(fitsSigned(deltaOfDelta, 28)){
+            out.write(6, 3);
+            out.write(deltaOfDelta, 28);
+        }else if(fitsSigned(deltaOfDelta, 40)){
+            out.write(14, 4);
+            out.write(deltaOfDelta, 40);
+        }else{
+            out.write(15, 4);
+            out.write(deltaOfDelta, 64);
+        }
+    }
+    return out.finish();
+}
+
+
+bool decodeTimestamps(const uchar *data, int size, qint64 *times, int count){
+    BitReader in(data, size);
+    if(count > 0)
+        times[0] = in.read(64);
+    qint64 delta = 0;
+    for(int i = 1; i < count; i++){
+        if(in.read(1)){
+            if(!in.read(1))
+                delta += signExtend(in.read(16), 16);
+            else if(!in.read(1))
+                delta += signExtend(in.read(28), 28);
+            else if(!in.read(1))
+                delta += signExtend(in.read(40), 40);
+            else
+                delta = (qint64)((quint64) delta + in.read(64));
+        }
+        times[i] = (qint64)((quint64) times[i - 1] + (quint64) delta);
+    }
+    return !in.overrun();
+}
+
+
+static inline quint32 floatBits(float value){
+    quint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline int leadingZeros(quint32 value){
+    int count = 0;
+    for(quint32 mask = 0x80000000u; mask && !(value & mask); mask >>= 1){
+        count++;
+    }
+    return count;
+}
+
+static inline int trailingZeros(quint32 value){
+    int count = 0;
+    for(quint32 mask = 1; mask && !(value & mask); mask <<= 1){
+        count++;
+    }
+    return count;
+}
+
+
+QByteArray encodeFloats(const float *values, int count, int stride){
+    BitWriter out;
+    if(count <= 0)
+        return out.finish();
+    quint32 previous = floatBits(values[0]);
+    out.write(previous, 32);
+    int windowLeading = 33;     /*no window yet*/
+    int windowTrailing = 0;
+    for(int i = 1; i < count; i++){
+        quint32 bits = floatBits(values[i * stride]);
+        quint32 difference = bits ^ previous;
+        previous = bits;
+        if(!difference){
+            out.write(0, 1);
+            continue;
+        }
+        int leading = qMin(leadingZeros(difference), 31);
+        int trailing = trailingZeros(difference);
+        if(windowLeading <= 32 && leading >= windowLeading && trailing >= windowTrailing){
+            out.write(2, 2);
+            out.write(difference >> windowTrailing, 32 - windowLeading - windowTrailing);
+        }else{
+            int length = 32 - leading - trailing;
+            out.write(3, 2);
+            out.write(leading, 5);
+            out.write(length - 1, 5);
+            out.write(difference >> trailing, length);
+            windowLeading = leading;
+            windowTrailing = trailing;
+        }
+    }
+    return out.finish();
+}
+
+
+bool decodeFloats(const uchar *data, int size, float *values, int count){
+    BitReader in(data, size);
+    if(count <= 0)
+        return true;
+    quint32 previous = in.read(32);
+    memcpy(&values[0], &previous, sizeof(float));
+    int windowLeading = 0;
+    int windowTrailing = 0;
+    for(int i = 1; i < count; i++){
+        if(in.read(1)){
+            if(in.read(1)){
+                windowLeading = in.read(5);
+                windowTrailing = 32 - windowLeading - ((int) in.read(5) + 1);
+                if(windowTrailing < 0)
+                    return false;
+            }
+            int length = 32 - windowLeading - windowTrailing;
+            previous ^= (quint32) in.read(length) << windowTrailing;
+        }
+        memcpy(&values[i], &previous, sizeof(float));
+    }
+    return !in.overrun();
+}
@@ -0,0 +1,54 @@
+#ifndef TELEMETRYCODEC_H
+#define TELEMETRYCODEC_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <QByteArray>
+
+/*Gorilla style column compression (Pelkonen et al., VLDB 2015).
+ * Timestamps are stored as delta of delta, floats as XOR with the previous value.
+ * Bit streams are big endian 64 bit words, so they can be read back word by word.*/
+
+class BitWriter
+{
+public:
+    BitWriter();
+    void write(quint64 value, int bits);    /*lowest bits of value, bits in [1, 64]*/
+    QByteArray finish();                    /*pads the last word*/
+
+private:
+    QVector<quint64> words;
+    quint64 current;
+    int used;
+};
+
+class BitReader
+{
+public:
+    BitReader(const uchar *data, int size);
+    quint64 read(int bits);                 /*bits in [1, 64]*/
+    bool overrun() const;                   /*read past the end*/
+
+private:
+    const uchar *data;
+    int words;
+    int next;
+    quint64 current;
+    int used;
+    bool overrunFlag;
+
+    void advance();
+};
+
+/*Delta of delta buckets, wider than in the paper since times are ns:
+ * '0' unchanged, '10' 16 bits, '110' 28 bits, '1110' 40 bits, '1111' 64 bits*/
+QByteArray encodeTimestamps(const qint64 *times, int count);
+bool decodeTimestamps(const uchar *data, int size, qint64 *times, int count);
+
+/*XOR of the 32 bit patterns: '0' same value, '10' meaningful bits inside the previous window,
+ * '11' 5 bits leading zeros, 5 bits length - 1, then the meaningful bits.
+ * values[i * stride] are encoded, so rows of a buffer can be compressed column by column.*/
+QByteArray encodeFloats(const float *values, int count, int stride = 1);
+bool decodeFloats(const uchar *data, int size, float *values, int count);
+
+#endif // TELEMETRYCODEC_H
@@ -0,0 +1,258 @@
+#include "telemetrydictionary.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+
+/*Instruction set of the decoder program: field type and byte order in one switch*/
+enum TelemetryLoad{
+    LoadBool,
+    LoadInt16LE, LoadInt16BE,
+    LoadUInt16LE, LoadUInt16BE,
+    LoadInt32LE, LoadInt32BE,
+    LoadUInt32LE, LoadUInt32BE,
+    LoadFloatLE, LoadFloatBE
+};
+
+static quint8 loadInstruction(PayloadFieldType type, WireEndian endian){
+    bool big = endian == WireBigEndian;
+    switch(type){
+    case FieldBool:     return LoadBool;
+    case FieldInt16:    return big ? LoadInt16BE : LoadInt16LE;
+    case FieldUInt16:   return big ? LoadUInt16BE : LoadUInt16LE;
+    case FieldInt32:    return big ? LoadInt32BE : LoadInt32LE;
+    case FieldUInt32:   return big ? LoadUInt32BE : LoadUInt32LE;
+    case FieldFloat:    return big ? LoadFloatBE : LoadFloatLE;
+    }
+    return LoadBool;
+}
+
+static int fieldSize(PayloadFieldType type){
+    switch(type){
+    case FieldBool:     return 1;
+    case FieldInt16:
+    case FieldUInt16:   return 2;
+    case FieldInt32:
+    case FieldUInt32:
+    case FieldFloat:    return 4;
+    }
+    return 1;
+}
+
+static bool parseFieldType(const QString &name, PayloadFieldType &type){
+    static const char *const names[] = {"bool", "int16", "uint16", "int32", "uint32", "float"};
+    for(int i = 0; i <= FieldFloat; i++){
+        if(name == QLatin1String(names[i])){
+            type = (PayloadFieldType) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+TelemetryDictionary::TelemetryDictionary(){
+    addBuiltinTopics();
+    compile();
+}
+
+
+/*The compiled in schemas are the default dictionary*/
+void TelemetryDictionary::addBuiltinTopics(){
+    static const PayloadType builtin[] = {PayloadCounterType, PayloadSensorIMUType, PayloadElectricalType, PayloadMissionType, PayloadLightType};
+    for(unsigned i = 0; i < sizeof(builtin) / sizeof(builtin[0]); i++){
+        TopicDefinition definition;
+        definition.id = builtin[i];
+        definition.name = QString(payloadTypeName(builtin[i])).remove(' ');
+        int count;
+        int end = 0;
+        int alignment = 1;
+        const PayloadField *fields = payloadFields(builtin[i], &count);
+        for(int f = 0; f < count; f++){
+            TelemetryChannel channel;
+            channel.topic = definition.id;
+            channel.name = definition.name + "." + fields[f].name;
+            channel.unit = fields[f].unit;
+            channel.type = fields[f].type;
+            channel.endian = fields[f].endian;
+            channel.offset = fields[f].offset;
+            channel.scale = fields[f].scale;
+            definition.fields.append(channel);
+            end = qMax(end, fields[f].offset + fieldSize(fields[f].type));
+            alignment = qMax(alignment, fieldSize(fields[f].type));
+        }
+        definition.size = wireAlign(end, alignment);
+        definitions.append(definition);
+    }
+}
+
+
+bool TelemetryDictionary::load(const QString &fileName, QString *error){
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly)){
+        *error = file.errorString();
+        return false;
+    }
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if(document.isNull()){
+        *error = parseError.errorString();
+        return false;
+    }
+
+    /*Nothing changes unless the whole file is valid*/
+    QVector<TopicDefinition> loaded = definitions;
+    foreach(const QJsonValue &value, document.object().value("topics").toArray()){
+        TopicDefinition definition;
+        if(!parseTopic(value.toObject(), definition, error))
+            return false;
+        bool replaced = false;
+        for(int i = 0; i < loaded.size(); i++){
+            if(loaded.at(i).id == definition.id){
+                loaded[i] = definition;
+                replaced = true;
+            }
+        }
+        if(!replaced)
+            loaded.append(definition);
+    }
+    definitions = loaded;
+    compile();
+    return true;
+}
+
+
+bool TelemetryDictionary::parseTopic(const QJsonObject &object, TopicDefinition &definition, QString *error){
+    definition.id = (quint32) object.value("id").toInt();
+    definition.name = object.value("name").toString(QString::number(definition.id));
+    if(definition.id - TOPIC_TABLE_BASE >= TOPIC_TABLE_SIZE){
+        *error = QString("Topic %1 is outside of [%2, %3)").arg(definition.id).arg(TOPIC_TABLE_BASE).arg(TOPIC_TABLE_BASE + TOPIC_TABLE_SIZE);
+        return false;
+    }
+    if(definition.id == TELECOMMAND_ACK_TOPIC_ID){
+        *error = QString("Topic %1 is reserved for telecommand acknowledgements").arg(definition.id);
+        return false;
+    }
+
+    int end = 0;
+    int alignment = 1;
+    foreach(const QJsonValue &value, object.value("fields").toArray()){
+        QJsonObject field = value.toObject();
+        TelemetryChannel channel;
+        channel.topic = definition.id;
+        channel.name = definition.name + "." + field.value("name").toString();
+        channel.unit = field.value("unit").toString();
+        channel.plot = field.value("plot").toString();
+        channel.scale = field.value("scale").toDouble(1);
+        channel.endian = field.value("endian").toString("little") == "big" ? WireBigEndian : WireLittleEndian;
+        if(!parseFieldType(field.value("type").toString(), channel.type)){
+            *error = QString("Field %1 has an unknown type").arg(channel.name);
+            return false;
+        }
+        int size = fieldSize(channel.type);
+        int offset = field.contains("offset") ? field.value("offset").toInt() : wireAlign(end, size);
+        if(offset < 0 || offset + size > RODOS_FRAME_SIZE - RODOS_HEADER_SIZE){
+            *error = QString("Field %1 is outside of the frame").arg(channel.name);
+            return false;
+        }
+        channel.offset = offset;
+        end = qMax(end, offset + size);
+        alignment = qMax(alignment, size);
+        definition.fields.append(channel);
+    }
+    definition.size = object.value("size").toInt(wireAlign(end, alignment));
+    return true;
+}
+
+
+/*Flatten all definitions into one program, the channel id of an instruction is its index*/
+void TelemetryDictionary::compile(){
+    topics.clear();
+    channels.clear();
+    program.clear();
+    for(int i = 0; i < TOPIC_TABLE_SIZE; i++){
+        topicTable[i] = -1;
+    }
+    foreach(const TopicDefinition &definition, definitions){
+        TelemetryTopic topic;
+        topic.id = definition.id;
+        topic.name = definition.name;
+        topic.size = definition.size;
+        topic.firstOp = program.size();
+        topic.opCount = definition.fields.size();
+        foreach(const TelemetryChannel &channel, definition.fields){
+            TelemetryDecodeOp op;
+            op.offset = channel.offset;
+            op.load = loadInstruction(channel.type, channel.endian);
+            op.channel = channels.size();
+            op.scale = channel.scale;
+            program.append(op);
+            channels.append(channel);
+        }
+        topicTable[definition.id - TOPIC_TABLE_BASE] = topics.size();
+        topics.append(topic);
+    }
+}
+
+
+int TelemetryDictionary::topicCount() const{
+    return topics.size();
+}
+
+const TelemetryTopic &TelemetryDictionary::topicAt(int index) const{
+    return topics.at(index);
+}
+
+const TelemetryTopic *TelemetryDictionary::topic(quint32 id) const{
+    quint32 index = id - TOPIC_TABLE_BASE;
+    if(index >= TOPIC_TABLE_SIZE || topicTable[index] < 0)
+        return 0;
+    return &topics.at(topicTable[index]);
+}
+
+int TelemetryDictionary::channelCount() const{
+    return channels.size();
+}
+
+const TelemetryChannel &TelemetryDictionary::channel(int id) const{
+    return channels.at(id);
+}
+
+int TelemetryDictionary::channelId(const QString &name) const{
+    for(int i = 0; i < channels.size(); i++){
+        if(channels.at(i).name == name)
+            return i;
+    }
+    return -1;
+}
+
+
+/*The interpreter: one switch per field, offsets were resolved when compiling*/
+int TelemetryDictionary::decode(const PayloadSatellite &payload, float *values) const{
+    const TelemetryTopic *definition = topic(payload.topic);
+    if(!definition || payload.userDataLen != definition->size)
+        return 0;
+    const TelemetryDecodeOp *op = program.constData() + definition->firstOp;
+    const TelemetryDecodeOp *end = op + definition->opCount;
+    const uchar *data = payload.userData;
+    for(; op != end; ++op){
+        const uchar *field = data + op->offset;
+        float value;
+        switch(op->load){
+        case LoadBool:      value = field[0] != 0; break;
+        case LoadInt16LE:   value = qFromLittleEndian<qint16>(field); break;
+        case LoadInt16BE:   value = qFromBigEndian<qint16>(field); break;
+        case LoadUInt16LE:  value = qFromLittleEndian<quint16>(field); break;
+        case LoadUInt16BE:  value = qFromBigEndian<quint16>(field); break;
+        case LoadInt32LE:   value = qFromLittleEndian<qint32>(field); break;
+        case LoadInt32BE:   value = qFromBigEndian<qint32>(field); break;
+        case LoadUInt32LE:  value = qFromLittleEndian<quint32>(field); break;
+        case LoadUInt32BE:  value = qFromBigEndian<quint32>(field); break;
+        case LoadFloatLE:   value = WireValue<float, WireLittleEndian>::load(field); break;
+        case LoadFloatBE:   value = WireValue<float, WireBigEndian>::load(field); break;
+        default:            value = 0; break;
+        }
+        values[op->channel] = value * op->scale;
+    }
+    return definition->opCount;
+}
@@ -0,0 +1,85 @@
+#ifndef TELEMETRYDICTIONARY_H
+#define TELEMETRYDICTIONARY_H
+
+#include <QString>
+#include <QVector>
+#include <QJsonObject>
+
+#include "payload.h"
+
+/*One decoded value of a topic*/
+struct TelemetryChannel{
+    quint32 topic;
+    QString name;           /*"<topic>.<field>"*/
+    QString unit;
+    QString plot;           /*plot hint: channels with the same hint share a plot, empty for none*/
+    PayloadFieldType type;
+    WireEndian endian;
+    quint16 offset;
+    double scale;
+};
+
+/*One instruction of the decoder program: load, convert and scale a field into its channel slot*/
+struct TelemetryDecodeOp{
+    quint16 offset;
+    quint8 load;            /*TelemetryLoad*/
+    quint16 channel;
+    float scale;
+};
+
+struct TelemetryTopic{
+    quint32 id;
+    QString name;
+    quint16 size;           /*expected userDataLen*/
+    int firstOp;            /*range in the program, also the range of channel ids*/
+    int opCount;
+};
+
+/*Topics and fields known to the ground station. The compiled in topics are always present,
+ * a JSON dictionary loaded at startup adds topics or replaces them:
+ *
+ * {"topics": [{"id": 5010, "name": "Thermal", "fields": [
+ *     {"name": "panelTemperature", "type": "float", "unit": "degC", "scale": 1,
+ *      "endian": "little", "offset": 0, "plot": "Temperatures"}]}]}
+ *
+ * type is bool, int16, uint16, int32, uint32 or float. offset, endian, scale and the
+ * topic size are optional, missing offsets follow the on-board natural alignment.
+ * TELECOMMAND_ACK_TOPIC_ID (5006) belongs to the link and is rejected.*/
+class TelemetryDictionary
+{
+public:
+    TelemetryDictionary();
+    bool load(const QString &fileName, QString *error);
+
+    int topicCount() const;
+    const TelemetryTopic &topicAt(int index) const;
+    const TelemetryTopic *topic(quint32 id) const;      /*0 if unknown*/
+    int channelCount() const;
+    const TelemetryChannel &channel(int id) const;
+    int channelId(const QString &name) const;           /*-1 if unknown*/
+
+    /*Runs the program of the payload's topic, values[first channel ...] are written.
+     * Returns the number of values, 0 for unknown topics or wrong sizes.*/
+    int decode(const PayloadSatellite &payload, float *values) const;
+
+private:
+    struct TopicDefinition{
+        quint32 id;
+        QString name;
+        int size;
+        QVector<TelemetryChannel> fields;
+    };
+    QVector<TopicDefinition> definitions;
+
+    /*Compiled form*/
+    QVector<TelemetryTopic> topics;
+    QVector<TelemetryChannel> channels;
+    QVector<TelemetryDecodeOp> program;
+    qint16 topicTable[TOPIC_TABLE_SIZE];   /*index into topics, -1 for none*/
+
+    void addBuiltinTopics();
+    bool parseTopic(const QJsonObject &object, TopicDefinition &definition, QString *error);
+    void compile();
+};
+
+#endif // TELEMETRYDICTIONARY_H
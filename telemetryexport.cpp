@@ -0,0 +1,300 @@
+#include "telemetryexport.h"
+#include "clocksync.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QThread>
+#include <QtConcurrent>
+#include <stdio.h>
+#include <algorithm>
+
+/*Selected channels of one topic and the store slices of the exported range.
+ * All channels of a topic share the row layout, so slices[c][s].times are the same for every c.*/
+struct ExportTopic{
+    const TelemetryTopic *topic;
+    QVector<int> channels;
+    int firstColumn;
+    QVector<QVector<TelemetrySlice> > slices;
+    qint64 rows;
+};
+
+struct ExportRow{
+    int topic;
+    int slice;
+    int row;
+};
+
+struct SliceCollector{
+    QVector<TelemetrySlice> *slices;
+    void operator()(const TelemetrySlice &slice) const{
+        slices->append(slice);
+    }
+};
+
+/*Large sequential writes, the buffer is handed to the file when it is full*/
+class ExportWriter
+{
+public:
+    explicit ExportWriter(QFile *file) : file(file), ok(true){
+        buffer.reserve(TELEMETRY_EXPORT_BUFFER);
+    }
+    void append(const char *data, int size){
+        buffer.append(data, size);
+        if(buffer.size() >= TELEMETRY_EXPORT_BUFFER)
+            flush();
+    }
+    void append(const QByteArray &data){
+        append(data.constData(), data.size());
+    }
+    void pad(int alignment){
+        static const char zeros[8] = {0};
+        qint64 position = file->pos() + buffer.size();
+        int padding = (alignment - position % alignment) % alignment;
+        append(zeros, padding);
+    }
+    bool flush(){
+        if(ok && !buffer.isEmpty())
+            ok = file->write(buffer) == buffer.size();
+        buffer.clear();
+        return ok;
+    }
+
+private:
+    QFile *file;
+    QByteArray buffer;
+    bool ok;
+};
+
+
+/*Formats one batch of rows, runs on the thread pool*/
+struct CsvFormatter{
+    typedef QByteArray result_type;
+    const QVector<ExportTopic> *topics;
+    const QVector<ExportRow> *rows;
+    int columns;
+    qint64 epoch;               /*ns since epoch at ground time 0*/
+
+    QByteArray operator()(int batch) const{
+        int first = batch * TELEMETRY_EXPORT_BATCH_ROWS;
+        int last = qMin(first + TELEMETRY_EXPORT_BATCH_ROWS, rows->size());
+        QByteArray out;
+        out.reserve((last - first) * (24 + columns * 12));
+        char cell[40];
+        for(int r = first; r < last; r++){
+            const ExportRow &row = rows->at(r);
+            const ExportTopic &topic = topics->at(row.topic);
+            qint64 time = epoch + topic.slices.at(0).at(row.slice).times[row.row];
+            out.append(cell, qsnprintf(cell, sizeof(cell), "%lld.%09lld", time / 1000000000, time % 1000000000));
+            for(int c = 0; c < topic.firstColumn; c++){
+                out.append(',');
+            }
+            for(int c = 0; c < topic.channels.size(); c++){
+                float value = topic.slices.at(c).at(row.slice).values[row.row];
+                out.append(',');
+                if(value == value)
+                    out.append(cell, qsnprintf(cell, sizeof(cell), "%.7g", value));
+            }
+            for(int c = topic.firstColumn + topic.channels.size(); c < columns; c++){
+                out.append(',');
+            }
+            out.append('\n');
+        }
+        return out;
+    }
+};
+
+
+TelemetryExporter::TelemetryExporter(const TelemetryStore *store, const TelemetryDictionary *dictionary)
+    : store(store), dictionary(dictionary), rows(0){
+}
+
+
+qint64 TelemetryExporter::rowCount() const{
+    return rows;
+}
+
+
+bool TelemetryExporter::write(const QString &fileName, const QVector<int> &channels, qint64 from, qint64 to,
+                              TelemetryExportFormat format, QString *error){
+    rows = 0;
+    if(channels.isEmpty()){
+        *error = "No channels selected";
+        return false;
+    }
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+        *error = file.errorString();
+        return false;
+    }
+    bool ok = format == TelemetryExportCsv ? writeCsv(file, channels, from, to) : writeBinary(file, channels, from, to);
+    if(!ok)
+        *error = file.errorString();
+    return ok;
+}
+
+
+/*Groups the channels by topic in dictionary order and collects their slices*/
+static QVector<ExportTopic> collectTopics(const TelemetryStore *store, const TelemetryDictionary *dictionary,
+                                          QVector<int> channels, qint64 from, qint64 to){
+    QVector<ExportTopic> topics;
+    std::sort(channels.begin(), channels.end());
+    int column = 0;
+    foreach(int channel, channels){
+        if(channel < 0 || channel >= dictionary->channelCount())
+            continue;
+        const TelemetryTopic *topic = dictionary->topic(dictionary->channel(channel).topic);
+        if(topics.isEmpty() || topics.last().topic != topic){
+            ExportTopic exported;
+            exported.topic = topic;
+            exported.firstColumn = column;
+            exported.rows = 0;
+            topics.append(exported);
+        }
+        ExportTopic &exported = topics.last();
+        exported.channels.append(channel);
+        exported.slices.append(QVector<TelemetrySlice>());
+        SliceCollector collector = {&exported.slices.last()};
+        store->scan(channel, from, to, collector);
+        column++;
+    }
+    for(int t = 0; t < topics.size(); t++){
+        foreach(const TelemetrySlice &slice, topics.at(t).slices.at(0)){
+            topics[t].rows += slice.count;
+        }
+    }
+    return topics;
+}
+
+
+bool TelemetryExporter::writeCsv(QFile &file, const QVector<int> &channels, qint64 from, qint64 to){
+    QVector<ExportTopic> topics = collectTopics(store, dictionary, channels, from, to);
+    ExportWriter writer(&file);
+
+    QByteArray header = "time";
+    int columns = 0;
+    foreach(const ExportTopic &topic, topics){
+        foreach(int channel, topic.channels){
+            const TelemetryChannel &info = dictionary->channel(channel);
+            header += "," + info.name.toUtf8();
+            if(!info.unit.isEmpty())
+                header += " [" + info.unit.toUtf8() + "]";
+            columns++;
+        }
+    }
+    writer.append(header + "\n");
+
+    /*Merge the topics by time, there are only a few so the smallest is searched linearly*/
+    QVector<ExportRow> order;
+    QVector<ExportRow> cursors(topics.size());
+    qint64 total = 0;
+    for(int t = 0; t < topics.size(); t++){
+        ExportRow cursor = {t, 0, 0};
+        cursors[t] = cursor;
+        total += topics.at(t).rows;
+    }
+    order.reserve(total);
+    for(qint64 r = 0; r < total; r++){
+        int next = -1;
+        qint64 nextTime = 0;
+        for(int t = 0; t < topics.size(); t++){
+            const QVector<TelemetrySlice> &slices = topics.at(t).slices.at(0);
+            if(cursors.at(t).slice >= slices.size())
+                continue;
+            qint64 time = slices.at(cursors.at(t).slice).times[cursors.at(t).row];
+            if(next < 0 || time < nextTime){
+                next = t;
+                nextTime = time;
+            }
+        }
+        ExportRow &cursor = cursors[next];
+        order.append(cursor);
+        if(++cursor.row == topics.at(next).slices.at(0).at(cursor.slice).count){
+            cursor.slice++;
+            cursor.row = 0;
+        }
+    }
+
+    /*Format a window of batches while the previous window is written*/
+    CsvFormatter formatter = {&topics, &order, columns, groundWallClock(0) * 1000000};
+    int batches = (order.size() + TELEMETRY_EXPORT_BATCH_ROWS - 1) / TELEMETRY_EXPORT_BATCH_ROWS;
+    int window = qMax(1, QThread::idealThreadCount()) * 2;
+    QFuture<QByteArray> current;
+    int currentCount = 0;
+    for(int first = 0; first < batches; first += window){
+        QVector<int> indices;
+        for(int i = first; i < qMin(first + window, batches); i++){
+            indices.append(i);
+        }
+        QFuture<QByteArray> next = QtConcurrent::mapped(indices, formatter);
+        for(int i = 0; i < currentCount; i++){
+            writer.append(current.resultAt(i));     /*waits for that batch only*/
+        }
+        current = next;
+        currentCount = indices.size();
+    }
+
+    /*The last window, the formatter refers to topics and order until all of its tasks are done*/
+    for(int i = 0; i < currentCount; i++){
+        writer.append(current.resultAt(i));
+    }
+    rows = order.size();
+    return writer.flush();
+}
+
+
+bool TelemetryExporter::writeBinary(QFile &file, const QVector<int> &channels, qint64 from, qint64 to){
+    QVector<ExportTopic> topics = collectTopics(store, dictionary, channels, from, to);
+    ExportWriter writer(&file);
+
+    /*Column offsets are known from the row counts*/
+    QJsonArray descriptors;
+    qint64 offset = 0;
+    foreach(const ExportTopic &topic, topics){
+        QJsonObject descriptor;
+        descriptor.insert("id", (int) topic.topic->id);
+        descriptor.insert("name", topic.topic->name);
+        descriptor.insert("rows", (double) topic.rows);
+        descriptor.insert("time", (double) offset);
+        offset += topic.rows * sizeof(qint64);
+        QJsonArray channelDescriptors;
+        foreach(int channel, topic.channels){
+            QJsonObject channelDescriptor;
+            channelDescriptor.insert("name", dictionary->channel(channel).name);
+            channelDescriptor.insert("unit", dictionary->channel(channel).unit);
+            channelDescriptor.insert("offset", (double) offset);
+            offset += (topic.rows * sizeof(float) + 7) / 8 * 8;
+            channelDescriptors.append(channelDescriptor);
+        }
+        descriptor.insert("channels", channelDescriptors);
+        descriptors.append(descriptor);
+    }
+    QJsonObject root;
+    root.insert("topics", descriptors);
+    QByteArray descriptor = QJsonDocument(root).toJson(QJsonDocument::Compact);
+    descriptor.append(QByteArray((8 - descriptor.size() % 8) % 8, ' '));
+
+    TelemetryExportHeader header = {TELEMETRY_EXPORT_MAGIC, TELEMETRY_EXPORT_VERSION, (quint32) descriptor.size(), 0};
+    writer.append((const char*)&header, sizeof(header));
+    writer.append(descriptor);
+
+    /*Values go out straight from the store chunks, only times are moved to the epoch*/
+    qint64 epoch = groundWallClock(0) * 1000000;
+    QVector<qint64> times(TELEMETRY_CHUNK_SAMPLES);
+    foreach(const ExportTopic &topic, topics){
+        foreach(const TelemetrySlice &slice, topic.slices.at(0)){
+            for(int i = 0; i < slice.count; i++){
+                times[i] = epoch + slice.times[i];
+            }
+            writer.append((const char*) times.constData(), slice.count * sizeof(qint64));
+        }
+        for(int c = 0; c < topic.channels.size(); c++){
+            foreach(const TelemetrySlice &slice, topic.slices.at(c)){
+                writer.append((const char*) slice.values, slice.count * sizeof(float));
+            }
+            writer.pad(8);
+        }
+        rows += topic.rows;
+    }
+    return writer.flush();
+}
@@ -0,0 +1,53 @@
+#ifndef TELEMETRYEXPORT_H
+#define TELEMETRYEXPORT_H
+
+#include <QString>
+#include <QVector>
+#include <QFile>
+
+#include "telemetrystore.h"
+
+#define TELEMETRY_EXPORT_MAGIC 0x584D4C54      /*"TLMX"*/
+#define TELEMETRY_EXPORT_VERSION 1
+#define TELEMETRY_EXPORT_BATCH_ROWS 16384       /*CSV rows formatted by one task*/
+#define TELEMETRY_EXPORT_BUFFER (4 << 20)       /*bytes collected before a write*/
+
+enum TelemetryExportFormat{
+    TelemetryExportCsv,
+    TelemetryExportBinary
+};
+
+/*Binary layout: TelemetryExportHeader, a JSON descriptor, then the columns, each padded to 8 bytes.
+ * {"topics": [{"id": 5002, "name": "SensorIMU", "rows": 36000, "time": 0,
+ *              "channels": [{"name": "SensorIMU.ax", "unit": "milli-g", "offset": 288000}]}]}
+ * Offsets count from the end of the descriptor, times are qint64 ns since epoch,
+ * values float, both in the byte order of the writing machine.*/
+struct TelemetryExportHeader{
+    quint32 magic;
+    quint32 version;
+    quint32 descriptorBytes;    /*padded to 8*/
+    quint32 reserved;
+};
+
+/*Writes channels of the TelemetryStore in a time range to CSV or columnar binary files.
+ * CSV rows of all selected topics are merged by time, channels of other topics stay empty.
+ * Batches of rows are formatted on the global thread pool while earlier ones are written.
+ * The store must not be written meanwhile.*/
+class TelemetryExporter
+{
+public:
+    TelemetryExporter(const TelemetryStore *store, const TelemetryDictionary *dictionary);
+    bool write(const QString &fileName, const QVector<int> &channels, qint64 from, qint64 to,
+               TelemetryExportFormat format, QString *error);
+    qint64 rowCount() const;
+
+private:
+    const TelemetryStore *store;
+    const TelemetryDictionary *dictionary;
+    qint64 rows;
+
+    bool writeCsv(QFile &file, const QVector<int> &channels, qint64 from, qint64 to);
+    bool writeBinary(QFile &file, const QVector<int> &channels, qint64 from, qint64 to);
+};
+
+#endif // TELEMETRYEXPORT_H
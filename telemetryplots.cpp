@@ -0,0 +1,81 @@
+#include "telemetryplots.h"
+#include "clocksync.h"
+
+#include <QVBoxLayout>
+
+TelemetryPlots::TelemetryPlots(const TelemetryDictionary *dictionary, QWidget *parent) : QWidget(parent), lastKey(0){
+    static const Qt::GlobalColor colors[] = {Qt::yellow, Qt::cyan, Qt::magenta, Qt::green, Qt::red, Qt::white};
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    QStringList hints;
+    channelGraphs.fill(0, dictionary->channelCount());
+    channelPlots.fill(-1, dictionary->channelCount());
+
+    for(int id = 0; id < dictionary->channelCount(); id++){
+        const TelemetryChannel &channel = dictionary->channel(id);
+        if(channel.plot.isEmpty())
+            continue;
+        int index = hints.indexOf(channel.plot);
+        if(index < 0){
+            index = hints.size();
+            hints.append(channel.plot);
+            QCustomPlot *plot = new QCustomPlot(this);
+            plot->xAxis->setLabel("Current Time");
+            plot->xAxis->setTickLabelType(QCPAxis::ltDateTime);
+            plot->xAxis->setDateTimeFormat("hh:mm:ss");
+            plot->yAxis->setLabel(channel.plot);
+            plot->axisRect()->setupFullAxesBox();
+            plot->legend->setVisible(true);
+            layout->addWidget(plot);
+            plots.append(plot);
+            dirty.append(false);
+        }
+        QCustomPlot *plot = plots.at(index);
+        QCPGraph *graph = plot->addGraph();
+        graph->setPen(QPen(colors[(plot->graphCount() - 1) % (sizeof(colors) / sizeof(colors[0]))]));
+        graph->setName(channel.unit.isEmpty() ? channel.name : QString("%1 (%2)").arg(channel.name, channel.unit));
+        channelGraphs[id] = graph;
+        channelPlots[id] = index;
+    }
+
+    replotTimer.setInterval(TELEMETRY_REPLOT_INTERVAL);
+    connect(&replotTimer, SIGNAL(timeout()), this, SLOT(replotChanged()));
+    if(!plots.isEmpty())
+        replotTimer.start();
+}
+
+
+bool TelemetryPlots::isEmpty() const{
+    return plots.isEmpty();
+}
+
+
+void TelemetryPlots::writeSample(const TelemetryTopic &topic, qint64 time, const float *values){
+    double key = groundSeconds(time);
+    for(int i = 0; i < topic.opCount; i++){
+        QCPGraph *graph = channelGraphs.at(topic.firstOp + i);
+        if(!graph)
+            continue;
+        graph->addData(key, values[i]);
+        graph->removeDataBefore(key - TELEMETRY_PLOT_VISIBLE_TIME);
+        dirty[channelPlots.at(topic.firstOp + i)] = true;
+    }
+    lastKey = qMax(lastKey, key);
+}
+
+
+/*Only plots that received samples are redrawn, and at most every TELEMETRY_REPLOT_INTERVAL*/
+void TelemetryPlots::replotChanged(){
+    if(!isVisible())
+        return;
+    for(int i = 0; i < plots.size(); i++){
+        if(!dirty.at(i))
+            continue;
+        QCustomPlot *plot = plots.at(i);
+        for(int g = 0; g < plot->graphCount(); g++){
+            plot->graph(g)->rescaleValueAxis(g > 0);
+        }
+        plot->xAxis->setRange(lastKey + 0.25, TELEMETRY_PLOT_VISIBLE_TIME, Qt::AlignRight);
+        plot->replot();
+        dirty[i] = false;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef TELEMETRYPLOTS_H
+#define TELEMETRYPLOTS_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QVector>
+#include <QList>
+
+#include "qcustomplot.h"
+#include "telemetryrouter.h"
+
+#define TELEMETRY_PLOT_VISIBLE_TIME 15     /*s*/
+#define TELEMETRY_REPLOT_INTERVAL 100      /*ms*/
+
+/*Telemetry tab: one plot per plot hint of the dictionary, one graph per channel.
+ * Samples are added as they arrive, changed plots are redrawn at a fixed rate.*/
+class TelemetryPlots : public QWidget, public TelemetrySink
+{
+    Q_OBJECT
+
+public:
+    explicit TelemetryPlots(const TelemetryDictionary *dictionary, QWidget *parent = 0);
+    bool isEmpty() const;
+    void writeSample(const TelemetryTopic &topic, qint64 time, const float *values) Q_DECL_OVERRIDE;
+
+private:
+    QList<QCustomPlot*> plots;
+    QVector<bool> dirty;                /*per plot*/
+    QVector<QCPGraph*> channelGraphs;   /*per channel id, 0 if not plotted*/
+    QVector<int> channelPlots;
+    QTimer replotTimer;
+    double lastKey;
+
+private slots:
+    void replotChanged();
+};
+
+#endif // TELEMETRYPLOTS_H
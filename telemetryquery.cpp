@@ -0,0 +1,125 @@
+#include "telemetryquery.h"
+
+#include <float.h>
+
+/*Floor division, tiles before the ground clock origin get negative numbers*/
+static inline qint64 floorDivide(qint64 value, qint64 divisor){
+    qint64 quotient = value / divisor;
+    return (value % divisor < 0) ? quotient - 1 : quotient;
+}
+
+
+TelemetryQuery::TelemetryQuery(const TelemetryStore *store) : store(store), cache(TELEMETRY_QUERY_CACHE){
+}
+
+
+void TelemetryQuery::clear(){
+    cache.clear();
+}
+
+
+QVector<TelemetryPoint> TelemetryQuery::range(int channel, qint64 from, qint64 to, int resolution){
+    QVector<TelemetryPoint> points;
+    if(from > to || resolution <= 0 || channel < 0 || channel >= store->channelCount())
+        return points;
+
+    TelemetryTileKey key;
+    key.channel = channel;
+    key.widthLog2 = 0;
+    qint64 width = (to - from) / resolution;
+    while(key.widthLog2 < 62 && ((qint64) 1 << key.widthLog2) < width){
+        key.widthLog2++;
+    }
+    qint64 bucketWidth = (qint64) 1 << key.widthLog2;
+    qint64 tileSpan = (qint64) TELEMETRY_TILE_BUCKETS << key.widthLog2;
+    qint64 lastTime = store->lastTime(channel);
+
+    for(key.tile = floorDivide(from, tileSpan); key.tile <= floorDivide(to, tileSpan); key.tile++){
+        /*Tiles reaching past the newest sample may still grow*/
+        Tile *tile = cache.object(key);
+        if(tile && tile->lastTime != lastTime && (key.tile + 1) * tileSpan > tile->lastTime)
+            tile = 0;
+        if(!tile){
+            tile = computeTile(key);
+            cache.insert(key, tile, tile->points.size() + 1);      /*at most 257, far below the cache size*/
+        }
+        /*Aggregated points are stamped with the start of their bucket, single samples with their own time*/
+        foreach(const TelemetryPoint &point, tile->points){
+            qint64 last = point.count == 1 ? point.time : point.time + bucketWidth - 1;
+            if(last >= from && point.time <= to)
+                points.append(point);
+        }
+    }
+    return points;
+}
+
+
+/*Buckets covering a whole block of the store merge its summary, all others add single samples*/
+struct TileVisitor{
+    qint64 start;
+    int widthLog2;
+    TelemetryChunkSummary *buckets;
+    qint64 *firstTimes;
+
+    void add(int bucket, qint64 time, const TelemetryChunkSummary &summary) const{
+        if(!summary.count)
+            return;
+        TelemetryChunkSummary &target = buckets[bucket];
+        if(!target.count)
+            firstTimes[bucket] = time;
+        target.min = qMin(target.min, summary.min);
+        target.max = qMax(target.max, summary.max);
+        target.sum += summary.sum;
+        target.count += summary.count;
+    }
+
+    void operator()(const TelemetrySlice &slice) const{
+        int i = 0;
+        while(i < slice.count){
+            int row = slice.firstRow + i;
+            int bucket = (int)((slice.times[i] - start) >> widthLog2);
+            if(row % TELEMETRY_SUMMARY_SAMPLES == 0 && i + TELEMETRY_SUMMARY_SAMPLES <= slice.count
+                    && (int)((slice.times[i + TELEMETRY_SUMMARY_SAMPLES - 1] - start) >> widthLog2) == bucket){
+                add(bucket, slice.times[i], slice.blocks[row / TELEMETRY_SUMMARY_SAMPLES]);
+                i += TELEMETRY_SUMMARY_SAMPLES;
+                continue;
+            }
+            float value = slice.values[i];
+            if(value == value){
+                TelemetryChunkSummary single = {value, value, value, 1};
+                add(bucket, slice.times[i], single);
+            }
+            i++;
+        }
+    }
+};
+
+TelemetryQuery::Tile *TelemetryQuery::computeTile(const TelemetryTileKey &key) const{
+    qint64 start = key.tile * ((qint64) TELEMETRY_TILE_BUCKETS << key.widthLog2);
+    qint64 end = start + ((qint64) TELEMETRY_TILE_BUCKETS << key.widthLog2) - 1;
+    TelemetryChunkSummary buckets[TELEMETRY_TILE_BUCKETS];
+    qint64 firstTimes[TELEMETRY_TILE_BUCKETS];
+    for(int b = 0; b < TELEMETRY_TILE_BUCKETS; b++){
+        buckets[b].min = FLT_MAX;
+        buckets[b].max = -FLT_MAX;
+        buckets[b].sum = 0;
+        buckets[b].count = 0;
+    }
+    TileVisitor visitor = {start, key.widthLog2, buckets, firstTimes};
+    store->scan(key.channel, start, end, visitor);
+
+    Tile *tile = new Tile;
+    tile->lastTime = store->lastTime(key.channel);
+    for(int b = 0; b < TELEMETRY_TILE_BUCKETS; b++){
+        if(!buckets[b].count)
+            continue;
+        TelemetryPoint point;
+        point.time = buckets[b].count == 1 ? firstTimes[b] : start + ((qint64) b << key.widthLog2);
+        point.min = buckets[b].min;
+        point.max = buckets[b].max;
+        point.mean = buckets[b].sum / buckets[b].count;
+        point.count = buckets[b].count;
+        tile->points.append(point);
+    }
+    return tile;
+}
@@ -0,0 +1,61 @@
+#ifndef TELEMETRYQUERY_H
+#define TELEMETRYQUERY_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <QCache>
+#include <QHash>
+
+#include "telemetrystore.h"
+
+#define TELEMETRY_TILE_BUCKETS 256          /*buckets computed and cached together*/
+#define TELEMETRY_QUERY_CACHE 2000000       /*points kept in the cache*/
+
+/*One bucket of a query. Buckets of a single sample are the raw sample at its own time.*/
+struct TelemetryPoint{
+    qint64 time;                /*ns, sample time or bucket start*/
+    float min;
+    float max;
+    float mean;
+    int count;
+};
+
+struct TelemetryTileKey{
+    int channel;
+    int widthLog2;              /*bucket width 2^widthLog2 ns*/
+    qint64 tile;                /*tile start / (TELEMETRY_TILE_BUCKETS bucket widths)*/
+    bool operator==(const TelemetryTileKey &other) const{
+        return channel == other.channel && widthLog2 == other.widthLog2 && tile == other.tile;
+    }
+};
+
+inline uint qHash(const TelemetryTileKey &key, uint seed = 0){
+    return qHash(key.tile, seed) ^ (uint)(key.channel * 64 + key.widthLog2);
+}
+
+/*Range queries on the TelemetryStore at screen resolution.
+ * Bucket widths are powers of two and buckets are grouped into tiles on a fixed grid,
+ * so scrolling and zooming mostly hit cached tiles. Buckets that cover whole 64 sample
+ * blocks take the block summaries, only the edges read single values.*/
+class TelemetryQuery
+{
+public:
+    explicit TelemetryQuery(const TelemetryStore *store);
+
+    /*Non-empty buckets overlapping [from, to], between resolution / 2 and resolution buckets.
+     * Buckets are whole, the first and last may reach past the range.*/
+    QVector<TelemetryPoint> range(int channel, qint64 from, qint64 to, int resolution);
+    void clear();
+
+private:
+    struct Tile{
+        QVector<TelemetryPoint> points;
+        qint64 lastTime;        /*newest sample in the store when computed*/
+    };
+    const TelemetryStore *store;
+    QCache<TelemetryTileKey, Tile> cache;
+
+    Tile *computeTile(const TelemetryTileKey &key) const;
+};
+
+#endif // TELEMETRYQUERY_H
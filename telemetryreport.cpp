@@ -0,0 +1,164 @@
+#include "telemetryreport.h"
+#include "clocksync.h"
+
+#include <QApplication>
+#include <QPdfWriter>
+#include <QFileInfo>
+#include <QDir>
+#include <QThread>
+#include <QtConcurrent>
+
+/*Queries one page with a cache of its own, the store is only read*/
+struct ReportPageQuery{
+    typedef ReportPage result_type;
+    const TelemetryStore *store;
+    const int (*channels)[PLOT_MAX_GRAPHS];
+    int resolution;
+
+    ReportPage operator()(const QPair<qint64, qint64> &range) const{
+        ReportPage page;
+        page.from = range.first;
+        page.to = range.second;
+        TelemetryQuery query(store);
+        for(int p = 0; p < StandardPlotCount; p++){
+            for(int g = 0; g < standardPlots[p].graphCount; g++){
+                if(channels[p][g] >= 0)
+                    page.series[p][g] = query.range(channels[p][g], range.first, range.second, resolution);
+            }
+        }
+        return page;
+    }
+};
+
+static bool savePage(const QImage &image, const QString &fileName){
+    return image.save(fileName, "PNG");
+}
+
+
+TelemetryReport::TelemetryReport(const TelemetryStore *store, const TelemetryDictionary *dictionary)
+    : store(store), dictionary(dictionary), sliceLength(REPORT_SLICE_LENGTH), pages(0){
+}
+
+
+void TelemetryReport::setSliceLength(qint64 nanoseconds){
+    sliceLength = qMax((qint64) 1000000000, nanoseconds);
+}
+
+
+int TelemetryReport::pageCount() const{
+    return pages;
+}
+
+
+bool TelemetryReport::render(const QString &fileName, qint64 from, qint64 to, QString *error){
+    pages = 0;
+    bool pdf = fileName.endsWith(".pdf", Qt::CaseInsensitive);
+
+    int channels[StandardPlotCount][PLOT_MAX_GRAPHS];
+    for(int p = 0; p < StandardPlotCount; p++){
+        for(int g = 0; g < PLOT_MAX_GRAPHS; g++){
+            channels[p][g] = g < standardPlots[p].graphCount ? dictionary->channelId(standardPlots[p].channels[g]) : -1;
+        }
+    }
+
+    QVector<QPair<qint64, qint64> > slices;
+    for(qint64 start = from; start < to; start += sliceLength){
+        slices.append(qMakePair(start, qMin(start + sliceLength, to)));
+    }
+    if(slices.isEmpty()){
+        *error = "Empty time range";
+        return false;
+    }
+
+    /*The plots are set up once and refilled for every page*/
+    QCustomPlot *plots[StandardPlotCount];
+    for(int p = 0; p < StandardPlotCount; p++){
+        plots[p] = new QCustomPlot;
+        setupStandardPlot(plots[p], standardPlots[p], QApplication::font());
+        plots[p]->xAxis->setAutoTickStep(true);
+    }
+
+    QPdfWriter *writer = 0;
+    QCPPainter painter;
+    int pageWidth = REPORT_PAGE_WIDTH;
+    int plotHeight = REPORT_PLOT_HEIGHT;
+    if(pdf){
+        writer = new QPdfWriter(fileName);
+        writer->setPageSize(QPageSize(QPageSize::A4));
+        writer->setPageMargins(QMarginsF(0, 0, 0, 0));
+        writer->setResolution(REPORT_PDF_RESOLUTION);
+        writer->setTitle(QFileInfo(fileName).completeBaseName());
+        pageWidth = writer->width();
+        plotHeight = writer->height() / StandardPlotCount;
+        if(!painter.begin(writer)){
+            *error = QString("\"%1\" could not be written").arg(fileName);
+            delete writer;
+            qDeleteAll(plots, plots + StandardPlotCount);
+            return false;
+        }
+    }
+
+    /*Pages are queried ahead on the thread pool while earlier ones are drawn*/
+    ReportPageQuery pageQuery = {store, channels, pageWidth};
+    QFuture<ReportPage> prepared = QtConcurrent::mapped(slices, pageQuery);
+    QList<QFuture<bool> > saved;
+    QFileInfo info(fileName);
+    for(int i = 0; i < slices.size(); i++){
+        ReportPage page = prepared.resultAt(i);
+        for(int p = 0; p < StandardPlotCount; p++){
+            for(int g = 0; g < standardPlots[p].graphCount; g++){
+                QCPGraph *graph = plots[p]->graph(g);
+                graph->clearData();
+                foreach(const TelemetryPoint &point, page.series[p][g]){
+                    double key = groundSeconds(point.time);
+                    if(point.count == 1){
+                        graph->addData(key, point.mean * standardPlots[p].scale);
+                    }else{
+                        graph->addData(key, point.min * standardPlots[p].scale);
+                        graph->addData(key, point.max * standardPlots[p].scale);
+                    }
+                }
+                graph->rescaleValueAxis(g > 0);
+            }
+            plots[p]->xAxis->setRange(groundSeconds(page.from), groundSeconds(page.to));
+        }
+
+        if(pdf){
+            if(i > 0)
+                writer->newPage();
+            for(int p = 0; p < StandardPlotCount; p++){
+                painter.save();
+                painter.translate(0, p * plotHeight);
+                plots[p]->toPainter(&painter, pageWidth, plotHeight);
+                painter.restore();
+            }
+        }else{
+            QImage image(pageWidth, plotHeight * StandardPlotCount, QImage::Format_RGB32);
+            QCPPainter imagePainter(&image);
+            for(int p = 0; p < StandardPlotCount; p++){
+                imagePainter.save();
+                imagePainter.translate(0, p * plotHeight);
+                plots[p]->toPainter(&imagePainter, pageWidth, plotHeight);
+                imagePainter.restore();
+            }
+            imagePainter.end();
+            QString pageName = QDir(info.path()).filePath(QString("%1-%2.%3").arg(info.completeBaseName())
+                                                          .arg(i + 1, 3, 10, QChar('0')).arg(info.suffix().isEmpty() ? "png" : info.suffix()));
+            saved.append(QtConcurrent::run(savePage, image, pageName));
+        }
+        pages++;
+    }
+
+    bool ok = true;
+    if(pdf){
+        ok = painter.end();
+        delete writer;
+    }
+    foreach(QFuture<bool> page, saved){
+        ok = page.result() && ok;
+    }
+    qDeleteAll(plots, plots + StandardPlotCount);
+    if(!ok)
+        *error = QString("\"%1\" could not be written").arg(fileName);
+    return ok;
+}
@@ -0,0 +1,42 @@
+#ifndef TELEMETRYREPORT_H
+#define TELEMETRYREPORT_H
+
+#include <QString>
+#include <QVector>
+
+#include "telemetryquery.h"
+#include "plotstyle.h"
+
+#define REPORT_SLICE_LENGTH 60000000000LL   /*ns of telemetry per page*/
+#define REPORT_PAGE_WIDTH 1600              /*px of a PNG page*/
+#define REPORT_PLOT_HEIGHT 450              /*px of one plot on a PNG page*/
+#define REPORT_PDF_RESOLUTION 100           /*dpi of the PDF pages*/
+
+/*Downsampled series of every graph of every standard plot for one page*/
+struct ReportPage{
+    qint64 from;
+    qint64 to;
+    QVector<TelemetryPoint> series[StandardPlotCount][PLOT_MAX_GRAPHS];
+};
+
+/*Renders a recorded session into pages of the standard plots, one time slice per page.
+ * Pages are queried on the thread pool and PNG pages are also encoded there,
+ * the plots themselves are widgets and are drawn on the main thread.*/
+class TelemetryReport
+{
+public:
+    TelemetryReport(const TelemetryStore *store, const TelemetryDictionary *dictionary);
+    void setSliceLength(qint64 nanoseconds);
+
+    /*fileName ending in .pdf gives one document, anything else numbered PNG files*/
+    bool render(const QString &fileName, qint64 from, qint64 to, QString *error);
+    int pageCount() const;
+
+private:
+    const TelemetryStore *store;
+    const TelemetryDictionary *dictionary;
+    qint64 sliceLength;
+    int pages;
+};
+
+#endif // TELEMETRYREPORT_H
@@ -0,0 +1,23 @@
+#include "telemetryrouter.h"
+
+TelemetryRouter::TelemetryRouter(const TelemetryDictionary *dictionary) : dictionary(dictionary){
+    values.resize(dictionary->channelCount());
+}
+
+
+void TelemetryRouter::addSink(TelemetrySink *sink){
+    sinks.append(sink);
+}
+
+
+void TelemetryRouter::handle(const PayloadSatellite &payload){
+    if(values.size() != dictionary->channelCount())
+        values.resize(dictionary->channelCount());
+    if(!dictionary->decode(payload, values.data()))
+        return;
+    const TelemetryTopic *topic = dictionary->topic(payload.topic);
+    const float *topicValues = values.constData() + topic->firstOp;
+    foreach(TelemetrySink *sink, sinks){
+        sink->writeSample(*topic, payload.sampleTime, topicValues);
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef TELEMETRYROUTER_H
+#define TELEMETRYROUTER_H
+
+#include <QVector>
+#include <QList>
+
+#include "topicdispatcher.h"
+#include "telemetrydictionary.h"
+
+/*Receiver of decoded samples. values holds the topic's channels in dictionary order,
+ * channel id of values[i] is topic.firstOp + i.*/
+class TelemetrySink
+{
+public:
+    virtual ~TelemetrySink(){}
+    virtual void writeSample(const TelemetryTopic &topic, qint64 time, const float *values) = 0;
+};
+
+/*Generic handler for every dictionary topic: runs the decoder program and hands
+ * the values to plots, recorders and other sinks*/
+class TelemetryRouter : public PayloadHandler
+{
+public:
+    explicit TelemetryRouter(const TelemetryDictionary *dictionary);
+    void addSink(TelemetrySink *sink);
+    void handle(const PayloadSatellite &payload) Q_DECL_OVERRIDE;
+
+private:
+    const TelemetryDictionary *dictionary;
+    QVector<float> values;
+    QList<TelemetrySink*> sinks;
+};
+
+#endif // TELEMETRYROUTER_H
@@ -0,0 +1,257 @@
+#include "telemetrystore.h"
+
+#include <float.h>
+#include <algorithm>
+
+TelemetryChunkPool::TelemetryChunkPool(int blockSize) : blockSize(blockSize){
+}
+
+TelemetryChunkPool::~TelemetryChunkPool(){
+    foreach(char *slab, slabs){
+        delete[] slab;
+    }
+}
+
+
+void *TelemetryChunkPool::allocate(){
+    if(freeBlocks.isEmpty()){
+        char *slab = new char[(size_t) blockSize * TELEMETRY_POOL_SLAB];
+        slabs.append(slab);
+        for(int i = TELEMETRY_POOL_SLAB - 1; i >= 0; i--){
+            freeBlocks.append(slab + (size_t) i * blockSize);
+        }
+    }
+    void *block = freeBlocks.last();
+    freeBlocks.removeLast();
+    return block;
+}
+
+
+void TelemetryChunkPool::release(void *block){
+    freeBlocks.append(block);
+}
+
+
+qint64 TelemetryChunkPool::reservedBytes() const{
+    return (qint64) slabs.size() * blockSize * TELEMETRY_POOL_SLAB;
+}
+
+
+TelemetryStore::TelemetryStore(const TelemetryDictionary *dictionary) :
+    dictionary(dictionary), timePool(TELEMETRY_CHUNK_SAMPLES * sizeof(qint64)), valuePool(TELEMETRY_CHUNK_SAMPLES * sizeof(float)),
+    retention(TELEMETRY_RETENTION), outOfOrder(0)
+{
+    channelTopics.fill(0, dictionary->channelCount());
+    for(int i = 0; i < dictionary->topicCount(); i++){
+        const TelemetryTopic &topic = dictionary->topicAt(i);
+        TopicColumns columns;
+        columns.firstChannel = topic.firstOp;
+        columns.channelCount = topic.opCount;
+        columns.rows = 0;
+        topics.append(columns);
+        for(int c = 0; c < topic.opCount; c++){
+            channelTopics[topic.firstOp + c] = i;
+        }
+    }
+}
+
+TelemetryStore::~TelemetryStore(){
+    clear();
+}
+
+
+void TelemetryStore::setRetention(qint64 nanoseconds){
+    retention = nanoseconds;
+}
+
+
+void TelemetryStore::clear(){
+    for(int i = 0; i < topics.size(); i++){
+        TopicColumns &columns = topics[i];
+        for(int c = 0; c < columns.chunks.size(); c++){
+            releaseChunk(columns.chunks[c], columns.channelCount);
+        }
+        columns.chunks.clear();
+        columns.rows = 0;
+    }
+}
+
+
+static const TelemetryChunkSummary emptySummary = {FLT_MAX, -FLT_MAX, 0, 0};
+
+static inline void addToSummary(TelemetryChunkSummary &summary, float value){
+    summary.min = qMin(summary.min, value);
+    summary.max = qMax(summary.max, value);
+    summary.sum += value;
+    summary.count++;
+}
+
+
+TelemetryStore::Chunk TelemetryStore::allocateChunk(int channelCount){
+    const int blocksPerChunk = TELEMETRY_CHUNK_SAMPLES / TELEMETRY_SUMMARY_SAMPLES;
+    Chunk chunk;
+    chunk.times = (qint64*) timePool.allocate();
+    chunk.values = new float*[qMax(channelCount, 1)];
+    chunk.summaries = new TelemetryChunkSummary[qMax(channelCount, 1)];
+    chunk.blocks = new TelemetryChunkSummary[qMax(channelCount, 1) * blocksPerChunk];
+    for(int i = 0; i < channelCount; i++){
+        chunk.values[i] = (float*) valuePool.allocate();
+        chunk.summaries[i] = emptySummary;
+    }
+    for(int i = 0; i < channelCount * blocksPerChunk; i++){
+        chunk.blocks[i] = emptySummary;
+    }
+    chunk.count = 0;
+    return chunk;
+}
+
+
+void TelemetryStore::releaseChunk(Chunk &chunk, int channelCount){
+    timePool.release(chunk.times);
+    for(int i = 0; i < channelCount; i++){
+        valuePool.release(chunk.values[i]);
+    }
+    delete[] chunk.values;
+    delete[] chunk.summaries;
+    delete[] chunk.blocks;
+}
+
+
+/*Only whole chunks are released, so a column keeps up to one chunk more than the retention*/
+void TelemetryStore::releaseBefore(TopicColumns &columns, qint64 time){
+    int released = 0;
+    while(released < columns.chunks.size() - 1){
+        Chunk &chunk = columns.chunks[released];
+        if(chunk.times[chunk.count - 1] >= time)
+            break;
+        columns.rows -= chunk.count;
+        releaseChunk(chunk, columns.channelCount);
+        released++;
+    }
+    columns.chunks.remove(0, released);
+}
+
+
+/*Columns are kept sorted by time for binary searches, the jitter buffer orders the
+ * topics that need it. Samples older than the last stored one are dropped.*/
+void TelemetryStore::writeSample(const TelemetryTopic &topic, qint64 time, const float *values){
+    int index = channelTopics.value(topic.firstOp, -1);
+    if(index < 0 || topic.opCount == 0)
+        return;
+    TopicColumns &columns = topics[index];
+    if(!columns.chunks.isEmpty()){
+        const Chunk &last = columns.chunks.last();
+        if(time < last.times[last.count - 1]){
+            outOfOrder++;
+            return;
+        }
+    }
+    if(columns.chunks.isEmpty() || columns.chunks.last().count == TELEMETRY_CHUNK_SAMPLES){
+        columns.chunks.append(allocateChunk(columns.channelCount));
+        if(retention > 0)
+            releaseBefore(columns, time - retention);
+    }
+
+    Chunk &chunk = columns.chunks.last();
+    int row = chunk.count;
+    int block = row / TELEMETRY_SUMMARY_SAMPLES;
+    chunk.times[row] = time;
+    for(int i = 0; i < columns.channelCount; i++){
+        float value = values[i];
+        chunk.values[i][row] = value;
+        if(value != value)      /*NaN marks a missing value, it is left out of the summaries*/
+            continue;
+        addToSummary(chunk.summaries[i], value);
+        addToSummary(chunk.blocks[i * (TELEMETRY_CHUNK_SAMPLES / TELEMETRY_SUMMARY_SAMPLES) + block], value);
+    }
+    chunk.count++;
+    columns.rows++;
+}
+
+
+int TelemetryStore::channelCount() const{
+    return channelTopics.size();
+}
+
+qint64 TelemetryStore::sampleCount(int channel) const{
+    if(channel < 0 || channel >= channelTopics.size())
+        return 0;
+    return topics.at(channelTopics.at(channel)).rows;
+}
+
+qint64 TelemetryStore::firstTime(int channel) const{
+    if(sampleCount(channel) == 0)
+        return 0;
+    return topics.at(channelTopics.at(channel)).chunks.first().times[0];
+}
+
+qint64 TelemetryStore::lastTime(int channel) const{
+    if(sampleCount(channel) == 0)
+        return 0;
+    const Chunk &last = topics.at(channelTopics.at(channel)).chunks.last();
+    return last.times[last.count - 1];
+}
+
+qint64 TelemetryStore::reservedBytes() const{
+    return timePool.reservedBytes() + valuePool.reservedBytes();
+}
+
+quint64 TelemetryStore::outOfOrderDrops() const{
+    return outOfOrder;
+}
+
+
+/*Index of the first sample >= time*/
+int TelemetryStore::lowerBound(const Chunk &chunk, qint64 time){
+    return std::lower_bound(chunk.times, chunk.times + chunk.count, time) - chunk.times;
+}
+
+/*Index behind the last sample <= time*/
+int TelemetryStore::upperBound(const Chunk &chunk, qint64 time){
+    return std::upper_bound(chunk.times, chunk.times + chunk.count, time) - chunk.times;
+}
+
+/*Last chunk starting at or before time, binary search over the chunk list*/
+int TelemetryStore::firstChunk(const TopicColumns &columns, qint64 time){
+    int low = 0;
+    int high = columns.chunks.size() - 1;
+    while(low < high){
+        int middle = (low + high + 1) / 2;
+        if(columns.chunks.at(middle).times[0] <= time)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+
+/*Accumulates the summary of a range, whole chunks are not read*/
+struct SummaryVisitor{
+    TelemetryChunkSummary *result;
+    void operator()(const TelemetrySlice &slice) const{
+        if(slice.summary){
+            result->min = qMin(result->min, slice.summary->min);
+            result->max = qMax(result->max, slice.summary->max);
+            result->sum += slice.summary->sum;
+            result->count += slice.summary->count;
+            return;
+        }
+        for(int i = 0; i < slice.count; i++){
+            float value = slice.values[i];
+            if(value != value)
+                continue;
+            result->min = qMin(result->min, value);
+            result->max = qMax(result->max, value);
+            result->sum += value;
+            result->count++;
+        }
+    }
+};
+
+TelemetryChunkSummary TelemetryStore::summarize(int channel, qint64 from, qint64 to) const{
+    TelemetryChunkSummary result = emptySummary;
+    SummaryVisitor visitor = {&result};
+    scan(channel, from, to, visitor);
+    return result;
+}
@@ -0,0 +1,138 @@
+#ifndef TELEMETRYSTORE_H
+#define TELEMETRYSTORE_H
+
+#include <QtGlobal>
+#include <QVector>
+
+#include "telemetryrouter.h"
+
+#define TELEMETRY_CHUNK_SAMPLES 1024        /*samples per chunk, 4 kB per float column*/
+#define TELEMETRY_SUMMARY_SAMPLES 64        /*samples per block summary, 16 per chunk*/
+#define TELEMETRY_POOL_SLAB 64              /*chunks allocated at once*/
+#define TELEMETRY_RETENTION 86400000000000LL   /*ns, chunks older than a day are released*/
+
+/*Fixed size blocks from slabs, released blocks are reused before a new slab is allocated*/
+class TelemetryChunkPool
+{
+public:
+    explicit TelemetryChunkPool(int blockSize);
+    ~TelemetryChunkPool();
+    void *allocate();
+    void release(void *block);
+    qint64 reservedBytes() const;
+
+private:
+    int blockSize;
+    QVector<char*> slabs;
+    QVector<void*> freeBlocks;
+
+    Q_DISABLE_COPY(TelemetryChunkPool)
+};
+
+/*Summary of the samples of one chunk, kept up to date while the chunk fills. NaN values are not counted.*/
+struct TelemetryChunkSummary{
+    float min;
+    float max;
+    double sum;
+    int count;
+};
+
+/*Samples of one chunk, pointers into the store. Valid until the next write or release.*/
+struct TelemetrySlice{
+    const qint64 *times;                    /*ns, ground clock*/
+    const float *values;
+    int count;
+    const TelemetryChunkSummary *summary;   /*of the whole chunk, only if the slice covers it*/
+    int firstRow;                           /*row of times[0] in the chunk*/
+    const TelemetryChunkSummary *blocks;    /*summaries of the chunk's rows [n*64, n*64+64), by n*/
+};
+
+/*Columnar in-memory history of all decoded channels.
+ * Every topic has one timestamp column, every channel of it a float column with the same
+ * row layout. Columns are append only lists of fixed size chunks, the oldest chunks are
+ * released after TELEMETRY_RETENTION. Written and read on the GUI thread.*/
+class TelemetryStore : public TelemetrySink
+{
+public:
+    explicit TelemetryStore(const TelemetryDictionary *dictionary);
+    ~TelemetryStore();
+
+    void writeSample(const TelemetryTopic &topic, qint64 time, const float *values) Q_DECL_OVERRIDE;
+    void setRetention(qint64 nanoseconds);
+    void clear();
+
+    int channelCount() const;
+    qint64 sampleCount(int channel) const;
+    qint64 firstTime(int channel) const;    /*0 if empty*/
+    qint64 lastTime(int channel) const;
+    qint64 reservedBytes() const;
+    quint64 outOfOrderDrops() const;
+
+    /*Calls visit(const TelemetrySlice &) for the samples in [from, to], oldest first.
+     * Whole chunks come with their summary, the visitor may use it instead of the values.*/
+    template<class Visitor>
+    void scan(int channel, qint64 from, qint64 to, Visitor visit) const;
+
+    /*min/max/sum of [from, to], reading values only of the partially covered chunks*/
+    TelemetryChunkSummary summarize(int channel, qint64 from, qint64 to) const;
+
+private:
+    struct Chunk{
+        qint64 *times;                      /*shared by all channels of the topic*/
+        float **values;                     /*one column per channel*/
+        TelemetryChunkSummary *summaries;
+        TelemetryChunkSummary *blocks;      /*TELEMETRY_CHUNK_SAMPLES / TELEMETRY_SUMMARY_SAMPLES per channel*/
+        int count;
+    };
+    struct TopicColumns{
+        int firstChannel;
+        int channelCount;
+        QVector<Chunk> chunks;
+        qint64 rows;
+    };
+
+    const TelemetryDictionary *dictionary;
+    TelemetryChunkPool timePool;
+    TelemetryChunkPool valuePool;
+    QVector<TopicColumns> topics;
+    QVector<int> channelTopics;             /*channel id to index into topics*/
+    qint64 retention;
+    quint64 outOfOrder;
+
+    Chunk allocateChunk(int channelCount);
+    void releaseChunk(Chunk &chunk, int channelCount);
+    void releaseBefore(TopicColumns &columns, qint64 time);
+    static int lowerBound(const Chunk &chunk, qint64 time);
+    static int upperBound(const Chunk &chunk, qint64 time);
+    static int firstChunk(const TopicColumns &columns, qint64 time);
+
+    Q_DISABLE_COPY(TelemetryStore)
+};
+
+
+template<class Visitor>
+void TelemetryStore::scan(int channel, qint64 from, qint64 to, Visitor visit) const{
+    if(channel < 0 || channel >= channelTopics.size() || from > to)
+        return;
+    const TopicColumns &columns = topics.at(channelTopics.at(channel));
+    int column = channel - columns.firstChannel;
+    for(int c = firstChunk(columns, from); c < columns.chunks.size(); c++){
+        const Chunk &chunk = columns.chunks.at(c);
+        if(chunk.times[0] > to)
+            break;
+        int begin = lowerBound(chunk, from);
+        int end = upperBound(chunk, to);
+        if(begin >= end)
+            continue;
+        TelemetrySlice slice;
+        slice.times = chunk.times + begin;
+        slice.values = chunk.values[column] + begin;
+        slice.count = end - begin;
+        slice.summary = (begin == 0 && end == chunk.count) ? &chunk.summaries[column] : 0;
+        slice.firstRow = begin;
+        slice.blocks = chunk.blocks + column * (TELEMETRY_CHUNK_SAMPLES / TELEMETRY_SUMMARY_SAMPLES);
+        visit(slice);
+    }
+}
+
+#endif // TELEMETRYSTORE_H
@@ -0,0 +1,28 @@
+#include "topicdispatcher.h"
+
+TopicDispatcher::TopicDispatcher(){
+}
+
+TopicDispatcher::~TopicDispatcher(){
+    qDeleteAll(ownedHandlers);
+}
+
+
+void TopicDispatcher::registerHandler(quint32 topic, PayloadHandler *handler){
+    quint32 index = topic - TOPIC_TABLE_BASE;
+    if(index >= TOPIC_TABLE_SIZE)
+        return;
+    handlers[index].append(handler);
+}
+
+
+bool TopicDispatcher::dispatch(const PayloadSatellite &payload) const{
+    quint32 index = payload.topic - TOPIC_TABLE_BASE;
+    if(index >= TOPIC_TABLE_SIZE || handlers[index].isEmpty())
+        return false;
+    const QVector<PayloadHandler*> &chain = handlers[index];
+    for(int i = 0; i < chain.size(); i++){
+        chain.at(i)->handle(payload);
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef TOPICDISPATCHER_H
+#define TOPICDISPATCHER_H
+
+#include <QVector>
+
+#include "payload.h"
+
+/*Receiver of one topic's payloads. The payload is only valid during the call.*/
+class PayloadHandler
+{
+public:
+    virtual ~PayloadHandler(){}
+    virtual void handle(const PayloadSatellite &payload) = 0;
+};
+
+/*Calls a member function of any object as handler*/
+template<class T>
+class MemberPayloadHandler : public PayloadHandler
+{
+public:
+    typedef void (T::*Method)(const PayloadSatellite &payload);
+    MemberPayloadHandler(T *object, Method method) : object(object), method(method){}
+    void handle(const PayloadSatellite &payload) Q_DECL_OVERRIDE{
+        (object->*method)(payload);
+    }
+
+private:
+    T *object;
+    Method method;
+};
+
+/*Maps topic ids to their handler chains through a flat table, registered once at startup.
+ * Dispatching costs one index computation, handlers are called in registration order.*/
+class TopicDispatcher
+{
+public:
+    TopicDispatcher();
+    ~TopicDispatcher();
+
+    void registerHandler(quint32 topic, PayloadHandler *handler);     /*may serve several topics, stays owned by the caller*/
+    template<class T>
+    void registerHandler(quint32 topic, T *object, typename MemberPayloadHandler<T>::Method method){
+        PayloadHandler *handler = new MemberPayloadHandler<T>(object, method);
+        ownedHandlers.append(handler);
+        registerHandler(topic, handler);
+    }
+
+    bool dispatch(const PayloadSatellite &payload) const;   /*false if nobody handles the topic*/
+
+private:
+    QVector<PayloadHandler*> handlers[TOPIC_TABLE_SIZE];
+    QVector<PayloadHandler*> ownedHandlers;
+
+    Q_DISABLE_COPY(TopicDispatcher)
+};
+
+#endif // TOPICDISPATCHER_H